@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Time a kernel.
+ *
+ * @param fn Kernel to run.
+ * @param iterations Number of calls that are timed together.
+ *
+ * @return Average wall time of one call in seconds.
+ */
+template<typename F>
+double benchTime(F&& fn, unsigned int iterations)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < iterations; i++)
+    {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(end - start).count() / iterations;
+}
+
+/**
+ * @brief Make the compiler assume the value is read, so the computation producing it is not optimized away.
+ */
+template<typename T>
+inline void benchDoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    const volatile char* sink = reinterpret_cast<const volatile char*>(&value);
+    (void) *sink;
+#endif
+}
+
+/**
+ * @brief Make the compiler assume all memory is read and written, so stores before it are not dropped or reordered.
+ */
+inline void benchClobberMemory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+/* how benchRun measures a kernel */
+struct BenchOptions
+{
+    /* the kernel runs this long untimed first, for caches, branch predictors and clock boost */
+    double warmup = 0.05;
+
+    /* number of timed batches */
+    unsigned int repetitions = 15;
+
+    /* every batch repeats the kernel until it runs at least this long, so the clock resolution doesn't matter */
+    double batchTime = 0.01;
+};
+
+/* wall time of one kernel call in seconds, summarized over the batches */
+struct BenchStats
+{
+    double min = 0.0;
+    double median = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double max = 0.0;
+
+    unsigned int repetitions = 0;
+    unsigned long long iterations = 0;
+};
+
+/**
+ * @brief Time a kernel with warmup and repetitions. The kernel should pass its results to benchDoNotOptimize.
+ *
+ * @param fn Kernel to run.
+ * @param options Warmup, repetitions and batch length.
+ *
+ * @return Statistics of the time per call over the batches.
+ */
+template<typename F>
+BenchStats benchRun(F&& fn, const BenchOptions& options = {})
+{
+    using Clock = std::chrono::steady_clock;
+    auto seconds = [](Clock::duration d) { return std::chrono::duration<double>(d).count(); };
+
+    /* the warmup also estimates the calls per batch */
+    unsigned long long calls = 0;
+    auto start = Clock::now();
+    do
+    {
+        fn();
+        calls++;
+    }
+    while(seconds(Clock::now() - start) < options.warmup);
+    double perCall = seconds(Clock::now() - start) / calls;
+    unsigned long long iterations = std::max(1ull, (unsigned long long) std::ceil(options.batchTime / perCall));
+
+    std::vector<double> times;
+    for(unsigned int r = 0; r < options.repetitions; r++)
+    {
+        auto batchStart = Clock::now();
+        for(unsigned long long i = 0; i < iterations; i++)
+        {
+            fn();
+        }
+        times.push_back(seconds(Clock::now() - batchStart) / iterations);
+    }
+
+    BenchStats stats;
+    stats.repetitions = options.repetitions;
+    stats.iterations = iterations;
+    if(times.empty())
+    {
+        return stats;
+    }
+
+    std::sort(times.begin(), times.end());
+    stats.min = times.front();
+    stats.max = times.back();
+    stats.median = times.size() % 2 ? times[times.size() / 2] : 0.5 * (times[times.size() / 2 - 1] + times[times.size() / 2]);
+    for(double t : times)
+    {
+        stats.mean += t / times.size();
+    }
+    for(double t : times)
+    {
+        stats.stddev += (t - stats.mean) * (t - stats.mean) / times.size();
+    }
+    stats.stddev = std::sqrt(stats.stddev);
+    return stats;
+}
+
+/**
+ * @brief Print the column header for benchReport.
+ */
+inline void benchReportHeader()
+{
+    printf("%-32s %12s %12s %10s %12s %12s %14s\n", "kernel", "median", "mean", "stddev", "min", "max", "reps x iters");
+}
+
+/**
+ * @brief Print one row of statistics, times in the most readable unit.
+ */
+inline void benchReport(const char* name, const BenchStats& stats)
+{
+    auto format = [](double t)
+    {
+        char buffer[32];
+        if(t < 1e-6)      snprintf(buffer, sizeof(buffer), "%.2f ns", t * 1e9);
+        else if(t < 1e-3) snprintf(buffer, sizeof(buffer), "%.2f us", t * 1e6);
+        else if(t < 1.0)  snprintf(buffer, sizeof(buffer), "%.2f ms", t * 1e3);
+        else              snprintf(buffer, sizeof(buffer), "%.2f s", t);
+        return std::string(buffer);
+    };
+
+    double relative = stats.mean > 0.0 ? 100.0 * stats.stddev / stats.mean : 0.0;
+    printf("%-32s %12s %12s %9.1f%% %12s %12s %6u x %-6llu\n", name, format(stats.median).c_str(), format(stats.mean).c_str(),
+           relative, format(stats.min).c_str(), format(stats.max).c_str(), stats.repetitions, stats.iterations);
+}
+
+/**
+ * @brief Thread counts for a scaling benchmark: powers of two up to the maximum, and the maximum itself.
+ *
+ * @param maxThreads Largest count, 0 uses the hardware concurrency.
+ */
+inline std::vector<unsigned int> benchThreadCounts(unsigned int maxThreads)
+{
+    if(maxThreads == 0)
+    {
+        maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<unsigned int> counts;
+    for(unsigned int threads = 1; threads < maxThreads; threads *= 2)
+    {
+        counts.push_back(threads);
+    }
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+/* number of failed benchCheck calls, project_bench exits with a failure if it isn't zero */
+inline unsigned int gBenchFailures = 0;
+
+/**
+ * @brief Correctness check of a benchmark, a failed check is printed and fails the run.
+ *
+ * @param ok Result of the check.
+ * @param what Description of what was checked.
+ */
+inline void benchCheck(bool ok, const std::string& what)
+{
+    if(!ok)
+    {
+        fprintf(stderr, "CHECK FAILED: %s\n", what.c_str());
+        gBenchFailures++;
+    }
+}
+
+/* benchmark entry points, one per bench_*.cpp */
+void benchBoatWorld(const std::vector<std::string>& args);
+void benchConstexprMath(const std::vector<std::string>& args);
+void benchFrustumCull(const std::vector<std::string>& args);
+void benchHotPaths(const std::vector<std::string>& args);
+void benchJobSystem(const std::vector<std::string>& args);
+void benchMathSimd(const std::vector<std::string>& args);
+void benchMeshArena(const std::vector<std::string>& args);
+void benchMeshOptimize(const std::vector<std::string>& args);
+void benchMeshSimplify(const std::vector<std::string>& args);
+void benchQuaternion(const std::vector<std::string>& args);
+void benchSpatialHash(const std::vector<std::string>& args);
+void benchTransform(const std::vector<std::string>& args);
+void benchVertexPack(const std::vector<std::string>& args);
+void benchVideoWriter(const std::vector<std::string>& args);
+void benchWaterGrid(const std::vector<std::string>& args);
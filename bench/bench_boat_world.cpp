@@ -0,0 +1,39 @@
+#include "bench.h"
+
+#include "boat_world.h"
+
+/* args: [steps [max threads]], the thread count 0 uses the hardware concurrency */
+void benchBoatWorld(const std::vector<std::string>& args)
+{
+    unsigned int steps = args.empty() ? 100 : std::stoi(args[0]);
+    unsigned int maxThreads = args.size() >= 2 ? std::stoi(args[1]) : 0;
+
+    printf("%10s %8s %12s %12s %10s %10s\n", "boats", "threads", "ms/step", "ns/boat", "speedup", "stolen");
+
+    for(size_t count : {1000, 10000, 100000})
+    {
+        double single = 0.0;
+        for(unsigned int threads : benchThreadCounts(maxThreads))
+        {
+            JobSystem jobs;
+            jobSystemCreate(jobs, threads);
+            BoatWorld world = boatWorldCreate(count, 10.0f * std::sqrt((float) count));
+            WaterSim water;
+
+            double t = benchTime([&]
+            {
+                water.accumTime += 1.0f / 120.0f;
+                boatWorldUpdate(world, water, 1.0f / 120.0f, &jobs);
+            }, steps);
+            JobStats stats = jobSystemStats(jobs);
+            jobSystemDelete(jobs);
+
+            if(threads == 1)
+            {
+                single = t;
+            }
+
+            printf("%10zu %8u %12.3f %12.2f %9.2fx %10llu\n", count, threads, t * 1e3, t * 1e9 / count, single / t, stats.stolen);
+        }
+    }
+}
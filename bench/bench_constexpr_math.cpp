@@ -0,0 +1,119 @@
+#include "bench.h"
+
+#include "math/matrix4d.h"
+#include "mygl/geometry.h"
+
+#include <random>
+
+namespace
+{
+
+/* compile-time checks, a failure here breaks the build instead of showing up at runtime */
+constexpr Matrix4D sBoatOffset = Matrix4D::translation({0.0f, -0.2f, 0.0f}) * Matrix4D::scale(0.5f, 0.5f, 0.5f);
+
+static_assert(sBoatOffset(0, 0) == 0.5f && sBoatOffset(1, 3) == -0.2f && sBoatOffset(3, 3) == 1.0f);
+static_assert(inverse(Matrix4D::translation({1.0f, 2.0f, 3.0f}))(2, 3) == -3.0f);
+static_assert((Matrix4D::identity() * Vector4D(1.0f, 2.0f, 3.0f, 1.0f)).z == 3.0f);
+static_assert(cross(Vector3D(1.0f, 0.0f, 0.0f), Vector3D(0.0f, 1.0f, 0.0f)).z == 1.0f);
+static_assert(cube::indices.size() == 36 && quad::vertices[2].uv.x == 1.0f);
+
+/* the factories as they were before they moved into the header: out-of-line calls the optimizer cannot see through */
+namespace outOfLine
+{
+
+[[gnu::noinline]] Matrix4D translation(const Vector3D& v)
+{
+    return Matrix4D::translation(v);
+}
+
+[[gnu::noinline]] Matrix4D scale(float sx, float sy, float sz)
+{
+    return Matrix4D::scale(sx, sy, sz);
+}
+
+[[gnu::noinline]] Vector4D vector(float x, float y, float z, float w)
+{
+    return Vector4D(x, y, z, w);
+}
+
+}
+
+/* tells the compiler the output was read, so repeated timing runs are not collapsed into one */
+inline void clobber(const void* p)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(p) : "memory");
+#else
+    (void) p;
+#endif
+}
+
+}
+
+void benchConstexprMath(const std::vector<std::string>& args)
+{
+    size_t count = args.empty() ? 10000 : std::stoul(args[0]);
+    const unsigned int iterations = 200;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+
+    std::vector<Matrix4D> world(count);
+    std::vector<Matrix4D> model(count);
+    std::vector<Vector4D> point(count);
+    for(size_t i = 0; i < count; i++)
+    {
+        world[i] = Matrix4D::translation({dist(rng), dist(rng), dist(rng)});
+    }
+
+    /* per instance model matrix: world transform composed with a constant offset, like the boat part offsets */
+    double folded = benchTime([&]
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            model[i] = world[i] * sBoatOffset;
+        }
+        clobber(model.data());
+    }, iterations);
+
+    double runtime = benchTime([&]
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            model[i] = world[i] * (outOfLine::translation({0.0f, -0.2f, 0.0f}) * outOfLine::scale(0.5f, 0.5f, 0.5f));
+        }
+        clobber(model.data());
+    }, iterations);
+
+    /* transform a constant local point (e.g. a light or hull sample) by every model matrix */
+    double pointFolded = benchTime([&]
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            point[i] = model[i] * Vector4D(0.0f, 1.8f, 0.0f, 1.0f);
+        }
+        clobber(point.data());
+    }, iterations);
+
+    double pointRuntime = benchTime([&]
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            point[i] = model[i] * outOfLine::vector(0.0f, 1.8f, 0.0f, 1.0f);
+        }
+        clobber(point.data());
+    }, iterations);
+
+    printf("%zu instances\n", count);
+    printf("%-34s %12s %12s %10s\n", "kernel", "ns (inline)", "ns (call)", "speedup");
+    printf("%-34s %12.2f %12.2f %9.2fx\n", "world * translation * scale", 1e9 * folded / count, 1e9 * runtime / count, runtime / folded);
+    printf("%-34s %12.2f %12.2f %9.2fx\n", "model * Vector4D", 1e9 * pointFolded / count, 1e9 * pointRuntime / count, pointRuntime / pointFolded);
+
+    /* keep the results alive */
+    float sum = 0.0f;
+    for(size_t i = 0; i < count; i++)
+    {
+        sum += model[i](0, 3) + point[i].y;
+    }
+    printf("checksum %f\n", sum);
+}
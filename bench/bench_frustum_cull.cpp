@@ -0,0 +1,138 @@
+#include "bench.h"
+
+#include "boat_world.h"
+#include "mygl/camera.h"
+
+#include <algorithm>
+
+namespace
+{
+
+/* tells the compiler the output was read, so repeated timing runs are not collapsed into one */
+inline void clobber(const void* p)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(p) : "memory");
+#else
+    (void) p;
+#endif
+}
+
+/* one plane at a time, like a straightforward per object loop would do it */
+[[gnu::noinline]] size_t cullSpheresScalar(const Frustum& frustum, const Vector4D* spheres, size_t count, uint32_t* visible)
+{
+    size_t n = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+        bool inside = true;
+        for(int p = 0; p < 6 && inside; p++)
+        {
+            inside = dot(Vector3D(frustum.planes[p]), Vector3D(spheres[i])) + frustum.planes[p].w >= -spheres[i].w;
+        }
+        if(inside)
+        {
+            visible[n++] = (uint32_t) i;
+        }
+    }
+    return n;
+}
+
+[[gnu::noinline]] size_t cullBoxesScalar(const Frustum& frustum, const Bounds* bounds, size_t count, uint32_t* visible)
+{
+    size_t n = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+        if(frustumContains(frustum, bounds[i]))
+        {
+            visible[n++] = (uint32_t) i;
+        }
+    }
+    return n;
+}
+
+}
+
+/* args: [parts per boat] */
+void benchFrustumCull(const std::vector<std::string>& args)
+{
+    size_t partsPerBoat = args.empty() ? 8 : std::stoul(args[0]);
+    const unsigned int iterations = 50;
+
+    /* synthetic boat: parts stacked along the hull, the sphere encloses all of them */
+    std::vector<Bounds> parts(partsPerBoat);
+    std::vector<Vector3D> corners;
+    for(size_t p = 0; p < partsPerBoat; p++)
+    {
+        parts[p].center = Vector3D(0.0f, 0.5f + 0.2f * p, -2.0f + 4.0f * p / std::max<size_t>(partsPerBoat - 1, 1));
+        parts[p].extent = Vector3D(0.8f, 0.4f, 0.6f);
+        corners.push_back(parts[p].center - parts[p].extent);
+        corners.push_back(parts[p].center + parts[p].extent);
+    }
+    Bounds boat = boundsCreate(corners.data(), corners.size());
+
+    printf("%zu parts per boat\n", partsPerBoat);
+    printf("%8s %14s %10s %10s %9s %10s %10s %9s %10s\n", "boats", "drawn/culled", "sphere ns", "simd ns", "speedup", "box ns", "simd ns", "speedup", "frame ms");
+
+    for(size_t count : {1000, 10000, 100000})
+    {
+        /* fleet in the usual disc, camera behind one boat at the edge looking over the fleet */
+        float radius = 4.0f * std::sqrt((float) count) + 20.0f;
+        BoatWorld world = boatWorldCreate(count, radius);
+        WaterSim water;
+        boatWorldUpdate(world, water, 1.0f / 120.0f, nullptr);
+
+        Camera camera = cameraCreate(1280, 720, to_radians(45.0), 0.01, 500.0, {0.0f, 10.0f, -radius - 10.0f}, {0.0f, 0.0f, 0.0f});
+        Frustum frustum = cameraFrustum(camera);
+
+        std::vector<Vector4D> spheres(count);
+        std::vector<Bounds> boxes(count);
+        for(size_t i = 0; i < count; i++)
+        {
+            const Matrix4D& M = world.transformation[i];
+            spheres[i] = Vector4D(Vector3D(M * Vector4D(boat.center, 1.0f)), boat.radius);
+            boxes[i] = boundsTransform(boat, M);
+        }
+        std::vector<uint32_t> visible(count * partsPerBoat);
+
+        size_t drawn = 0;
+        double sphereScalar = benchTime([&] { drawn = cullSpheresScalar(frustum, spheres.data(), count, visible.data()); clobber(visible.data()); }, iterations);
+        double sphereSimd = benchTime([&] { drawn = frustumCullSpheres(frustum, spheres.data(), count, visible.data()); clobber(visible.data()); }, iterations);
+        double boxScalar = benchTime([&] { cullBoxesScalar(frustum, boxes.data(), count, visible.data()); clobber(visible.data()); }, iterations);
+        double boxSimd = benchTime([&] { frustumCullBoxes(frustum, boxes.data(), count, visible.data()); clobber(visible.data()); }, iterations);
+
+        /* frame culling as in sceneCull: spheres per boat, then the world space part boxes of the visible boats */
+        std::vector<uint32_t> visibleBoats(count);
+        std::vector<Bounds> partBoxes;
+        size_t partsDrawn = 0;
+        double frame = benchTime([&]
+        {
+            size_t boats = frustumCullSpheres(frustum, spheres.data(), count, visibleBoats.data());
+            partBoxes.clear();
+            for(size_t i = 0; i < boats; i++)
+            {
+                for(const auto& part : parts)
+                {
+                    partBoxes.push_back(boundsTransform(part, world.transformation[visibleBoats[i]]));
+                }
+            }
+            partsDrawn = frustumCullBoxes(frustum, partBoxes.data(), partBoxes.size(), visible.data());
+            clobber(visible.data());
+        }, iterations);
+
+        /* the SIMD paths have to keep exactly the objects the scalar tests keep */
+        std::vector<uint32_t> reference(count);
+        size_t mismatches = 0;
+        size_t n = cullSpheresScalar(frustum, spheres.data(), count, reference.data());
+        mismatches += n != frustumCullSpheres(frustum, spheres.data(), count, visible.data()) || !std::equal(reference.begin(), reference.begin() + n, visible.begin());
+        n = cullBoxesScalar(frustum, boxes.data(), count, reference.data());
+        mismatches += n != frustumCullBoxes(frustum, boxes.data(), count, visible.data()) || !std::equal(reference.begin(), reference.begin() + n, visible.begin());
+
+        char counts[32];
+        snprintf(counts, sizeof(counts), "%zu/%zu", drawn, count - drawn);
+        printf("%8zu %14s %10.2f %10.2f %8.2fx %10.2f %10.2f %8.2fx %10.3f\n", count, counts,
+               1e9 * sphereScalar / count, 1e9 * sphereSimd / count, sphereScalar / sphereSimd,
+               1e9 * boxScalar / count, 1e9 * boxSimd / count, boxScalar / boxSimd, 1e3 * frame);
+        printf("%8s %14s parts drawn %zu of %zu, %s\n", "", "", partsDrawn, count * partsPerBoat,
+               mismatches ? "SIMD MISMATCH" : "SIMD matches scalar");
+    }
+}
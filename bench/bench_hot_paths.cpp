@@ -0,0 +1,103 @@
+#include "bench.h"
+
+#include "boat.h"
+#include "mygl/model_geometry.h"
+#include "water.h"
+
+#include <filesystem>
+#include <random>
+
+namespace
+{
+
+/* rotations and translations like model matrices, so the inverses are well conditioned */
+std::vector<Matrix4D> randomTransforms(size_t count)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f), offset(-50.0f, 50.0f);
+
+    std::vector<Matrix4D> transforms;
+    for(size_t i = 0; i < count; i++)
+    {
+        Quaternion q = Quaternion::rotation(angle(rng), normalize(Vector3D(offset(rng), offset(rng), offset(rng))));
+        transforms.push_back(toMatrix4D(q, Vector3D(offset(rng), offset(rng), offset(rng))));
+    }
+    return transforms;
+}
+
+}
+
+/* args: [OBJ file for the loader kernels, default assets/boat/boat.obj relative to the working directory] */
+void benchHotPaths(const std::vector<std::string>& args)
+{
+    std::string objPath = args.empty() ? "assets/boat/boat.obj" : args[0];
+
+    /* the kernels cycle through 256 inputs, so no call gets a constant folded argument */
+    const size_t count = 256;
+    std::vector<Matrix4D> transforms = randomTransforms(count);
+    std::vector<Vector2D> positions;
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+    for(size_t i = 0; i < count; i++)
+    {
+        positions.emplace_back(coordinate(rng), coordinate(rng));
+    }
+
+    WaterSim water;
+    water.accumTime = 12.5f;
+    size_t i = 0;
+
+    benchReportHeader();
+    benchReport("Matrix4D multiply", benchRun([&]
+    {
+        i = (i + 1) % count;
+        benchDoNotOptimize(transforms[i] * transforms[(i + 7) % count]);
+    }));
+    benchReport("Matrix4D inverse", benchRun([&]
+    {
+        i = (i + 1) % count;
+        benchDoNotOptimize(inverse(transforms[i]));
+    }));
+    benchReport("waterHeight", benchRun([&]
+    {
+        i = (i + 1) % count;
+        benchDoNotOptimize(waterHeight(water, positions[i]));
+    }));
+    benchReport("waterBuoyancyRotation", benchRun([&]
+    {
+        i = (i + 1) % count;
+        Vector2D center = positions[i];
+        benchDoNotOptimize(waterBuoyancyRotation(water, center + Vector2D(0.0f, 1.8f), center + Vector2D(-0.8f, -1.9f), center + Vector2D(0.8f, -1.9f)));
+    }));
+
+    /* one simulation step of the player boat with full throttle in a circle */
+    BoatState boat;
+    const bool control[Boat::eControl::CONTROL_COUNT] = {true, false, true, false};
+    benchReport("boatMove", benchRun([&]
+    {
+        boatMove(boat, water, control, 1.0f / 120.0f);
+        benchDoNotOptimize(boat);
+    }));
+
+    if(!std::filesystem::exists(objPath))
+    {
+        printf("%s not found, skipping the loader kernels (pass the OBJ path or run from the build's bin folder)\n", objPath.c_str());
+        return;
+    }
+
+    /* the CPU part of modelLoad without the geometry cache: parse, optimize and simplify */
+    BenchOptions load = {.warmup = 0.0, .repetitions = 5, .batchTime = 0.0};
+    std::string mtllib;
+    benchReport("modelLoad parse", benchRun([&]
+    {
+        benchDoNotOptimize(modelGeometryLoad(objPath, {.optimize = false, .cache = false}, mtllib));
+    }, load));
+    benchReport("modelLoad parse + optimize", benchRun([&]
+    {
+        benchDoNotOptimize(modelGeometryLoad(objPath, {.optimize = true, .lodCount = 1, .cache = false}, mtllib));
+    }, load));
+    benchReport("modelLoad parse + optimize + LODs", benchRun([&]
+    {
+        benchDoNotOptimize(modelGeometryLoad(objPath, {.optimize = true, .lodCount = MODEL_LOD_MAX, .cache = false}, mtllib));
+    }, load));
+}
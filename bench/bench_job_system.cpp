@@ -0,0 +1,144 @@
+#include "bench.h"
+
+#include "job_system.h"
+
+#include <atomic>
+
+namespace
+{
+
+/* dependent chain of float operations, about 2 ns per iteration */
+float workKernel(unsigned int iterations, float x)
+{
+    for(unsigned int i = 0; i < iterations; i++)
+    {
+        x = x * 0.999f + 0.5f / (1.0f + x);
+    }
+    return x;
+}
+
+/* split [begin, end) in halves, submit one and recurse into the other, like a divide and conquer algorithm would */
+void recursiveSplit(JobSystem* jobs, size_t begin, size_t end, unsigned int iterations, std::atomic<float>& sink)
+{
+    if(end - begin == 1)
+    {
+        sink.store(workKernel(iterations, float(begin)), std::memory_order_relaxed);
+        return;
+    }
+
+    size_t middle = begin + (end - begin) / 2;
+    JobHandle left = jobSubmit(jobs, [=, &sink]{ recursiveSplit(jobs, begin, middle, iterations, sink); });
+    recursiveSplit(jobs, middle, end, iterations, sink);
+    jobWait(jobs, left);
+}
+
+}
+
+/* args: [max threads], 0 uses the hardware concurrency */
+void benchJobSystem(const std::vector<std::string>& args)
+{
+    unsigned int maxThreads = args.empty() ? 0 : std::stoi(args[0]);
+    BenchOptions options = {.warmup = 0.02, .repetitions = 7, .batchTime = 0.02};
+
+    /* every scenario runs the same work on each thread count, speedup is relative to one thread */
+    struct Scenario
+    {
+        const char* name;
+        size_t items;
+        std::function<void(JobSystem*)> run;
+    };
+
+    const size_t emptyJobs = 4096;
+    const size_t forCount = 1 << 16;
+    const size_t graphLeaves = 256;
+    const size_t splitLeaves = 1024;
+    std::atomic<float> sink = 0.0f;
+
+    std::vector<Scenario> scenarios =
+    {
+        /* submit and wait overhead: jobs without work, all submitted by the main thread */
+        {"empty jobs", emptyJobs, [&](JobSystem* jobs)
+        {
+            std::vector<JobHandle> handles;
+            handles.reserve(emptyJobs);
+            for(size_t i = 0; i < emptyJobs; i++)
+            {
+                handles.push_back(jobSubmit(jobs, []{}));
+            }
+            jobWait(jobs, handles);
+        }},
+
+        /* uniform elements, 64 iterations each in chunks of 256 */
+        {"parallel-for uniform", forCount, [&](JobSystem* jobs)
+        {
+            jobParallelFor(jobs, forCount, 256, [&](size_t begin, size_t end)
+            {
+                float x = 0.0f;
+                for(size_t i = begin; i < end; i++)
+                {
+                    x += workKernel(64, float(i));
+                }
+                sink.store(x, std::memory_order_relaxed);
+            });
+        }},
+
+        /* element cost grows with the index, static splitting would leave the first threads idle */
+        {"parallel-for skewed", forCount / 16, [&](JobSystem* jobs)
+        {
+            jobParallelFor(jobs, forCount / 16, 16, [&](size_t begin, size_t end)
+            {
+                float x = 0.0f;
+                for(size_t i = begin; i < end; i++)
+                {
+                    x += workKernel(unsigned(i / 8), float(i));
+                }
+                sink.store(x, std::memory_order_relaxed);
+            });
+        }},
+
+        /* reduction tree: leaves of 4096 iterations, every inner node depends on its two children */
+        {"dependency tree", 2 * graphLeaves - 1, [&](JobSystem* jobs)
+        {
+            std::vector<float> value(2 * graphLeaves);
+            std::vector<JobHandle> node(2 * graphLeaves);
+            for(size_t i = graphLeaves; i < 2 * graphLeaves; i++)
+            {
+                node[i] = jobSubmit(jobs, [&, i]{ value[i] = workKernel(4096, float(i)); });
+            }
+            for(size_t i = graphLeaves - 1; i >= 1; i--)
+            {
+                node[i] = jobSubmit(jobs, [&, i]{ value[i] = value[2 * i] + value[2 * i + 1]; }, {node[2 * i], node[2 * i + 1]});
+            }
+            jobWait(jobs, node[1]);
+            sink.store(value[1], std::memory_order_relaxed);
+        }},
+
+        /* nested jobs that wait inside jobs, the idle threads have to steal the submitted halves */
+        {"recursive split", splitLeaves, [&](JobSystem* jobs)
+        {
+            recursiveSplit(jobs, 0, splitLeaves, 1024, sink);
+        }},
+    };
+
+    printf("%-24s %8s %12s %12s %10s %10s\n", "scenario", "threads", "time", "per item", "speedup", "stolen");
+    for(const auto& scenario : scenarios)
+    {
+        double single = 0.0;
+        for(unsigned int threads : benchThreadCounts(maxThreads))
+        {
+            JobSystem jobs;
+            jobSystemCreate(jobs, threads);
+            BenchStats stats = benchRun([&]{ scenario.run(&jobs); }, options);
+            JobStats jobStats = jobSystemStats(jobs);
+            jobSystemDelete(jobs);
+
+            if(threads == 1)
+            {
+                single = stats.median;
+            }
+            printf("%-24s %8u %10.3f ms %9.1f ns %9.2fx %10llu\n", scenario.name, threads, stats.median * 1e3,
+                   stats.median * 1e9 / scenario.items, single / stats.median, jobStats.stolen);
+        }
+    }
+    benchDoNotOptimize(sink.load());
+}
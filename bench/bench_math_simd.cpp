@@ -0,0 +1,180 @@
+#include "bench.h"
+
+#include "math/matrix4d.h"
+#include "math/simd.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace
+{
+
+/* the scalar implementation the SIMD paths replaced, kept as accuracy reference; not inlined, like the library calls */
+namespace reference
+{
+
+[[gnu::noinline]] Matrix4D multiply(const Matrix4D& A, const Matrix4D& B)
+{
+    Matrix4D R;
+    for(int j = 0; j < 4; j++)
+    {
+        for(int i = 0; i < 4; i++)
+        {
+            R.n[j][i] = A.n[0][i] * B.n[j][0] + A.n[1][i] * B.n[j][1] + A.n[2][i] * B.n[j][2] + A.n[3][i] * B.n[j][3];
+        }
+    }
+    return R;
+}
+
+[[gnu::noinline]] Vector4D multiply(const Matrix4D& M, const Vector4D& v)
+{
+    return Vector4D(M.n[0][0] * v.x + M.n[1][0] * v.y + M.n[2][0] * v.z + M.n[3][0] * v.w,
+                    M.n[0][1] * v.x + M.n[1][1] * v.y + M.n[2][1] * v.z + M.n[3][1] * v.w,
+                    M.n[0][2] * v.x + M.n[1][2] * v.y + M.n[2][2] * v.z + M.n[3][2] * v.w,
+                    M.n[0][3] * v.x + M.n[1][3] * v.y + M.n[2][3] * v.z + M.n[3][3] * v.w);
+}
+
+[[gnu::noinline]] Matrix4D inverse(const Matrix4D& M)
+{
+    Vector3D a(M.n[0][0], M.n[0][1], M.n[0][2]);
+    Vector3D b(M.n[1][0], M.n[1][1], M.n[1][2]);
+    Vector3D c(M.n[2][0], M.n[2][1], M.n[2][2]);
+    Vector3D d(M.n[3][0], M.n[3][1], M.n[3][2]);
+
+    float x = M.n[0][3];
+    float y = M.n[1][3];
+    float z = M.n[2][3];
+    float w = M.n[3][3];
+
+    Vector3D s = cross(a, b);
+    Vector3D t = cross(c, d);
+    Vector3D u = a * y - b * x;
+    Vector3D v = c * w - d * z;
+
+    float invDet = 1.0f / (dot(s, v) + dot(t, u));
+    s *= invDet;
+    t *= invDet;
+    u *= invDet;
+    v *= invDet;
+
+    Vector3D r0 = cross(b, v) + t * y;
+    Vector3D r1 = cross(v, a) - t * x;
+    Vector3D r2 = cross(d, u) + s * w;
+    Vector3D r3 = cross(u, c) - s * z;
+
+    return Matrix4D(r0.x, r0.y, r0.z, -dot(b, t),
+                    r1.x, r1.y, r1.z,  dot(a, t),
+                    r2.x, r2.y, r2.z, -dot(d, s),
+                    r3.x, r3.y, r3.z,  dot(c, s));
+}
+
+}
+
+/* distance in units in the last place, both values finite */
+int64_t ulps(float a, float b)
+{
+    int32_t ia, ib;
+    std::memcpy(&ia, &a, sizeof(float));
+    std::memcpy(&ib, &b, sizeof(float));
+    if(ia < 0) ia = INT32_MIN - ia;
+    if(ib < 0) ib = INT32_MIN - ib;
+    return std::llabs((int64_t) ia - (int64_t) ib);
+}
+
+int64_t maxUlps(const float* a, const float* b, int n)
+{
+    int64_t m = 0;
+    for(int i = 0; i < n; i++)
+    {
+        m = std::max(m, ulps(a[i], b[i]));
+    }
+    return m;
+}
+
+/* random rigid-ish transforms with perspective-like rows so the inverse is well conditioned */
+Matrix4D randomMatrix(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> angle(0.0f, 6.28f);
+    std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+    Matrix4D M = Matrix4D::translation({value(rng), value(rng), value(rng)})
+               * Matrix4D::rotation(angle(rng), normalize(Vector3D(value(rng), value(rng), value(rng))))
+               * Matrix4D::scale(scale(rng), scale(rng), scale(rng));
+    M.n[0][3] = 0.01f * value(rng);
+    M.n[1][3] = 0.01f * value(rng);
+    return M;
+}
+
+}
+
+/* args: [iterations] */
+void benchMathSimd(const std::vector<std::string>& args)
+{
+    unsigned int iterations = args.empty() ? 200 : std::stoi(args[0]);
+    const size_t count = 1024;
+
+#if defined(MATH_SIMD_AVX)
+    printf("SIMD path: AVX\n");
+#elif defined(MATH_SIMD_SSE)
+    printf("SIMD path: SSE\n");
+#else
+    printf("SIMD path: scalar fallback\n");
+#endif
+
+    std::mt19937 rng(7);
+    std::vector<Matrix4D> A(count), B(count), R(count);
+    std::vector<Vector4D> v(count), rv(count);
+    for(size_t i = 0; i < count; i++)
+    {
+        A[i] = randomMatrix(rng);
+        B[i] = randomMatrix(rng);
+        v[i] = Vector4D(A[i].n[0][0], B[i].n[1][1], A[i].n[2][2], 1.0f);
+    }
+
+    /* accuracy against the scalar reference */
+    int64_t mulUlps = 0, vecUlps = 0, invUlps = 0;
+    float invAbs = 0.0f;
+    for(size_t i = 0; i < count; i++)
+    {
+        Matrix4D simd = A[i] * B[i];
+        Matrix4D scalar = reference::multiply(A[i], B[i]);
+        mulUlps = std::max(mulUlps, maxUlps(simd.ptr(), scalar.ptr(), 16));
+
+        Vector4D sv = A[i] * v[i];
+        Vector4D rv = reference::multiply(A[i], v[i]);
+        vecUlps = std::max(vecUlps, maxUlps(&sv.x, &rv.x, 4));
+
+        Matrix4D si = inverse(A[i]);
+        Matrix4D ri = reference::inverse(A[i]);
+        invUlps = std::max(invUlps, maxUlps(si.ptr(), ri.ptr(), 16));
+        for(int k = 0; k < 16; k++)
+        {
+            invAbs = std::max(invAbs, std::fabs(si.ptr()[k] - ri.ptr()[k]));
+        }
+    }
+
+    printf("%-22s %12s %12s %10s %12s\n", "kernel", "ns (simd)", "ns (scalar)", "speedup", "max ulp");
+
+    /* the kernels do the same operations in the same order as the scalar code, so they have to match bit for bit */
+    const int64_t ulpTolerance = 0;
+    auto report = [&](const char* name, double simd, double scalar, int64_t maxUlp)
+    {
+        printf("%-22s %12.2f %12.2f %9.2fx %12lld\n", name, simd * 1e9 / count, scalar * 1e9 / count, scalar / simd, (long long) maxUlp);
+        benchCheck(maxUlp <= ulpTolerance, std::string(name) + " is " + std::to_string(maxUlp) + " ulp off the scalar reference, tolerance " + std::to_string(ulpTolerance));
+    };
+
+    double simd = benchTime([&]{ for(size_t i = 0; i < count; i++) R[i] = A[i] * B[i]; }, iterations);
+    double scalar = benchTime([&]{ for(size_t i = 0; i < count; i++) R[i] = reference::multiply(A[i], B[i]); }, iterations);
+    report("Matrix4D * Matrix4D", simd, scalar, mulUlps);
+
+    simd = benchTime([&]{ for(size_t i = 0; i < count; i++) rv[i] = A[i] * v[i]; }, iterations);
+    scalar = benchTime([&]{ for(size_t i = 0; i < count; i++) rv[i] = reference::multiply(A[i], v[i]); }, iterations);
+    report("Matrix4D * Vector4D", simd, scalar, vecUlps);
+
+    simd = benchTime([&]{ for(size_t i = 0; i < count; i++) R[i] = inverse(A[i]); }, iterations);
+    scalar = benchTime([&]{ for(size_t i = 0; i < count; i++) R[i] = reference::inverse(A[i]); }, iterations);
+    report("inverse(Matrix4D)", simd, scalar, invUlps);
+    printf("inverse max abs difference: %g\n", invAbs);
+}
@@ -0,0 +1,67 @@
+#include "bench.h"
+
+#include "mygl/range_allocator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+/* args: [live meshes] */
+void benchMeshArena(const std::vector<std::string>& args)
+{
+    size_t live = args.empty() ? 256 : std::stoul(args[0]);
+    const size_t operations = 100000;
+
+    /* mesh sizes spread over three orders of magnitude, like boat parts next to small props */
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> exponent(2.0f, 5.0f);
+    auto meshSize = [&] { return (unsigned int) std::pow(10.0f, exponent(rng)); };
+
+    /* load `live` meshes, then unload a random one and load a new one `operations` times; the allocator grows like
+     * MeshArena does, to at least twice its capacity */
+    RangeAllocator allocator = rangeAllocatorCreate(1 << 16);
+    std::vector<Range> ranges;
+    unsigned int grows = 0;
+    unsigned long long usedSum = 0, wastedSum = 0, capacitySum = 0;
+
+    auto load = [&]
+    {
+        Range range{0, meshSize()};
+        range.offset = rangeAllocatorAlloc(allocator, range.count);
+        if(range.offset == RangeAllocator::INVALID)
+        {
+            rangeAllocatorGrow(allocator, std::max(2 * allocator.capacity, allocator.capacity + range.count));
+            range.offset = rangeAllocatorAlloc(allocator, range.count);
+            grows++;
+        }
+        ranges.push_back(range);
+    };
+
+    for(size_t i = 0; i < live; i++)
+    {
+        load();
+    }
+
+    double t = benchTime([&]
+    {
+        size_t index = rng() % ranges.size();
+        rangeAllocatorFree(allocator, ranges[index]);
+        ranges[index] = ranges.back();
+        ranges.pop_back();
+        load();
+
+        RangeAllocatorStats stats = rangeAllocatorStats(allocator);
+        usedSum += stats.used;
+        wastedSum += stats.wasted;
+        capacitySum += stats.capacity;
+    }, operations);
+
+    RangeAllocatorStats stats = rangeAllocatorStats(allocator);
+    printf("%zu live meshes, %zu unload/load pairs, 100 to 100k vertices each\n", live, operations);
+    printf("%-28s %10.1f\n", "ns per unload/load + stats", 1e9 * t);
+    printf("%-28s %10u\n", "buffer grows", grows);
+    printf("%-28s %10u\n", "final capacity", stats.capacity);
+    printf("%-28s %10u\n", "final free ranges", stats.freeRanges);
+    printf("%-28s %9.1f%%\n", "mean in use / allocated", 100.0 * usedSum / capacitySum);
+    printf("%-28s %9.1f%%\n", "mean wasted / allocated", 100.0 * wastedSum / capacitySum);
+}
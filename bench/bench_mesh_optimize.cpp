@@ -0,0 +1,101 @@
+#include "bench.h"
+
+#include "mygl/mesh_optimize.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+/* unit sphere of n x n quads split into 4 latitude bands like the materials of a model; the triangles of every band
+ * are in random order and expanded to one vertex per corner like an OBJ */
+void shuffledSphere(unsigned int n, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    std::vector<Vertex> grid;
+    for(unsigned int j = 0; j <= n; j++)
+    {
+        for(unsigned int i = 0; i <= n; i++)
+        {
+            float theta = 3.14159265f * float(j) / n, phi = 2.0f * 3.14159265f * float(i) / n;
+            Vertex& vertex = grid.emplace_back();
+            vertex.pos = Vector3D(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            vertex.normal = vertex.pos;
+            vertex.uv = Vector2D(float(i) / n, float(j) / n);
+        }
+    }
+
+    std::mt19937 rng(1);
+    std::vector<std::array<unsigned int, 3>> triangles;
+    for(unsigned int band = 0; band < 4; band++)
+    {
+        size_t first = triangles.size();
+        for(unsigned int j = band * n / 4; j < (band + 1) * n / 4; j++)
+        {
+            for(unsigned int i = 0; i < n; i++)
+            {
+                unsigned int v00 = j * (n + 1) + i, v10 = v00 + 1, v01 = v00 + n + 1, v11 = v01 + 1;
+                triangles.push_back({v00, v01, v11});
+                triangles.push_back({v00, v11, v10});
+            }
+        }
+        std::shuffle(triangles.begin() + first, triangles.end(), rng);
+    }
+
+    vertices.clear();
+    indices.clear();
+    for(const auto& triangle : triangles)
+    {
+        for(unsigned int v : triangle)
+        {
+            indices.push_back(vertices.size());
+            vertices.push_back(grid[v]);
+        }
+    }
+}
+
+}
+
+/* args: [quads per sphere side, rounded down to a multiple of 4] */
+void benchMeshOptimize(const std::vector<std::string>& args)
+{
+    std::vector<unsigned int> sizes = {16, 64, 256};
+    if(!args.empty())
+    {
+        sizes = {std::max(unsigned(std::stoul(args[0])) & ~3u, 4u)};
+    }
+
+    printf("%-10s %-14s %10s %10s %8s %8s\n", "quads", "pass", "vertices", "ms", "ACMR", "ATVR");
+    for(unsigned int n : sizes)
+    {
+        std::vector<Vertex> input;
+        std::vector<unsigned int> inputIndices;
+        shuffledSphere(n, input, inputIndices);
+
+        std::vector<Vertex> vertices = input;
+        std::vector<unsigned int> indices = inputIndices;
+        auto report = [&](const char* pass, double t)
+        {
+            MeshCacheStats stats = meshCacheStats(indices, vertices.size());
+            printf("%-10u %-14s %10zu %10.3f %8.3f %8.3f\n", n * n, pass, vertices.size(), 1e3 * t, stats.acmr, stats.atvr);
+        };
+
+        report("input", 0.0);
+        report("weld", benchTime([&] { meshWeld(vertices, indices); }, 1));
+        report("vertex cache", benchTime([&] { meshOptimizeVertexCache(indices, vertices.size()); }, 1));
+        report("overdraw", benchTime([&] { meshOptimizeOverdraw(indices, vertices); }, 1));
+        report("vertex fetch", benchTime([&] { meshOptimizeVertexFetch(vertices, indices); }, 1));
+
+        /* the whole pipeline with one range per band */
+        vertices = input;
+        indices = inputIndices;
+        unsigned int band = unsigned(indices.size() / 4);
+        std::vector<Range> ranges = {{0, band}, {band, band}, {2 * band, band}, {3 * band, band}};
+        MeshOptimizeStats stats;
+        double t = benchTime([&] { stats = meshOptimize(vertices, indices, ranges); }, 1);
+        printf("%-10u %-14s %10u %10.3f %8.3f %8.3f  (welded input: ACMR %.3f, ATVR %.3f)\n", n * n, "meshOptimize", stats.outputVertices,
+               1e3 * t, stats.after.acmr, stats.after.atvr, stats.before.acmr, stats.before.atvr);
+    }
+}
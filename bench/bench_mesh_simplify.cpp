@@ -0,0 +1,49 @@
+#include "bench.h"
+
+#include "mygl/mesh_optimize.h"
+#include "mygl/mesh_simplify.h"
+
+#include <cmath>
+
+/* args: [quads per sphere side] */
+void benchMeshSimplify(const std::vector<std::string>& args)
+{
+    unsigned int n = args.empty() ? 256 : std::stoul(args[0]);
+    const unsigned int iterations = 3;
+
+    /* uv sphere with a uv seam along phi = 0 and the upper half in a second range, like two materials */
+    std::vector<Vertex> vertices;
+    for(unsigned int j = 0; j <= n; j++)
+    {
+        for(unsigned int i = 0; i <= n; i++)
+        {
+            float theta = 3.14159265f * float(j) / n, phi = 2.0f * 3.14159265f * float(i) / n;
+            Vertex& vertex = vertices.emplace_back();
+            vertex.pos = Vector3D(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            vertex.normal = vertex.pos;
+            vertex.uv = Vector2D(float(i) / n, float(j) / n);
+        }
+    }
+
+    std::vector<unsigned int> indices;
+    for(unsigned int j = 0; j < n; j++)
+    {
+        for(unsigned int i = 0; i < n; i++)
+        {
+            unsigned int v00 = j * (n + 1) + i, v10 = v00 + 1, v01 = v00 + n + 1, v11 = v01 + 1;
+            indices.insert(indices.end(), {v00, v01, v11, v00, v11, v10});
+        }
+    }
+    unsigned int half = unsigned(indices.size() / 2);
+    std::vector<Range> ranges = {{0, half}, {half, unsigned(indices.size()) - half}};
+    meshOptimize(vertices, indices, ranges);
+
+    printf("%u triangles, sphere radius 1\n", unsigned(indices.size() / 3));
+    printf("%-8s %10s %10s %12s %10s\n", "target", "triangles", "ms", "error", "ranges");
+    for(float ratio : {0.5f, 0.25f, 0.125f, 0.0625f})
+    {
+        MeshSimplifyResult lod;
+        double t = benchTime([&] { lod = meshSimplify(vertices, indices, ranges, unsigned(ratio * indices.size() / 3)); }, iterations);
+        printf("%-8.4f %10zu %10.3f %12.2e %5u/%u\n", ratio, lod.indices.size() / 3, 1e3 * t, lod.error, lod.ranges[0].count / 3, lod.ranges[1].count / 3);
+    }
+}
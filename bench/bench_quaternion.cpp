@@ -0,0 +1,143 @@
+#include "bench.h"
+
+#include "math/quaternion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+/* tells the compiler the output was read, so repeated timing runs are not collapsed into one */
+inline void clobber(const void* p)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(p) : "memory");
+#else
+    (void) p;
+#endif
+}
+
+/* the boat basis is mirrored in x, see boatTransformation */
+constexpr Matrix3D sMirror = Matrix3D::scale(-1.0f, 1.0f, 1.0f);
+
+/* the matrix based boat interpolation the quaternion path replaced */
+[[gnu::noinline]] Matrix4D matrixInterpolate(const Matrix4D& a, const Matrix4D& b, float alpha)
+{
+    Vector3D position = Vector3D(a[3] + alpha * (b[3] - a[3]));
+    Vector3D right = normalize(Vector3D(a[0] + alpha * (b[0] - a[0])));
+    Vector3D up = Vector3D(a[1] + alpha * (b[1] - a[1]));
+    up = normalize(up - dot(up, right) * right);
+    Vector3D back = cross(up, right);
+
+    return Matrix4D(Vector4D(right, 0.0f), Vector4D(up, 0.0f), Vector4D(back, 0.0f), Vector4D(position, 1.0f));
+}
+
+}
+
+void benchQuaternion(const std::vector<std::string>& args)
+{
+    size_t count = args.empty() ? 10000 : std::stoul(args[0]);
+    const unsigned int iterations = 100;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    /* pairs of random rotations one small step apart, like two consecutive simulation states */
+    std::vector<Quaternion> qa(count), qb(count), qr(count);
+    std::vector<Matrix4D> ma(count), mb(count), mr(count);
+    std::vector<Vector3D> position(count);
+    for(size_t i = 0; i < count; i++)
+    {
+        Vector3D axis = normalize(Vector3D(dist(rng), dist(rng), dist(rng)) + Vector3D(0.0f, 0.0f, 2.0f));
+        Vector3D step = normalize(Vector3D(dist(rng), dist(rng), dist(rng)) + Vector3D(0.0f, 2.0f, 0.0f));
+        qa[i] = Quaternion::rotation(3.0f * dist(rng), axis);
+        qb[i] = Quaternion::rotation(0.05f * dist(rng), step) * qa[i];
+        position[i] = Vector3D(dist(rng), dist(rng), dist(rng)) * 100.0f;
+        ma[i] = toMatrix4D(qa[i], position[i]) * Matrix4D(sMirror);
+        mb[i] = toMatrix4D(qb[i], position[i]) * Matrix4D(sMirror);
+    }
+
+    double composeQuat = benchTime([&]
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            qr[i] = qa[i] * qb[i];
+        }
+        clobber(qr.data());
+    }, iterations);
+
+    double composeMatrix = benchTime([&]
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            mr[i] = ma[i] * mb[i];
+        }
+        clobber(mr.data());
+    }, iterations);
+
+    double interpolateSlerp = benchTime([&]
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            qr[i] = slerp(qa[i], qb[i], 0.3f);
+        }
+        clobber(qr.data());
+    }, iterations);
+
+    double interpolateNlerp = benchTime([&]
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            qr[i] = nlerp(qa[i], qb[i], 0.3f);
+        }
+        clobber(qr.data());
+    }, iterations);
+
+    double interpolateMatrix = benchTime([&]
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            mr[i] = matrixInterpolate(ma[i], mb[i], 0.3f);
+        }
+        clobber(mr.data());
+    }, iterations);
+
+    /* the old boat path built translation * orientation with a full matrix multiply */
+    double convertQuat = benchTime([&]
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            mr[i] = toMatrix4D(qa[i], position[i]);
+            mr[i][0] = -mr[i][0];
+        }
+        clobber(mr.data());
+    }, iterations);
+
+    double convertMatrix = benchTime([&]
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            mr[i] = Matrix4D::translation(position[i]) * Matrix4D(Matrix3D(ma[i]));
+        }
+        clobber(mr.data());
+    }, iterations);
+
+    /* angle between the slerp result and the re-orthonormalized matrix blend */
+    float maxAngle = 0.0f;
+    for(size_t i = 0; i < count; i++)
+    {
+        Quaternion q = slerp(qa[i], qb[i], 0.3f);
+        Quaternion m = Quaternion::fromMatrix(Matrix3D(matrixInterpolate(ma[i], mb[i], 0.3f)) * sMirror);
+        maxAngle = std::max(maxAngle, 2.0f * std::asin(std::min(1.0f, length((q * conjugate(m)).vector()))));
+    }
+
+    printf("%zu rotations\n", count);
+    printf("%-30s %12s %12s %10s\n", "kernel", "ns (quat)", "ns (matrix)", "speedup");
+    printf("%-30s %12.2f %12.2f %9.2fx\n", "compose", 1e9 * composeQuat / count, 1e9 * composeMatrix / count, composeMatrix / composeQuat);
+    printf("%-30s %12.2f %12.2f %9.2fx\n", "interpolate (slerp)", 1e9 * interpolateSlerp / count, 1e9 * interpolateMatrix / count, interpolateMatrix / interpolateSlerp);
+    printf("%-30s %12.2f %12.2f %9.2fx\n", "interpolate (nlerp)", 1e9 * interpolateNlerp / count, 1e9 * interpolateMatrix / count, interpolateMatrix / interpolateNlerp);
+    printf("%-30s %12.2f %12.2f %9.2fx\n", "convert to model matrix", 1e9 * convertQuat / count, 1e9 * convertMatrix / count, convertMatrix / convertQuat);
+    printf("max angle slerp vs. matrix blend: %.2e rad\n", maxAngle);
+}
@@ -0,0 +1,98 @@
+#include "bench.h"
+
+#include "spatial_hash.h"
+
+#include <algorithm>
+#include <random>
+
+/* args: [queries] */
+void benchSpatialHash(const std::vector<std::string>& args)
+{
+    size_t queries = args.empty() ? 10000 : std::stoul(args[0]);
+    const float cellSize = 6.0f;
+    const float queryRadius = 6.0f;
+    const size_t k = 8;
+
+    printf("%10s %10s %10s %14s %14s %14s %10s\n", "boats", "build ms", "update ms", "radius ns/q", "knn ns/q", "brute ns/q", "knn errors");
+
+    for(size_t count : {10000, 100000, 1000000})
+    {
+        /* same density as the fleet benchmark: ~30 units² per boat */
+        float radius = 3.0f * std::sqrt((float) count);
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> pos(-radius, radius);
+
+        std::vector<float> x(count), z(count), qx(queries), qz(queries);
+        for(size_t i = 0; i < count; i++)
+        {
+            x[i] = pos(rng);
+            z[i] = pos(rng);
+        }
+        for(size_t i = 0; i < queries; i++)
+        {
+            qx[i] = pos(rng);
+            qz[i] = pos(rng);
+        }
+
+        SpatialHash hash;
+        double build = benchTime([&]{ spatialHashBuild(hash, x.data(), z.data(), count, cellSize); }, 10);
+
+        /* one simulation step worth of movement (2 units/s at 120 Hz) */
+        double update = benchTime([&]
+        {
+            for(size_t i = 0; i < count; i++)
+            {
+                x[i] += 0.016f;
+            }
+            spatialHashUpdate(hash, x.data(), z.data(), count);
+        }, 10);
+
+        std::vector<uint32_t> out;
+        size_t found = 0;
+        double radiusQuery = benchTime([&]
+        {
+            for(size_t q = 0; q < queries; q++)
+            {
+                found += spatialHashQueryRadius(hash, qx[q], qz[q], queryRadius, out);
+            }
+        }, 1) / queries;
+
+        double knnQuery = benchTime([&]
+        {
+            for(size_t q = 0; q < queries; q++)
+            {
+                found += spatialHashQueryNearest(hash, qx[q], qz[q], k, 10.0f * queryRadius, out);
+            }
+        }, 1) / queries;
+
+        /* O(n) reference, only on a few queries since it gets slow quickly */
+        size_t bruteQueries = std::min<size_t>(queries, 100);
+        size_t errors = 0;
+        std::vector<std::pair<float, uint32_t>> all(count);
+        double brute = benchTime([&]
+        {
+            for(size_t q = 0; q < bruteQueries; q++)
+            {
+                for(size_t i = 0; i < count; i++)
+                {
+                    float dx = x[i] - qx[q];
+                    float dz = z[i] - qz[q];
+                    all[i] = {dx * dx + dz * dz, (uint32_t) i};
+                }
+                std::partial_sort(all.begin(), all.begin() + k, all.end());
+
+                spatialHashQueryNearest(hash, qx[q], qz[q], k, 10.0f * queryRadius, out);
+                for(size_t j = 0; j < k; j++)
+                {
+                    errors += j >= out.size() || out[j] != all[j].second;
+                }
+            }
+        }, 1) / bruteQueries;
+
+        printf("%10zu %10.3f %10.3f %14.1f %14.1f %14.1f %10zu\n", count, build * 1e3, update * 1e3, radiusQuery * 1e9, knnQuery * 1e9, brute * 1e9, errors);
+        if(found == 0)
+        {
+            printf("no neighbours found\n");
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#include "bench.h"
+
+#include "math/transform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+/* tells the compiler the output was read, so repeated timing runs are not collapsed into one */
+inline void clobber(const void* p)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(p) : "memory");
+#else
+    (void) p;
+#endif
+}
+
+}
+
+void benchTransform(const std::vector<std::string>& args)
+{
+    std::vector<size_t> counts = {1, 16, 1000, 65536, 1000000};
+    if(!args.empty())
+    {
+        counts = {std::stoul(args[0])};
+    }
+
+    Matrix4D M = Matrix4D::translation({1.0f, -2.0f, 3.0f}) * Matrix4D::rotation(0.7f, normalize(Vector3D(1.0f, 2.0f, 0.5f))) * Matrix4D::scale(1.5f, 1.5f, 1.5f);
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+
+    printf("%-10s %-18s %12s %12s %10s %12s\n", "points", "kernel", "ns/pt batch", "ns/pt single", "speedup", "max error");
+    for(size_t count : counts)
+    {
+        std::vector<Vector3D> in(count), out(count), reference(count);
+        std::vector<float> x(count), y(count), z(count), outX(count), outY(count), outZ(count);
+        for(size_t i = 0; i < count; i++)
+        {
+            in[i] = {dist(rng), dist(rng), dist(rng)};
+            x[i] = in[i].x;
+            y[i] = in[i].y;
+            z[i] = in[i].z;
+        }
+
+        /* about 2M points per measurement */
+        unsigned int iterations = (unsigned int) std::max<size_t>(1, 2000000 / count);
+
+        auto maxError = [&](bool soa)
+        {
+            float error = 0.0f;
+            for(size_t i = 0; i < count; i++)
+            {
+                Vector3D r = soa ? Vector3D(outX[i], outY[i], outZ[i]) : out[i];
+                error = std::max({error, std::abs(r.x - reference[i].x), std::abs(r.y - reference[i].y), std::abs(r.z - reference[i].z)});
+            }
+            return error;
+        };
+
+        for(bool point : {true, false})
+        {
+            /* one Matrix4D * Vector4D per point, as the call sites did before */
+            float w = point ? 1.0f : 0.0f;
+            double single = benchTime([&]
+            {
+                for(size_t i = 0; i < count; i++)
+                {
+                    reference[i] = Vector3D(M * Vector4D(in[i], w));
+                }
+                clobber(reference.data());
+            }, iterations);
+
+            double aos = benchTime([&]
+            {
+                if(point)
+                {
+                    transformPoints(M, in.data(), out.data(), count);
+                }
+                else
+                {
+                    transformDirections(M, in.data(), out.data(), count);
+                }
+                clobber(out.data());
+            }, iterations);
+            float aosError = maxError(false);
+
+            double soa = benchTime([&]
+            {
+                if(point)
+                {
+                    transformPoints(M, x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), count);
+                }
+                else
+                {
+                    transformDirections(M, x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), count);
+                }
+                clobber(outX.data());
+            }, iterations);
+            float soaError = maxError(true);
+
+            const char* kind = point ? "points" : "directions";
+            printf("%-10zu %-7s %-10s %12.3f %12.3f %9.2fx %12.2e\n", count, "AoS", kind, 1e9 * aos / count, 1e9 * single / count, single / aos, aosError);
+            printf("%-10zu %-7s %-10s %12.3f %12.3f %9.2fx %12.2e\n", count, "SoA", kind, 1e9 * soa / count, 1e9 * single / count, single / soa, soaError);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#include "bench.h"
+
+#include "mygl/vertex_pack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+/* args: [vertices] */
+void benchVertexPack(const std::vector<std::string>& args)
+{
+    size_t count = args.empty() ? 1000000 : std::stoul(args[0]);
+    const unsigned int iterations = 10;
+
+    /* hull sized mesh: 12 x 4 x 3 units, random unit normals, uvs tiled up to 4 times */
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> tile(0.0f, 4.0f);
+    std::vector<Vertex> vertices(count);
+    std::vector<Vector3D> positions(count);
+    for(size_t i = 0; i < count; i++)
+    {
+        vertices[i].pos = Vector3D(6.0f * dist(rng), 2.0f * dist(rng) + 1.0f, 1.5f * dist(rng));
+        vertices[i].normal = normalize(Vector3D(dist(rng), dist(rng), dist(rng)) + Vector3D(0.0f, 0.0f, 1e-3f));
+        vertices[i].uv = Vector2D(tile(rng), tile(rng));
+        positions[i] = vertices[i].pos;
+    }
+
+    Bounds bounds = boundsCreate(positions.data(), positions.size());
+    VertexQuantization quantization = vertexQuantization(bounds);
+
+    std::vector<PackedVertex> packed;
+    double t = benchTime([&] { packed = vertexPack(vertices, quantization); }, iterations);
+
+    float positionError = 0.0f, normalError = 0.0f, uvError = 0.0f;
+    for(size_t i = 0; i < count; i++)
+    {
+        Vertex v = vertexUnpack(packed[i], quantization);
+        positionError = std::max(positionError, length(v.pos - vertices[i].pos));
+        normalError = std::max(normalError, std::acos(std::min(dot(v.normal, vertices[i].normal), 1.0f)));
+        uvError = std::max(uvError, std::max(std::abs(v.uv.x - vertices[i].uv.x), std::abs(v.uv.y - vertices[i].uv.y)));
+    }
+
+    printf("%zu vertices in a %.1f x %.1f x %.1f box\n", count, 2.0f * bounds.extent.x, 2.0f * bounds.extent.y, 2.0f * bounds.extent.z);
+    printf("%-28s %10zu %10zu\n", "bytes per vertex", sizeof(Vertex), sizeof(PackedVertex));
+    printf("%-28s %10.2f %10.2f\n", "vertex memory MiB", count * sizeof(Vertex) / 1048576.0, count * sizeof(PackedVertex) / 1048576.0);
+    printf("%-28s %10.2f\n", "pack ns per vertex", 1e9 * t / count);
+    printf("max error: position %.2e units, normal %.4f deg, uv %.2e (texels of a 2048 map: %.2f)\n",
+           positionError, normalError * 180.0f / 3.14159265f, uvError, uvError * 2048.0f);
+}
@@ -0,0 +1,76 @@
+#include "bench.h"
+
+#include "video_writer.h"
+
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <thread>
+
+/* args: [width height], default 1920 1080 */
+void benchVideoWriter(const std::vector<std::string>& args)
+{
+    int width = args.size() >= 2 ? std::stoi(args[0]) : 1920;
+    int height = args.size() >= 2 ? std::stoi(args[1]) : 1080;
+
+    /* noise, so nothing is cheaper than for a rendered frame */
+    std::vector<uint8_t> rgba(size_t(width) * height * 4);
+    std::mt19937 rng(1);
+    for(auto& c : rgba)
+    {
+        c = uint8_t(rng());
+    }
+    std::vector<uint8_t> yuv(videoYuv420Size(width, height));
+
+    printf("%dx%d, %.1f MB RGBA -> %.1f MB YUV 4:2:0 per frame\n", width, height, rgba.size() / 1e6, yuv.size() / 1e6);
+    BenchOptions frame = {.warmup = 0.1, .repetitions = 15, .batchTime = 0.05};
+    benchReportHeader();
+    benchReport("videoConvertYuv420", benchRun([&]
+    {
+        videoConvertYuv420(rgba.data(), width, height, yuv.data());
+        benchDoNotOptimize(yuv[0]);
+    }, frame));
+    benchReport("render thread copy", benchRun([&]
+    {
+        std::vector<uint8_t> copy = rgba;
+        benchDoNotOptimize(copy[0]);
+    }, frame));
+
+    /* two seconds of recording at 60 Hz: the producer copies a frame like captureFrame does and never waits */
+    std::string path = (std::filesystem::temp_directory_path() / "project_bench.y4m").string();
+    VideoWriter writer;
+    if(!videoWriterCreate(writer, path, width, height, 60))
+    {
+        printf("couldn't open %s\n", path.c_str());
+        return;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const unsigned int frames = 120;
+    double producerTime = 0.0;
+    auto next = Clock::now();
+    for(unsigned int i = 0; i < frames; i++)
+    {
+        auto start = Clock::now();
+        std::vector<uint8_t> pixels;
+        if(videoWriterAcquire(writer, pixels))
+        {
+            memcpy(pixels.data(), rgba.data(), rgba.size());
+            videoWriterPush(writer, std::move(pixels));
+        }
+        producerTime += std::chrono::duration<double>(Clock::now() - start).count();
+
+        next += std::chrono::microseconds(16667);
+        std::this_thread::sleep_until(next);
+    }
+    videoWriterDelete(writer);
+    VideoWriterStats stats = writer.stats;
+    std::filesystem::remove(path);
+
+    unsigned int written = std::max(1u, stats.frames);
+    printf("\n%u frames at 60 Hz: %u written, %u dropped, queue length mean %.2f max %zu\n", frames, stats.frames, stats.dropped,
+           double(stats.queueDepthSum) / written, stats.queueDepthMax);
+    printf("producer %.3f ms per frame, writer %.3f ms convert + %.3f ms write per frame (%.0f MB/s), budget 16.667 ms\n",
+           1e3 * producerTime / frames, 1e3 * stats.convertTime / written, 1e3 * stats.writeTime / written,
+           stats.bytes / 1e6 / std::max(1e-9, stats.writeTime));
+}
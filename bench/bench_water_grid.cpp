@@ -0,0 +1,57 @@
+#include "bench.h"
+
+#include "mygl/camera.h"
+#include "water_grid.h"
+
+#include <algorithm>
+
+/* args: [camera height] */
+void benchWaterGrid(const std::vector<std::string>& args)
+{
+    float height = args.empty() ? 10.0f : std::stof(args[0]);
+    const unsigned int iterations = 200;
+    const float waveHeight = 1.4f;
+
+    /* the old water.obj: one 40x40 mesh, unindexed, 8192 triangles */
+    printf("reference water.obj: 40 x 40 units, 24576 vertices, 8192 triangles, 1 draw\n");
+    printf("camera height %.1f, far plane 500\n", height);
+    printf("%6s %6s %8s %8s %10s %12s %8s %10s\n", "res", "lod", "chunks", "visible", "vertices", "triangles", "min dx", "select us");
+
+    Camera camera = cameraCreate(1280, 720, to_radians(45.0), 0.01, 500.0, {1000.0f, height, 1000.0f}, {1030.0f, 0.0f, 1040.0f});
+    Frustum frustum = cameraFrustum(camera);
+
+    for(unsigned int resolution : {16, 32, 64})
+    {
+        for(float lod : {1.5f, 2.0f, 3.0f})
+        {
+            WaterGrid grid = waterGridCreate(resolution, 16.0f, 7, lod);
+
+            std::vector<Bounds> bounds;
+            std::vector<uint32_t> visible;
+            size_t visibleCount = 0;
+            double t = benchTime([&]
+            {
+                waterGridSelect(grid, camera.position, waveHeight);
+                bounds.resize(grid.chunks.size());
+                visible.resize(grid.chunks.size());
+                for(size_t i = 0; i < grid.chunks.size(); i++)
+                {
+                    bounds[i] = grid.chunks[i].bounds;
+                }
+                visibleCount = frustumCullBoxes(frustum, bounds.data(), bounds.size(), visible.data());
+            }, iterations);
+
+            size_t triangles = 0;
+            float minSize = grid.chunks.front().size;
+            for(size_t i = 0; i < visibleCount; i++)
+            {
+                const WaterChunk& chunk = grid.chunks[visible[i]];
+                triangles += grid.variantCount[chunk.stitch] / 3;
+                minSize = std::min(minSize, chunk.size);
+            }
+
+            printf("%6u %6.1f %8zu %8zu %10zu %12zu %8.3f %10.2f\n", resolution, lod, grid.chunks.size(), visibleCount,
+                   visibleCount * grid.vertices.size(), triangles, minSize / resolution, t * 1e6);
+        }
+    }
+}
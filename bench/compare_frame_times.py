@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+"""Compare the frame times of `project --headless --json` runs against a baseline.
+
+Every <scenario>.json in the current folder is matched with the same file in the baseline folder. A statistic that
+got slower than the threshold (in percent) and by more than --min-ms is a regression; the exit code is 1 if there is
+any, so the script can gate CI.
+
+    compare_frame_times.py <baseline dir> <current dir> [--threshold 10] [--min-ms 0.05]
+"""
+
+import argparse
+import json
+import pathlib
+import sys
+
+TIMES = ("cpu_ms", "gpu_ms")
+STATS = ("mean", "p50", "p95", "p99")
+
+
+def load(folder):
+    return {path.stem: json.loads(path.read_text()) for path in sorted(pathlib.Path(folder).glob("*.json"))}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0, help="slowdown in percent that counts as a regression")
+    parser.add_argument("--min-ms", type=float, default=0.05, help="ignore differences below this many milliseconds")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    if not current:
+        print(f"no results in {args.current}, run the benchmark target first")
+        return 1
+
+    regressions = 0
+    print(f"{'scenario':<12} {'time':<7} {'stat':<5} {'baseline':>10} {'current':>10} {'change':>8}")
+    for scenario, result in current.items():
+        if scenario not in baseline:
+            print(f"{scenario:<12} no baseline")
+            continue
+
+        base = baseline[scenario]
+        if base.get("resolution") != result.get("resolution") or base.get("frames") != result.get("frames"):
+            print(f"{scenario:<12} baseline has a different resolution or frame count, skipped")
+            continue
+
+        for time in TIMES:
+            for stat in STATS:
+                old, new = base[time][stat], result[time][stat]
+                change = (new - old) / old * 100.0 if old > 0.0 else 0.0
+                regression = change > args.threshold and new - old > args.min_ms
+                regressions += regression
+                print(f"{scenario:<12} {time:<7} {stat:<5} {old:>10.3f} {new:>10.3f} {change:>+7.1f}%"
+                      + ("  REGRESSION" if regression else ""))
+
+    print(f"{regressions} regression(s) beyond {args.threshold:g}%")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
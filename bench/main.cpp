@@ -0,0 +1,65 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+struct Benchmark
+{
+    const char* name;
+    void (*run)(const std::vector<std::string>& args);
+};
+
+static const Benchmark sBenchmarks[] =
+{
+    { "boat_world", benchBoatWorld },
+    { "constexpr_math", benchConstexprMath },
+    { "frustum_cull", benchFrustumCull },
+    { "hot_paths", benchHotPaths },
+    { "job_system", benchJobSystem },
+    { "math_simd", benchMathSimd },
+    { "mesh_arena", benchMeshArena },
+    { "mesh_optimize", benchMeshOptimize },
+    { "mesh_simplify", benchMeshSimplify },
+    { "quaternion", benchQuaternion },
+    { "spatial_hash", benchSpatialHash },
+    { "transform", benchTransform },
+    { "vertex_pack", benchVertexPack },
+    { "video_writer", benchVideoWriter },
+    { "water_grid", benchWaterGrid },
+};
+
+int main(int argc, char** argv)
+{
+    /* usage: project_bench [name [args...]], without a name every benchmark runs with its default arguments */
+    std::vector<std::string> args(argv + std::min(argc, 2), argv + argc);
+
+    bool found = false;
+    for(const auto& benchmark : sBenchmarks)
+    {
+        if(argc < 2 || std::strcmp(argv[1], benchmark.name) == 0)
+        {
+            printf("==== %s ====\n", benchmark.name);
+            benchmark.run(args);
+            found = true;
+        }
+    }
+
+    if(!found)
+    {
+        fprintf(stderr, "unknown benchmark '%s', available:", argv[1]);
+        for(const auto& benchmark : sBenchmarks)
+        {
+            fprintf(stderr, " %s", benchmark.name);
+        }
+        fprintf(stderr, "\n");
+        return EXIT_FAILURE;
+    }
+
+    if(gBenchFailures > 0)
+    {
+        fprintf(stderr, "%u checks failed\n", gBenchFailures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,339 @@
+#include "asset_pack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <tuple>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace detail
+{
+
+const char assetPackMagic[4] = {'A', 'P', 'A', 'K'};
+const uint32_t assetPackVersion = 1;
+const uint64_t assetPackAlignment = 64;
+
+/* little endian like the mesh cache and the input recordings */
+struct AssetPackHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t indexOffset;
+    uint64_t indexSize;
+};
+
+/* index record, followed by pathLength bytes of path */
+struct AssetPackRecord
+{
+    uint8_t type;
+    uint8_t flipped;
+    uint16_t pathLength;
+    uint32_t width;
+    uint32_t height;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+
+const AssetPack* assetMounted = nullptr;
+
+bool assetEntryLess(const AssetEntry& a, const AssetEntry& b)
+{
+    return std::tie(a.path, a.type) < std::tie(b.path, b.type);
+}
+
+void assetPackUnmap(AssetPack& pack)
+{
+#ifdef _WIN32
+    if(pack.data)
+    {
+        UnmapViewOfFile(pack.data);
+    }
+    if(pack.mappingHandle)
+    {
+        CloseHandle(pack.mappingHandle);
+    }
+    if(pack.fileHandle)
+    {
+        CloseHandle(pack.fileHandle);
+    }
+    pack.mappingHandle = nullptr;
+    pack.fileHandle = nullptr;
+#else
+    if(pack.data)
+    {
+        munmap(const_cast<uint8_t*>(pack.data), pack.size);
+    }
+#endif
+    pack.data = nullptr;
+    pack.size = 0;
+}
+
+/* map the whole file read only, false if it can't be opened or is empty */
+bool assetPackMap(AssetPack& pack, const std::string& filepath)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    pack.fileHandle = file;
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        return false;
+    }
+    pack.size = size_t(size.QuadPart);
+
+    pack.mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!pack.mappingHandle)
+    {
+        return false;
+    }
+    pack.data = static_cast<const uint8_t*>(MapViewOfFile(pack.mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    return pack.data != nullptr;
+#else
+    int file = open(filepath.c_str(), O_RDONLY);
+    if(file < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    if(fstat(file, &status) != 0 || status.st_size == 0)
+    {
+        close(file);
+        return false;
+    }
+
+    /* the mapping keeps the file alive, so the descriptor isn't needed anymore */
+    void* data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if(data == MAP_FAILED)
+    {
+        return false;
+    }
+    pack.data = static_cast<const uint8_t*>(data);
+    pack.size = status.st_size;
+    return true;
+#endif
+}
+
+void assetPackWriteAt(AssetPackWriter& writer, uint64_t offset)
+{
+    static const char zeros[assetPackAlignment] = {};
+    fwrite(zeros, 1, offset - writer.offset, writer.file);
+    writer.offset = offset;
+}
+
+uint64_t assetPackAlign(uint64_t offset)
+{
+    return (offset + assetPackAlignment - 1) / assetPackAlignment * assetPackAlignment;
+}
+
+}
+
+AssetPack assetPackOpen(const std::string& filepath)
+{
+    AssetPack pack;
+    pack.path = filepath;
+    if(!detail::assetPackMap(pack, filepath))
+    {
+        detail::assetPackUnmap(pack);
+        throw std::runtime_error("[Assets] Couldn't map asset pack " + filepath);
+    }
+
+    auto invalid = [&](const std::string& reason)
+    {
+        detail::assetPackUnmap(pack);
+        return std::runtime_error("[Assets] " + filepath + " " + reason);
+    };
+
+    detail::AssetPackHeader header;
+    if(pack.size < sizeof(header))
+    {
+        throw invalid("is not an asset pack");
+    }
+    std::memcpy(&header, pack.data, sizeof(header));
+    if(std::memcmp(header.magic, detail::assetPackMagic, sizeof(header.magic)) != 0)
+    {
+        throw invalid("is not an asset pack");
+    }
+    if(header.version != detail::assetPackVersion)
+    {
+        throw invalid("has an unsupported version");
+    }
+    if(header.indexOffset > pack.size || header.indexSize > pack.size - header.indexOffset)
+    {
+        throw invalid("is truncated");
+    }
+
+    /* every record and every entry has to lie inside the file, views are handed out without further checks */
+    uint64_t position = header.indexOffset;
+    uint64_t end = header.indexOffset + header.indexSize;
+    for(uint32_t i = 0; i < header.entryCount; i++)
+    {
+        detail::AssetPackRecord record;
+        if(end - position < sizeof(record))
+        {
+            throw invalid("has a truncated index");
+        }
+        std::memcpy(&record, pack.data + position, sizeof(record));
+        position += sizeof(record);
+
+        if(end - position < record.pathLength || record.type > ASSET_IMAGE ||
+           record.offset > header.indexOffset || record.size > header.indexOffset - record.offset ||
+           (record.type == ASSET_IMAGE && uint64_t(record.width) * record.height * 4 != record.size))
+        {
+            throw invalid("has an invalid entry");
+        }
+
+        AssetEntry& entry = pack.entries.emplace_back();
+        entry.path.assign(reinterpret_cast<const char*>(pack.data + position), record.pathLength);
+        entry.type = AssetType(record.type);
+        entry.flipped = record.flipped != 0;
+        entry.width = record.width;
+        entry.height = record.height;
+        entry.offset = record.offset;
+        entry.size = record.size;
+        position += record.pathLength;
+    }
+
+    std::sort(pack.entries.begin(), pack.entries.end(), detail::assetEntryLess);
+    return pack;
+}
+
+void assetPackClose(AssetPack& pack)
+{
+    detail::assetPackUnmap(pack);
+    pack.entries.clear();
+}
+
+void assetPackMount(const AssetPack* pack)
+{
+    detail::assetMounted = pack;
+}
+
+const AssetEntry* assetFind(const std::string& path, AssetType type)
+{
+    const AssetPack* pack = detail::assetMounted;
+    if(!pack)
+    {
+        return nullptr;
+    }
+
+    AssetEntry key;
+    key.path = path;
+    key.type = type;
+    auto entry = std::lower_bound(pack->entries.begin(), pack->entries.end(), key, detail::assetEntryLess);
+    return entry != pack->entries.end() && entry->path == path && entry->type == type ? &*entry : nullptr;
+}
+
+const uint8_t* assetEntryData(const AssetEntry& entry)
+{
+    return detail::assetMounted->data + entry.offset;
+}
+
+bool assetRead(const std::string& path, AssetData& data)
+{
+    if(const AssetEntry* entry = assetFind(path, ASSET_FILE))
+    {
+        data.buffer.clear();
+        data.data = assetEntryData(*entry);
+        data.size = entry->size;
+        return true;
+    }
+
+    std::error_code error;
+    uintmax_t size = std::filesystem::file_size(path, error);
+    FILE* file = error ? nullptr : fopen(path.c_str(), "rb");
+    if(!file)
+    {
+        return false;
+    }
+
+    /* unbuffered, so the whole file arrives with one read instead of one per stdio buffer */
+    setvbuf(file, nullptr, _IONBF, 0);
+    data.buffer.resize(size);
+    size_t read = fread(data.buffer.data(), 1, size, file);
+    fclose(file);
+
+    data.buffer.resize(read);
+    data.data = data.buffer.data();
+    data.size = read;
+    return read == size;
+}
+
+bool assetPackWriterCreate(AssetPackWriter& writer, const std::string& filepath)
+{
+    writer.file = fopen(filepath.c_str(), "wb");
+    if(!writer.file)
+    {
+        return false;
+    }
+
+    /* the header is written last, once the index position is known */
+    writer.entries.clear();
+    writer.offset = 0;
+    detail::assetPackWriteAt(writer, sizeof(detail::AssetPackHeader));
+    return true;
+}
+
+void assetPackWrite(AssetPackWriter& writer, AssetEntry entry, const void* data, size_t size)
+{
+    detail::assetPackWriteAt(writer, detail::assetPackAlign(writer.offset));
+    fwrite(data, 1, size, writer.file);
+
+    entry.offset = writer.offset;
+    entry.size = size;
+    writer.offset += size;
+    writer.entries.push_back(std::move(entry));
+}
+
+bool assetPackWriterFinish(AssetPackWriter& writer)
+{
+    detail::AssetPackHeader header = {};
+    std::memcpy(header.magic, detail::assetPackMagic, sizeof(header.magic));
+    header.version = detail::assetPackVersion;
+    header.entryCount = writer.entries.size();
+
+    detail::assetPackWriteAt(writer, detail::assetPackAlign(writer.offset));
+    header.indexOffset = writer.offset;
+    for(const auto& entry : writer.entries)
+    {
+        detail::AssetPackRecord record = {};
+        record.type = entry.type;
+        record.flipped = entry.flipped;
+        record.pathLength = entry.path.size();
+        record.width = entry.width;
+        record.height = entry.height;
+        record.offset = entry.offset;
+        record.size = entry.size;
+        fwrite(&record, sizeof(record), 1, writer.file);
+        fwrite(entry.path.data(), 1, entry.path.size(), writer.file);
+        header.indexSize += sizeof(record) + entry.path.size();
+    }
+
+    fseek(writer.file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, writer.file);
+
+    bool success = !ferror(writer.file);
+    success = fclose(writer.file) == 0 && success;
+    writer.file = nullptr;
+    return success;
+}
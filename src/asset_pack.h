@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/* what an entry of an asset pack holds; an entry is found by its path and type */
+enum AssetType : uint8_t
+{
+    /* bytes of the file: shader sources, material libraries, encoded images */
+    ASSET_FILE,
+
+    /* optimized geometry of an OBJ file with its levels of detail, in the mesh cache format of modelGeometryLoad */
+    ASSET_MESH,
+
+    /* decoded RGBA8 pixels, rows bottom up for textures (flipped) or top down for cube map faces */
+    ASSET_IMAGE,
+};
+
+struct AssetEntry
+{
+    std::string path;
+    AssetType type = ASSET_FILE;
+
+    /* images only */
+    bool flipped = false;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    /* position of the bytes in the pack */
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+/**
+ * One file holding the assets of the scene, memory mapped as a whole. A 32 byte header is followed by the data of
+ * every entry, each aligned to 64 bytes, and the index at the end, so a loader gets a pointer into the mapping
+ * instead of opening, reading and decoding a file.
+ */
+struct AssetPack
+{
+    std::string path;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    /* sorted by path and type */
+    std::vector<AssetEntry> entries;
+
+    /* file and mapping handle on Windows, the file is closed right after mapping elsewhere */
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+};
+
+/* the bytes of an asset: a view into the mounted pack, or a copy of a loose file */
+struct AssetData
+{
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    std::vector<uint8_t> buffer;
+};
+
+/* writes a pack; entries are appended in any order, the index is written by assetPackWriterFinish */
+struct AssetPackWriter
+{
+    FILE* file = nullptr;
+    std::vector<AssetEntry> entries;
+    uint64_t offset = 0;
+};
+
+/**
+ * @brief Map a pack and read its index. Throws a runtime_error if the file can't be mapped or isn't an asset pack.
+ *
+ * @param filepath Pack written by an AssetPackWriter.
+ *
+ * @return Mapped pack, has to be closed with assetPackClose.
+ */
+AssetPack assetPackOpen(const std::string& filepath);
+
+/**
+ * @brief Unmap a pack. It must not be mounted anymore, views into it become invalid.
+ */
+void assetPackClose(AssetPack& pack);
+
+/**
+ * @brief Serve the assets of a pack to assetFind and assetRead, nullptr goes back to loose files only. Loaders look
+ * assets up from any thread, so the pack is mounted before loading and not changed while assets load.
+ */
+void assetPackMount(const AssetPack* pack);
+
+/**
+ * @brief Find an entry of the mounted pack.
+ *
+ * @return Entry, nullptr if no pack is mounted or it has no entry of that path and type.
+ */
+const AssetEntry* assetFind(const std::string& path, AssetType type);
+
+/**
+ * @brief Bytes of an entry of the mounted pack, valid while the pack is mapped.
+ */
+const uint8_t* assetEntryData(const AssetEntry& entry);
+
+/**
+ * @brief Get the bytes of a file: a view of its ASSET_FILE entry in the mounted pack, otherwise the loose file read
+ * with a single read.
+ *
+ * @param path Path of the file.
+ * @param data Receives the bytes.
+ *
+ * @return False if the file is neither in the pack nor on disk.
+ */
+bool assetRead(const std::string& path, AssetData& data);
+
+/**
+ * @brief Create a pack file.
+ *
+ * @return False if the file couldn't be created.
+ */
+bool assetPackWriterCreate(AssetPackWriter& writer, const std::string& filepath);
+
+/**
+ * @brief Append an entry.
+ *
+ * @param writer Writer.
+ * @param entry Path, type and image size of the entry, offset and size are set by the writer.
+ * @param data Bytes of the entry.
+ * @param size Number of bytes.
+ */
+void assetPackWrite(AssetPackWriter& writer, AssetEntry entry, const void* data, size_t size);
+
+/**
+ * @brief Write index and header and close the file.
+ *
+ * @return False if any write failed.
+ */
+bool assetPackWriterFinish(AssetPackWriter& writer);
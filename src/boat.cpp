@@ -1,47 +1,54 @@
 #include "boat.h"
+#include "profiler.h"
 
-Boat boatLoad(const std::string& filepath)
+namespace detail
 {
-    Boat boat;
-    boat.partModel = modelLoad(filepath);
-    return boat;
-}
 
-void boatDelete(Boat& boat)
-{
-    for(auto& model : boat.partModel)
-    {
-        modelDelete(model);
-    }
+/* the buoyancy basis maps the model's x axis to the boat's port side, so the boat is drawn mirrored in x. The
+ * quaternion only holds the proper rotation, the mirror is applied again when the model matrix is built. */
+constexpr Matrix3D boatMirror = Matrix3D::scale(-1.0f, 1.0f, 1.0f);
 
-    boat.partModel.clear();
 }
 
-void boatMove(Boat& boat, const WaterSim& waterSim, bool control[], float dt)
+void boatMove(BoatState& boat, const WaterSim& waterSim, const bool control[], float dt)
 {
+    PROFILE_ZONE("boatMove");
+
     /* retrieve input for controls */
     float throttle = + control[Boat::eControl::THROTTLE_UP] - control[Boat::eControl::THROTTLE_DOWN];
     float rudder = + control[Boat::eControl::RUDDER_LEFT] - control[Boat::eControl::RUDDER_RIGHT];
 
     /* rotate due to rudde control */
-    boat.angles.y += throttle * rudder * dt;
-    auto rotation = Matrix4D::rotationY(boat.angles.y);
+    boat.heading += throttle * rudder * dt;
+    auto rotation = Quaternion::rotation(boat.heading, Vector3D(0.0, 1.0, 0.0));
 
     /* move boat along direction vector */
-    boat.position += rotation * (2.0f * dt * throttle * Vector4D(0.0, 0.0, 1.0, 0.0));
+    boat.position += rotate(rotation, Vector3D(0.0, 0.0, 2.0f * dt * throttle));
 
     /* find triangle to compute wave orientation */
     auto center = Vector2D(boat.position.x, boat.position.z);
-    auto r0 = rotation * Vector4D( 0.0, 0.0,  1.8, 0.0);
-    auto r1 = rotation * Vector4D(-0.8, 0.0, -1.9, 0.0);
-    auto r2 = rotation * Vector4D( 0.8, 0.0, -1.9, 0.0);
+    Vector3D hull[3] = {rotate(rotation, {0.0, 0.0, 1.8}), rotate(rotation, {-0.8, 0.0, -1.9}), rotate(rotation, {0.8, 0.0, -1.9})};
 
-    auto v0 = center + Vector2D{r0.x, r0.z};
-    auto v1 = center + Vector2D{r1.x, r1.z};
-    auto v2 = center + Vector2D{r2.x, r2.z};
+    auto v0 = center + Vector2D{hull[0].x, hull[0].z};
+    auto v1 = center + Vector2D{hull[1].x, hull[1].z};
+    auto v2 = center + Vector2D{hull[2].x, hull[2].z};
 
     boat.position.y = waterHeight(waterSim, center);
-    auto water_orientation = waterBuoyancyRotation(waterSim, v0, v1, v2);
+    boat.orientation = Quaternion::fromMatrix(Matrix3D(waterBuoyancyRotation(waterSim, v0, v1, v2)) * detail::boatMirror);
+}
 
-    boat.transformation = Matrix4D::translation(boat.position) * water_orientation;
+BoatState boatInterpolate(const BoatState& a, const BoatState& b, float alpha)
+{
+    BoatState result;
+    result.position = a.position + alpha * (b.position - a.position);
+    result.orientation = slerp(a.orientation, b.orientation, alpha);
+    result.heading = a.heading + alpha * (b.heading - a.heading);
+    return result;
+}
+
+Matrix4D boatTransformation(const BoatState& state)
+{
+    Matrix4D transformation = toMatrix4D(state.orientation, state.position);
+    transformation[0] = -transformation[0];
+    return transformation;
 }
@@ -6,6 +6,16 @@
 
 #include <vector>
 
+/* simulation state of a boat, kept apart from the render data so it can be stepped and interpolated on its own */
+struct BoatState
+{
+    Vector3D position = {0.0, 0.0, 0.0};
+    Quaternion orientation = Quaternion::identity();
+
+    /* steering angle around the world up axis, the orientation additionally follows the waves */
+    float heading = 0.0f;
+};
+
 struct Boat
 {
     enum eControl
@@ -19,11 +29,18 @@ struct Boat
 
     std::vector<Model> partModel;
 
+    BoatState state;
+
+    /* model matrix of the interpolated state, refreshed once per frame */
     Matrix4D transformation = Matrix4D::identity();
-    Vector3D position = {0.0, 0.0, 0.0};
-    Vector3D angles = {0.0, 0.0, 0.0};
 };
 
-Boat boatLoad(const std::string& filepath);
+Boat boatLoad(const std::string& filepath, const ModelLoadOptions& options = {});
 void boatDelete(Boat& boat);
-void boatMove(Boat& boat, const WaterSim& waterSim, bool control[], float dt);
+void boatMove(BoatState& boat, const WaterSim& waterSim, const bool control[], float dt);
+BoatState boatInterpolate(const BoatState& a, const BoatState& b, float alpha);
+
+/**
+ * @brief Model matrix of a boat state.
+ */
+Matrix4D boatTransformation(const BoatState& state);
@@ -0,0 +1,21 @@
+#include "boat.h"
+
+/* loading and deleting the boat's models needs a GL context, so unlike the boat physics in boat.cpp this is not part
+ * of project_core */
+
+Boat boatLoad(const std::string& filepath, const ModelLoadOptions& options)
+{
+    Boat boat;
+    boat.partModel = modelLoad(filepath, options);
+    return boat;
+}
+
+void boatDelete(Boat& boat)
+{
+    for(auto& model : boat.partModel)
+    {
+        modelDelete(model);
+    }
+
+    boat.partModel.clear();
+}
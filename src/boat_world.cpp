@@ -0,0 +1,173 @@
+#include "boat_world.h"
+
+#include <algorithm>
+#include <random>
+
+namespace detail
+{
+
+/* boats per chunk, sized so the sample scratch buffers stay in L1 */
+constexpr size_t boatWorldChunk = 256;
+
+/* hull points used for the buoyancy orientation (same as boatMove) */
+constexpr float hullBow[2] = { 0.0f,  1.8f};
+constexpr float hullPort[2] = {-0.8f, -1.9f};
+constexpr float hullStarboard[2] = { 0.8f, -1.9f};
+
+void boatWorldSteer(BoatWorld& world, float time, size_t begin, size_t end)
+{
+    for(size_t i = begin; i < end; i++)
+    {
+        float x = world.positionX[i];
+        float z = world.positionZ[i];
+
+        /* wander, but turn back towards the center once outside of the fleet radius */
+        float rudder = std::sin(world.aiPhase[i] + 0.3f * time);
+        if(x * x + z * z > world.radius * world.radius)
+        {
+            float toCenter = std::atan2(-x, -z) - world.heading[i];
+            rudder = std::sin(toCenter) > 0.0f ? 1.0f : -1.0f;
+        }
+
+        /* steer away from neighbours, closer ones weigh more */
+        float awayX = 0.0f;
+        float awayZ = 0.0f;
+        spatialHashForEach(world.grid, x, z, world.avoidRadius, [&](uint32_t j, float nx, float nz, float d2)
+        {
+            if(j != i && d2 > 0.0f)
+            {
+                awayX += (x - nx) / d2;
+                awayZ += (z - nz) / d2;
+            }
+        });
+
+        if(awayX != 0.0f || awayZ != 0.0f)
+        {
+            /* sign of the cross product tells on which side of the heading the escape direction lies */
+            float s = std::sin(world.heading[i]);
+            float c = std::cos(world.heading[i]);
+            rudder = (c * awayX - s * awayZ) > 0.0f ? 1.0f : -1.0f;
+        }
+
+        world.rudder[i] = rudder;
+    }
+}
+
+void boatWorldMove(BoatWorld& world, const WaterSim& waterSim, float dt, size_t begin, size_t end)
+{
+    size_t n = end - begin;
+    if(n == 0)
+    {
+        return;
+    }
+
+    float sampleX[4 * boatWorldChunk];
+    float sampleZ[4 * boatWorldChunk];
+    float height[4 * boatWorldChunk];
+
+    float* centerX = sampleX;
+    float* centerZ = sampleZ;
+    float* bowX = sampleX + n;
+    float* bowZ = sampleZ + n;
+    float* portX = sampleX + 2 * n;
+    float* portZ = sampleZ + 2 * n;
+    float* starboardX = sampleX + 3 * n;
+    float* starboardZ = sampleZ + 3 * n;
+
+    /* move along heading and place the hull sample points */
+    for(size_t j = 0; j < n; j++)
+    {
+        size_t i = begin + j;
+        float throttle = world.throttle[i];
+
+        world.heading[i] += throttle * world.rudder[i] * dt;
+        float s = std::sin(world.heading[i]);
+        float c = std::cos(world.heading[i]);
+
+        world.positionX[i] += 2.0f * dt * throttle * s;
+        world.positionZ[i] += 2.0f * dt * throttle * c;
+
+        float x = world.positionX[i];
+        float z = world.positionZ[i];
+
+        centerX[j] = x;
+        centerZ[j] = z;
+        bowX[j] = x + c * hullBow[0] + s * hullBow[1];
+        bowZ[j] = z - s * hullBow[0] + c * hullBow[1];
+        portX[j] = x + c * hullPort[0] + s * hullPort[1];
+        portZ[j] = z - s * hullPort[0] + c * hullPort[1];
+        starboardX[j] = x + c * hullStarboard[0] + s * hullStarboard[1];
+        starboardZ[j] = z - s * hullStarboard[0] + c * hullStarboard[1];
+    }
+
+    /* all water samples of the chunk in one batch */
+    waterHeights(waterSim, sampleX, sampleZ, height, 4 * n);
+
+    for(size_t j = 0; j < n; j++)
+    {
+        size_t i = begin + j;
+        world.positionY[i] = height[j];
+
+        Vector3D d0 = {bowX[j], height[n + j], bowZ[j]};
+        Vector3D d1 = {portX[j], height[2 * n + j], portZ[j]};
+        Vector3D d2 = {starboardX[j], height[3 * n + j], starboardZ[j]};
+
+        Matrix4D& transformation = world.transformation[i];
+        transformation = waterBuoyancyRotation(d0, d1, d2);
+        transformation[3] = Vector4D(world.positionX[i], world.positionY[i], world.positionZ[i], 1.0f);
+    }
+}
+
+}
+
+BoatWorld boatWorldCreate(size_t count, float radius, unsigned int seed)
+{
+    BoatWorld world;
+    world.count = count;
+    world.radius = radius;
+
+    world.positionX.resize(count);
+    world.positionY.resize(count, 0.0f);
+    world.positionZ.resize(count);
+    world.heading.resize(count);
+    world.throttle.resize(count);
+    world.rudder.resize(count, 0.0f);
+    world.aiPhase.resize(count);
+    world.transformation.resize(count, Matrix4D::identity());
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    for(size_t i = 0; i < count; i++)
+    {
+        /* uniform in the disc */
+        float r = radius * std::sqrt(unit(rng));
+        float phi = 2.0f * M_PI * unit(rng);
+
+        world.positionX[i] = r * std::sin(phi);
+        world.positionZ[i] = r * std::cos(phi);
+        world.heading[i] = 2.0f * M_PI * unit(rng);
+        world.throttle[i] = 0.5f + 0.5f * unit(rng);
+        world.aiPhase[i] = 2.0f * M_PI * unit(rng);
+    }
+
+    return world;
+}
+
+void boatWorldUpdate(BoatWorld& world, const WaterSim& waterSim, float dt, JobSystem* jobs)
+{
+    if(world.grid.pointBucket.size() != world.count)
+    {
+        spatialHashBuild(world.grid, world.positionX.data(), world.positionZ.data(), world.count, world.avoidRadius);
+    }
+    else
+    {
+        spatialHashUpdate(world.grid, world.positionX.data(), world.positionZ.data(), world.count);
+    }
+
+    jobParallelFor(jobs, world.count, detail::boatWorldChunk, [&](size_t begin, size_t end)
+    {
+        detail::boatWorldSteer(world, waterSim.accumTime, begin, end);
+        detail::boatWorldMove(world, waterSim, dt, begin, end);
+    });
+}
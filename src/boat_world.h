@@ -0,0 +1,54 @@
+#pragma once
+
+#include "job_system.h"
+#include "spatial_hash.h"
+#include "water.h"
+
+#include <vector>
+
+/* Fleet of AI boats stored as structure of arrays. The hot fields are read and written by every step and packed per
+ * component so the update kernel streams through them; render data is only written once at the end of a step. */
+struct BoatWorld
+{
+    size_t count = 0;
+    float radius = 0.0f;
+
+    /* hot simulation state */
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+    std::vector<float> heading;
+    std::vector<float> throttle;
+    std::vector<float> rudder;
+
+    /* AI parameters */
+    std::vector<float> aiPhase;
+    float avoidRadius = 6.0f;
+
+    /* neighbour lookup, rebuilt from the positions at the start of every step */
+    SpatialHash grid;
+
+    /* cold render data */
+    std::vector<Matrix4D> transformation;
+};
+
+/**
+ * @brief Create a fleet with random positions inside a disc around the origin.
+ *
+ * @param count Number of boats.
+ * @param radius Radius of the disc the boats are kept in.
+ * @param seed Seed for the random start state.
+ *
+ * @return Initialized boat world.
+ */
+BoatWorld boatWorldCreate(size_t count, float radius, unsigned int seed = 1);
+
+/**
+ * @brief Advance all boats by one step: AI steering with collision avoidance, movement, water sampling and buoyancy orientation.
+ *
+ * @param world Fleet to update.
+ * @param waterSim Water the boats float on.
+ * @param dt Step size in seconds.
+ * @param jobs Job system to spread the boats over, nullptr updates on the calling thread.
+ */
+void boatWorldUpdate(BoatWorld& world, const WaterSim& waterSim, float dt, JobSystem* jobs);
@@ -0,0 +1,67 @@
+#include "frame_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+FrameTimeStats frameTimeStats(std::vector<double> samples)
+{
+    FrameTimeStats stats;
+    stats.count = samples.size();
+    if(samples.empty())
+    {
+        return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p)
+    {
+        size_t rank = size_t(std::ceil(p * samples.size()));
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    stats.min = samples.front();
+    stats.max = samples.back();
+    stats.p50 = percentile(0.50);
+    stats.p95 = percentile(0.95);
+    stats.p99 = percentile(0.99);
+    return stats;
+}
+
+FrameTimeHistogram frameTimeHistogram(const std::vector<double>& samples)
+{
+    FrameTimeHistogram histogram;
+    for(int k = 0; k <= 52; k++)
+    {
+        histogram.edges.push_back(0.25 * std::exp2(k / 4.0));
+    }
+
+    histogram.counts.assign(histogram.edges.size() + 1, 0);
+    for(double sample : samples)
+    {
+        histogram.counts[std::upper_bound(histogram.edges.begin(), histogram.edges.end(), sample) - histogram.edges.begin()]++;
+    }
+    return histogram;
+}
+
+void frameTimeStatsWriteJson(FILE* file, const FrameTimeStats& stats)
+{
+    fprintf(file, "{\"count\": %zu, \"mean\": %.4f, \"min\": %.4f, \"max\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f}",
+            stats.count, stats.mean, stats.min, stats.max, stats.p50, stats.p95, stats.p99);
+}
+
+void frameTimeHistogramWriteJson(FILE* file, const FrameTimeHistogram& histogram)
+{
+    fprintf(file, "{\"edges\": [");
+    for(size_t i = 0; i < histogram.edges.size(); i++)
+    {
+        fprintf(file, "%s%.4f", i ? ", " : "", histogram.edges[i]);
+    }
+    fprintf(file, "], \"counts\": [");
+    for(size_t i = 0; i < histogram.counts.size(); i++)
+    {
+        fprintf(file, "%s%u", i ? ", " : "", histogram.counts[i]);
+    }
+    fprintf(file, "]}");
+}
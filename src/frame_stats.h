@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+/* summary of a series of frame times, all in milliseconds */
+struct FrameTimeStats
+{
+    size_t count = 0;
+    double mean = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+};
+
+/* frame time counts over fixed bucket edges, so histograms of different runs line up */
+struct FrameTimeHistogram
+{
+    /* bucket i counts times in [edges[i - 1], edges[i]), the first one everything below edges[0] and the last one
+     * everything from edges.back() on */
+    std::vector<double> edges;
+    std::vector<unsigned int> counts;
+};
+
+/**
+ * @brief Summarize frame times. Percentiles use the nearest rank, so they are always one of the samples.
+ *
+ * @param samples Frame times in milliseconds, in any order.
+ *
+ * @return Mean, extremes and percentiles, all zero for no samples.
+ */
+FrameTimeStats frameTimeStats(std::vector<double> samples);
+
+/**
+ * @brief Count frame times in quarter octave buckets from 0.25 ms to 2048 ms.
+ *
+ * @param samples Frame times in milliseconds.
+ *
+ * @return Histogram with edges.size() + 1 buckets.
+ */
+FrameTimeHistogram frameTimeHistogram(const std::vector<double>& samples);
+
+/**
+ * @brief Write frame time statistics as a JSON object, e.g. {"mean": 1.234, ..., "p99": 2.345}.
+ *
+ * @param file Output stream.
+ * @param stats Statistics to write.
+ */
+void frameTimeStatsWriteJson(FILE* file, const FrameTimeStats& stats);
+
+/**
+ * @brief Write a histogram as a JSON object {"edges": [...], "counts": [...]}.
+ *
+ * @param file Output stream.
+ * @param histogram Histogram to write.
+ */
+void frameTimeHistogramWriteJson(FILE* file, const FrameTimeHistogram& histogram);
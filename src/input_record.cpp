@@ -0,0 +1,206 @@
+#include "input_record.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace detail
+{
+
+const char inputMagic[4] = {'I', 'N', 'P', 'T'};
+const uint16_t inputVersion = 1;
+
+/* little endian hosts only, like every platform the project builds on */
+template<typename T>
+void inputWrite(FILE* file, T value)
+{
+    fwrite(&value, sizeof(T), 1, file);
+}
+
+template<typename T>
+T inputRead(const std::vector<char>& data, size_t& offset)
+{
+    if(offset + sizeof(T) > data.size())
+    {
+        throw std::runtime_error("[Input] input file is truncated");
+    }
+    T value;
+    memcpy(&value, data.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+}
+
+bool inputBegin(InputRecorder& recorder, InputEventType type)
+{
+    if(!recorder.file)
+    {
+        return false;
+    }
+    inputWrite<uint8_t>(recorder.file, type);
+    return true;
+}
+
+}
+
+bool inputRecorderCreate(InputRecorder& recorder, const std::string& filepath, int width, int height)
+{
+    recorder.file = fopen(filepath.c_str(), "wb");
+    if(!recorder.file)
+    {
+        return false;
+    }
+
+    fwrite(detail::inputMagic, 1, sizeof(detail::inputMagic), recorder.file);
+    detail::inputWrite<uint16_t>(recorder.file, detail::inputVersion);
+    detail::inputWrite<uint16_t>(recorder.file, 0);
+    detail::inputWrite<int32_t>(recorder.file, width);
+    detail::inputWrite<int32_t>(recorder.file, height);
+    recorder.frames = 0;
+    recorder.events = 0;
+    return true;
+}
+
+void inputRecorderDelete(InputRecorder& recorder)
+{
+    if(recorder.file)
+    {
+        fclose(recorder.file);
+        recorder.file = nullptr;
+    }
+}
+
+void inputRecordKey(InputRecorder& recorder, int key, int scancode, int action, int mods)
+{
+    if(detail::inputBegin(recorder, INPUT_KEY))
+    {
+        detail::inputWrite<int16_t>(recorder.file, key);
+        detail::inputWrite<int16_t>(recorder.file, scancode);
+        detail::inputWrite<uint8_t>(recorder.file, action);
+        detail::inputWrite<uint8_t>(recorder.file, mods);
+        recorder.events++;
+    }
+}
+
+void inputRecordMouseButton(InputRecorder& recorder, int button, int action, int mods, float x, float y)
+{
+    if(detail::inputBegin(recorder, INPUT_MOUSE_BUTTON))
+    {
+        detail::inputWrite<uint8_t>(recorder.file, button);
+        detail::inputWrite<uint8_t>(recorder.file, action);
+        detail::inputWrite<uint8_t>(recorder.file, mods);
+        detail::inputWrite<float>(recorder.file, x);
+        detail::inputWrite<float>(recorder.file, y);
+        recorder.events++;
+    }
+}
+
+void inputRecordCursor(InputRecorder& recorder, float x, float y)
+{
+    if(detail::inputBegin(recorder, INPUT_CURSOR))
+    {
+        detail::inputWrite<float>(recorder.file, x);
+        detail::inputWrite<float>(recorder.file, y);
+        recorder.events++;
+    }
+}
+
+void inputRecordScroll(InputRecorder& recorder, double x, double y)
+{
+    if(detail::inputBegin(recorder, INPUT_SCROLL))
+    {
+        detail::inputWrite<double>(recorder.file, x);
+        detail::inputWrite<double>(recorder.file, y);
+        recorder.events++;
+    }
+}
+
+void inputRecordFrame(InputRecorder& recorder, float dt)
+{
+    if(detail::inputBegin(recorder, INPUT_FRAME))
+    {
+        detail::inputWrite<float>(recorder.file, dt);
+        recorder.frames++;
+    }
+}
+
+InputReplay inputReplayLoad(const std::string& filepath)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    if(!file)
+    {
+        throw std::runtime_error("[Input] Couldn't open input file " + filepath);
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    size_t offset = sizeof(detail::inputMagic);
+    if(data.size() < offset || memcmp(data.data(), detail::inputMagic, offset) != 0)
+    {
+        throw std::runtime_error("[Input] " + filepath + " is not an input recording");
+    }
+    if(detail::inputRead<uint16_t>(data, offset) != detail::inputVersion)
+    {
+        throw std::runtime_error("[Input] " + filepath + " has an unsupported version");
+    }
+    detail::inputRead<uint16_t>(data, offset);
+
+    InputReplay replay;
+    replay.width = detail::inputRead<int32_t>(data, offset);
+    replay.height = detail::inputRead<int32_t>(data, offset);
+    while(offset < data.size())
+    {
+        InputEvent event;
+        event.type = InputEventType(detail::inputRead<uint8_t>(data, offset));
+        switch(event.type)
+        {
+        case INPUT_FRAME:
+            event.dt = detail::inputRead<float>(data, offset);
+            replay.frames++;
+            break;
+        case INPUT_KEY:
+            event.code = detail::inputRead<int16_t>(data, offset);
+            event.scancode = detail::inputRead<int16_t>(data, offset);
+            event.action = detail::inputRead<uint8_t>(data, offset);
+            event.mods = detail::inputRead<uint8_t>(data, offset);
+            break;
+        case INPUT_MOUSE_BUTTON:
+            event.code = detail::inputRead<uint8_t>(data, offset);
+            event.action = detail::inputRead<uint8_t>(data, offset);
+            event.mods = detail::inputRead<uint8_t>(data, offset);
+            event.x = detail::inputRead<float>(data, offset);
+            event.y = detail::inputRead<float>(data, offset);
+            break;
+        case INPUT_CURSOR:
+            event.x = detail::inputRead<float>(data, offset);
+            event.y = detail::inputRead<float>(data, offset);
+            break;
+        case INPUT_SCROLL:
+            event.x = detail::inputRead<double>(data, offset);
+            event.y = detail::inputRead<double>(data, offset);
+            break;
+        default:
+            throw std::runtime_error("[Input] " + filepath + " has an unknown record type " + std::to_string(event.type));
+        }
+        replay.events.push_back(event);
+    }
+    return replay;
+}
+
+bool inputReplayFrame(InputReplay& replay, std::span<const InputEvent>& events, float& dt)
+{
+    /* events after the last frame record were never part of an update */
+    size_t begin = replay.next;
+    while(replay.next < replay.events.size() && replay.events[replay.next].type != INPUT_FRAME)
+    {
+        replay.next++;
+    }
+    if(replay.next == replay.events.size())
+    {
+        return false;
+    }
+
+    events = std::span<const InputEvent>(replay.events).subspan(begin, replay.next - begin);
+    dt = replay.events[replay.next].dt;
+    replay.next++;
+    return true;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+/* record types of an input file, each a type byte followed by a fixed size payload */
+enum InputEventType : uint8_t
+{
+    INPUT_FRAME,
+    INPUT_KEY,
+    INPUT_MOUSE_BUTTON,
+    INPUT_CURSOR,
+    INPUT_SCROLL,
+};
+
+/* one recorded GLFW callback, or the end of a frame with its dt. Fields a record type doesn't use are zero. */
+struct InputEvent
+{
+    InputEventType type = INPUT_FRAME;
+
+    /* key or mouse button */
+    int code = 0;
+    int scancode = 0;
+    int action = 0;
+    int mods = 0;
+
+    /* cursor position or scroll offset */
+    double x = 0.0;
+    double y = 0.0;
+
+    /* frame records only */
+    float dt = 0.0f;
+};
+
+/**
+ * Writes input events to a compact binary file (16 byte header, 5 bytes per frame, 7 to 17 per event). Events carry
+ * no time of their own: the events of a frame are followed by its frame record with the dt the scene was updated
+ * with, so the time of an event is the sum of the dts before it. Values are stored little endian in the precision
+ * the scene uses them (float cursor positions and dt, double scroll offsets), so a replay reproduces the recorded
+ * session exactly.
+ */
+struct InputRecorder
+{
+    FILE* file = nullptr;
+    unsigned int frames = 0;
+    unsigned int events = 0;
+};
+
+/* a loaded input file, replayed frame by frame */
+struct InputReplay
+{
+    std::vector<InputEvent> events;
+    int width = 0;
+    int height = 0;
+    unsigned int frames = 0;
+
+    /* next event to replay */
+    size_t next = 0;
+};
+
+/**
+ * @brief Create the file and write the header.
+ *
+ * @param recorder Recorder to initialize.
+ * @param filepath Output file.
+ * @param width Framebuffer width of the recorded session, stored for the replay.
+ * @param height Framebuffer height.
+ *
+ * @return False if the file couldn't be created.
+ */
+bool inputRecorderCreate(InputRecorder& recorder, const std::string& filepath, int width, int height);
+
+/**
+ * @brief Close the file. Recording functions are no-ops on a closed recorder.
+ */
+void inputRecorderDelete(InputRecorder& recorder);
+
+/* record one GLFW callback with the values the scene uses, no-ops on a closed recorder */
+void inputRecordKey(InputRecorder& recorder, int key, int scancode, int action, int mods);
+void inputRecordMouseButton(InputRecorder& recorder, int button, int action, int mods, float x, float y);
+void inputRecordCursor(InputRecorder& recorder, float x, float y);
+void inputRecordScroll(InputRecorder& recorder, double x, double y);
+
+/**
+ * @brief End the frame: everything recorded since the last frame happened before the scene update with dt.
+ */
+void inputRecordFrame(InputRecorder& recorder, float dt);
+
+/**
+ * @brief Load an input file. Throws a runtime_error if the file can't be read or isn't an input recording.
+ *
+ * @param filepath Input file written by an InputRecorder.
+ *
+ * @return Replay positioned at the first frame.
+ */
+InputReplay inputReplayLoad(const std::string& filepath);
+
+/**
+ * @brief Get the events and dt of the next frame.
+ *
+ * @param replay Replay.
+ * @param events Receives the events of the frame in recorded order, without the frame record.
+ * @param dt Receives the recorded dt.
+ *
+ * @return False once all frames were replayed.
+ */
+bool inputReplayFrame(InputReplay& replay, std::span<const InputEvent>& events, float& dt);
@@ -0,0 +1,453 @@
+#include "job_system.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <string>
+
+namespace detail
+{
+
+/* the system the calling thread belongs to and its deque there */
+thread_local const JobSystem* jobThreadSystem = nullptr;
+thread_local unsigned int jobThreadIndex = 0;
+
+/* deque of the calling thread in a system, -1 for threads outside of it */
+int jobThreadSlot(const JobSystem& system)
+{
+    return jobThreadSystem == &system ? int(jobThreadIndex) : -1;
+}
+
+/* the counters change under the deque locks, so ready is never below the number of queued jobs */
+void jobPush(JobSystem& system, JobHandle job)
+{
+    if(job->queue == JOB_MAIN)
+    {
+        {
+            std::lock_guard<std::mutex> lock(system.mainQueue.mutex);
+            system.mainQueue.jobs.push_back(std::move(job));
+            system.mainReady++;
+        }
+
+        /* only the main thread can take it, waking a single thread could pick a worker */
+        {
+            std::lock_guard<std::mutex> lock(system.mutex);
+        }
+        system.wake.notify_all();
+        return;
+    }
+
+    /* threads outside the system hand their jobs to the main thread's deque, the workers steal them from there */
+    int slot = jobThreadSlot(system);
+    JobDeque& deque = system.deques[std::max(slot, 0)];
+    {
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        deque.jobs.push_back(std::move(job));
+        system.ready++;
+    }
+
+    /* the empty lock orders the push before a sleeping thread checks its predicate again */
+    {
+        std::lock_guard<std::mutex> lock(system.mutex);
+    }
+    system.wake.notify_one();
+}
+
+JobHandle jobTakeMain(JobSystem& system)
+{
+    if(system.mainReady == 0)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(system.mainQueue.mutex);
+    if(system.mainQueue.jobs.empty())
+    {
+        return nullptr;
+    }
+    JobHandle job = std::move(system.mainQueue.jobs.front());
+    system.mainQueue.jobs.pop_front();
+    system.mainReady--;
+    system.mainExecuted++;
+    return job;
+}
+
+/* the main thread prefers JOB_MAIN jobs, other jobs can run on any thread */
+JobHandle jobTake(JobSystem& system, int slot)
+{
+    if(slot == 0)
+    {
+        if(JobHandle job = jobTakeMain(system))
+        {
+            return job;
+        }
+    }
+
+    if(system.ready == 0)
+    {
+        return nullptr;
+    }
+
+    /* newest job of the own deque, its data is most likely still in the cache */
+    if(slot >= 0)
+    {
+        JobDeque& deque = system.deques[slot];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        if(!deque.jobs.empty())
+        {
+            JobHandle job = std::move(deque.jobs.back());
+            deque.jobs.pop_back();
+            system.ready--;
+            return job;
+        }
+    }
+
+    /* oldest job of another deque, usually the root of the most remaining work */
+    unsigned int start = slot >= 0 ? slot + 1 : 0;
+    for(unsigned int i = 0; i < system.threadCount; i++)
+    {
+        unsigned int victim = (start + i) % system.threadCount;
+        if(int(victim) == slot)
+        {
+            continue;
+        }
+
+        JobDeque& deque = system.deques[victim];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        if(!deque.jobs.empty())
+        {
+            JobHandle job = std::move(deque.jobs.front());
+            deque.jobs.pop_front();
+            system.ready--;
+            system.stolen++;
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void jobSetError(Job& job, const std::exception_ptr& error)
+{
+    std::lock_guard<std::mutex> lock(job.mutex);
+    if(!job.error)
+    {
+        job.error = error;
+    }
+}
+
+/* run a ready job and release its dependents, system is nullptr for jobs run right away */
+void jobRun(JobSystem* system, const JobHandle& job)
+{
+    /* all dependencies finished before the job got ready, so their errors are visible without the lock */
+    if(!job->error)
+    {
+        try
+        {
+            job->fn();
+        }
+        catch(...)
+        {
+            jobSetError(*job, std::current_exception());
+        }
+    }
+    job->fn = nullptr;
+
+    std::vector<JobHandle> dependents;
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished = true;
+        dependents.swap(job->dependents);
+        error = job->error;
+    }
+    job->done = true;
+
+    if(!system)
+    {
+        return;
+    }
+    system->executed++;
+
+    for(auto& dependent : dependents)
+    {
+        if(error)
+        {
+            jobSetError(*dependent, error);
+        }
+        if(dependent->pending.fetch_sub(1) == 1)
+        {
+            jobPush(*system, std::move(dependent));
+        }
+    }
+
+    /* a waiter registers before it checks done, so either it sees done or this sees it waiting */
+    if(system->waiting > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(system->mutex);
+        }
+        system->wake.notify_all();
+    }
+}
+
+void jobWorker(JobSystem* system, unsigned int index)
+{
+    jobThreadSystem = system;
+    jobThreadIndex = index;
+    profilerSetThreadName("job worker " + std::to_string(index));
+
+    while(true)
+    {
+        if(JobHandle job = jobTake(*system, index))
+        {
+            PROFILE_ZONE("job");
+            jobRun(system, job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(system->mutex);
+        system->wake.wait(lock, [&]{ return system->stop || system->ready > 0; });
+        if(system->stop)
+        {
+            return;
+        }
+    }
+}
+
+}
+
+void jobSystemCreate(JobSystem& system, unsigned int threadCount)
+{
+    if(threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    system.threadCount = threadCount;
+    system.deques = std::make_unique<JobDeque[]>(threadCount);
+    system.stop = false;
+    detail::jobThreadSystem = &system;
+    detail::jobThreadIndex = 0;
+
+    for(unsigned int i = 1; i < threadCount; i++)
+    {
+        system.workers.emplace_back(detail::jobWorker, &system, i);
+    }
+}
+
+void jobSystemDelete(JobSystem& system)
+{
+    {
+        std::lock_guard<std::mutex> lock(system.mutex);
+        system.stop = true;
+    }
+    system.wake.notify_all();
+
+    for(auto& worker : system.workers)
+    {
+        worker.join();
+    }
+    system.workers.clear();
+
+    if(detail::jobThreadSystem == &system)
+    {
+        detail::jobThreadSystem = nullptr;
+    }
+}
+
+JobHandle jobSubmit(JobSystem* system, std::function<void()> fn, const std::vector<JobHandle>& dependencies, JobQueue queue)
+{
+    auto job = std::make_shared<Job>();
+    job->fn = std::move(fn);
+    job->queue = queue;
+
+    /* without a system every job runs right away, so its dependencies are already done */
+    if(!system)
+    {
+        for(const auto& dependency : dependencies)
+        {
+            if(dependency && dependency->error)
+            {
+                job->error = dependency->error;
+            }
+        }
+        detail::jobRun(nullptr, job);
+        return job;
+    }
+
+    /* the extra count keeps a dependency that finishes meanwhile from pushing the job before all are linked */
+    job->pending = 1;
+    for(const auto& dependency : dependencies)
+    {
+        if(!dependency)
+        {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(dependency->mutex);
+        if(dependency->finished)
+        {
+            if(dependency->error)
+            {
+                detail::jobSetError(*job, dependency->error);
+            }
+        }
+        else
+        {
+            job->pending++;
+            dependency->dependents.push_back(job);
+        }
+    }
+
+    if(job->pending.fetch_sub(1) == 1)
+    {
+        detail::jobPush(*system, job);
+    }
+    return job;
+}
+
+void jobWait(JobSystem* system, const JobHandle& job)
+{
+    if(!job)
+    {
+        return;
+    }
+
+    if(system)
+    {
+        int slot = detail::jobThreadSlot(*system);
+        while(!job->done)
+        {
+            if(JobHandle next = detail::jobTake(*system, slot))
+            {
+                detail::jobRun(system, next);
+                continue;
+            }
+
+            system->waiting++;
+            {
+                std::unique_lock<std::mutex> lock(system->mutex);
+                system->wake.wait(lock, [&]
+                {
+                    return job->done || system->ready > 0 || (slot == 0 && system->mainReady > 0);
+                });
+            }
+            system->waiting--;
+        }
+    }
+
+    if(job->error)
+    {
+        std::rethrow_exception(job->error);
+    }
+}
+
+void jobWait(JobSystem* system, const std::vector<JobHandle>& jobs)
+{
+    std::exception_ptr error;
+    for(const auto& job : jobs)
+    {
+        try
+        {
+            jobWait(system, job);
+        }
+        catch(...)
+        {
+            if(!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    if(error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+bool jobDone(const JobHandle& job)
+{
+    return !job || job->done;
+}
+
+void jobParallelFor(JobSystem* system, size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn)
+{
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (count + grain - 1) / grain;
+
+    /* nothing to share, skip the synchronization */
+    if(!system || system->threadCount == 1 || chunks <= 1)
+    {
+        for(size_t begin = 0; begin < count; begin += grain)
+        {
+            fn(begin, std::min(begin + grain, count));
+        }
+        return;
+    }
+
+    /* helpers grab chunks like the caller does, one that starts after the last chunk was taken returns right away */
+    std::atomic<size_t> next = 0;
+    auto runChunks = [&]
+    {
+        while(true)
+        {
+            size_t begin = next.fetch_add(grain);
+            if(begin >= count)
+            {
+                break;
+            }
+            fn(begin, std::min(begin + grain, count));
+        }
+    };
+
+    std::vector<JobHandle> helpers;
+    for(size_t i = 0; i < std::min<size_t>(system->threadCount - 1, chunks - 1); i++)
+    {
+        helpers.push_back(jobSubmit(system, runChunks));
+    }
+
+    /* the helpers reference this frame, so they have to finish even if a chunk of the caller throws */
+    try
+    {
+        runChunks();
+    }
+    catch(...)
+    {
+        next = count;
+        try
+        {
+            jobWait(system, helpers);
+        }
+        catch(...)
+        {
+        }
+        throw;
+    }
+    jobWait(system, helpers);
+}
+
+unsigned int jobRunMain(JobSystem& system)
+{
+    if(detail::jobThreadSlot(system) != 0)
+    {
+        return 0;
+    }
+
+    unsigned int count = 0;
+    while(JobHandle job = detail::jobTakeMain(system))
+    {
+        detail::jobRun(&system, job);
+        count++;
+    }
+    return count;
+}
+
+unsigned int jobSystemSize(const JobSystem* system)
+{
+    return system ? system->threadCount : 1;
+}
+
+JobStats jobSystemStats(const JobSystem& system)
+{
+    return JobStats{system.executed, system.stolen, system.mainExecuted};
+}
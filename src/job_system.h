@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* threads a job may run on */
+enum JobQueue
+{
+    /* any thread of the system, workers and the main thread while it waits */
+    JOB_ANY,
+
+    /* only the thread that created the system, for work that needs the GL context */
+    JOB_MAIN,
+};
+
+struct Job
+{
+    std::function<void()> fn;
+    JobQueue queue = JOB_ANY;
+
+    /* unfinished dependencies, plus one held by jobSubmit until the job is linked to all of them */
+    std::atomic<unsigned int> pending = 0;
+
+    /* jobs released when this one finishes, and the exception of fn or of a failed dependency, guarded by mutex */
+    std::mutex mutex;
+    bool finished = false;
+    std::vector<std::shared_ptr<Job>> dependents;
+    std::exception_ptr error;
+
+    /* set after dependents were taken, for jobWait and jobDone */
+    std::atomic<bool> done = false;
+};
+
+/* a submitted job, stays valid as long as it is held */
+using JobHandle = std::shared_ptr<Job>;
+
+/* ready jobs of one thread; its owner pushes and pops at the back, other threads steal the oldest from the front */
+struct JobDeque
+{
+    std::mutex mutex;
+    std::deque<JobHandle> jobs;
+};
+
+struct JobStats
+{
+    unsigned long long executed = 0;
+    unsigned long long stolen = 0;
+    unsigned long long mainExecuted = 0;
+};
+
+/**
+ * Work-stealing scheduler. Every thread has a deque of ready jobs: jobs submitted by a thread go to its own deque, an
+ * idle thread takes the newest job of its own deque and otherwise steals the oldest job of another one. A job becomes
+ * ready once all its dependencies finished, and is pushed by the thread that finished the last of them. The creating
+ * thread is the main thread: it has a deque like the workers, runs jobs whenever it waits, and is the only thread that
+ * runs JOB_MAIN jobs.
+ */
+struct JobSystem
+{
+    std::vector<std::thread> workers;
+
+    /* deque 0 belongs to the main thread, deque i to worker i */
+    std::unique_ptr<JobDeque[]> deques;
+    unsigned int threadCount = 1;
+    JobDeque mainQueue;
+
+    /* idle threads sleep on wake until a job is pushed or a job they wait for finishes */
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<size_t> ready = 0;
+    std::atomic<size_t> mainReady = 0;
+    std::atomic<unsigned int> waiting = 0;
+    bool stop = false;
+
+    std::atomic<unsigned long long> executed = 0;
+    std::atomic<unsigned long long> stolen = 0;
+    std::atomic<unsigned long long> mainExecuted = 0;
+};
+
+/**
+ * @brief Start the worker threads. The calling thread becomes the main thread of the system.
+ *
+ * @param system System to initialize.
+ * @param threadCount Number of threads including the main thread, 0 uses the hardware concurrency.
+ */
+void jobSystemCreate(JobSystem& system, unsigned int threadCount = 0);
+
+/**
+ * @brief Join all workers. Has to be called for each system after it is not used anymore, with no job left to run.
+ *
+ * @param system System to delete.
+ */
+void jobSystemDelete(JobSystem& system);
+
+/**
+ * @brief Submit a job that runs once all dependencies finished. A failed dependency fails the job without running it.
+ *
+ * @param system Job system, nullptr runs the job right away on the calling thread.
+ * @param fn Work of the job, exceptions it throws are rethrown by jobWait.
+ * @param dependencies Jobs that have to finish first.
+ * @param queue JOB_MAIN for jobs that have to run on the main thread.
+ *
+ * @return Handle to wait for the job or to pass as a dependency.
+ */
+JobHandle jobSubmit(JobSystem* system, std::function<void()> fn, const std::vector<JobHandle>& dependencies = {}, JobQueue queue = JOB_ANY);
+
+/**
+ * @brief Run other jobs until a job finished, sleep if there is nothing to run. On the main thread this includes
+ * JOB_MAIN jobs, so whatever waits on the main thread may run GL work submitted by other jobs. Rethrows the exception
+ * of the job.
+ *
+ * @param system Job system the job was submitted to, nullptr if it was run right away.
+ * @param job Job to wait for.
+ */
+void jobWait(JobSystem* system, const JobHandle& job);
+
+/**
+ * @brief Wait for several jobs, see jobWait. Waits for all of them before the first exception is rethrown.
+ */
+void jobWait(JobSystem* system, const std::vector<JobHandle>& jobs);
+
+/**
+ * @brief Whether a job finished, without waiting.
+ */
+bool jobDone(const JobHandle& job);
+
+/**
+ * @brief Split [0, count) into chunks of grain elements and run them on all threads. The calling thread works on the
+ * chunks too and runs other jobs until the last one finished, so parallel-fors may be nested inside jobs.
+ *
+ * @param system Job system, nullptr runs everything on the calling thread.
+ * @param count Number of elements.
+ * @param grain Number of elements per chunk.
+ * @param fn Function called with [begin, end) of a chunk.
+ */
+void jobParallelFor(JobSystem* system, size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+/**
+ * @brief Run the JOB_MAIN jobs that are ready, without waiting for others. Called once per frame by the main loop.
+ *
+ * @return Number of jobs run.
+ */
+unsigned int jobRunMain(JobSystem& system);
+
+/**
+ * @brief Number of threads that run jobs (workers + main thread).
+ */
+unsigned int jobSystemSize(const JobSystem* system);
+
+/**
+ * @brief Jobs run since the system was created, how many of them were stolen from another thread and how many were
+ * JOB_MAIN jobs.
+ */
+JobStats jobSystemStats(const JobSystem& system);
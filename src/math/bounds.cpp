@@ -0,0 +1,68 @@
+#include "bounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+Bounds boundsCreate(const Vector3D* points, size_t count)
+{
+    if(count == 0)
+    {
+        return Bounds();
+    }
+
+    Vector3D min = points[0];
+    Vector3D max = points[0];
+    for(size_t i = 1; i < count; i++)
+    {
+        min = Vector3D(std::min(min.x, points[i].x), std::min(min.y, points[i].y), std::min(min.z, points[i].z));
+        max = Vector3D(std::max(max.x, points[i].x), std::max(max.y, points[i].y), std::max(max.z, points[i].z));
+    }
+
+    Bounds bounds;
+    bounds.center = 0.5f * (min + max);
+    bounds.extent = 0.5f * (max - min);
+
+    /* the box diagonal over-estimates, the farthest point gives the tight sphere around this center */
+    float radius2 = 0.0f;
+    for(size_t i = 0; i < count; i++)
+    {
+        Vector3D d = points[i] - bounds.center;
+        radius2 = std::max(radius2, dot(d, d));
+    }
+    bounds.radius = std::sqrt(radius2);
+
+    return bounds;
+}
+
+void boundsCorners(const Bounds& bounds, Vector3D corners[8])
+{
+    for(int i = 0; i < 8; i++)
+    {
+        corners[i] = bounds.center + Vector3D((i & 1) ? bounds.extent.x : -bounds.extent.x,
+                                              (i & 2) ? bounds.extent.y : -bounds.extent.y,
+                                              (i & 4) ? bounds.extent.z : -bounds.extent.z);
+    }
+}
+
+Bounds boundsExpand(const Bounds& bounds, const Vector3D& margin)
+{
+    Bounds result;
+    result.center = bounds.center;
+    result.extent = bounds.extent + margin;
+    result.radius = bounds.radius + length(margin);
+    return result;
+}
+
+Bounds boundsTransform(const Bounds& bounds, const Matrix4D& M)
+{
+    /* the half extent of the transformed box is |M| * extent, which is what the eight transformed corners span */
+    Bounds result;
+    result.center = Vector3D(M * Vector4D(bounds.center, 1.0f));
+    result.extent = Vector3D(std::abs(M(0,0)) * bounds.extent.x + std::abs(M(0,1)) * bounds.extent.y + std::abs(M(0,2)) * bounds.extent.z,
+                             std::abs(M(1,0)) * bounds.extent.x + std::abs(M(1,1)) * bounds.extent.y + std::abs(M(1,2)) * bounds.extent.z,
+                             std::abs(M(2,0)) * bounds.extent.x + std::abs(M(2,1)) * bounds.extent.y + std::abs(M(2,2)) * bounds.extent.z);
+
+    float scale2 = std::max({dot(Vector3D(M[0]), Vector3D(M[0])), dot(Vector3D(M[1]), Vector3D(M[1])), dot(Vector3D(M[2]), Vector3D(M[2]))});
+    result.radius = bounds.radius * std::sqrt(scale2);
+    return result;
+}
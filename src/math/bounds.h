@@ -0,0 +1,44 @@
+#pragma once
+
+#include "matrix4d.h"
+
+#include <cstddef>
+
+/* bounding volume: axis aligned box given by center and half extent, plus the sphere around the same center */
+struct Bounds
+{
+    Vector3D center = {0.0f, 0.0f, 0.0f};
+    Vector3D extent = {0.0f, 0.0f, 0.0f};
+    float radius = 0.0f;
+};
+
+/**
+ * @brief Bounds of a point set.
+ *
+ * @param points Points to enclose.
+ * @param count Number of points, empty sets give zero sized bounds at the origin.
+ *
+ * @return Tight box and the sphere around its center.
+ */
+Bounds boundsCreate(const Vector3D* points, size_t count);
+
+/**
+ * @brief The eight corners of the box of bounds.
+ */
+void boundsCorners(const Bounds& bounds, Vector3D corners[8]);
+
+/**
+ * @brief Bounds grown by a margin on every side, e.g. for geometry displaced in the vertex shader.
+ */
+Bounds boundsExpand(const Bounds& bounds, const Vector3D& margin);
+
+/**
+ * @brief Axis aligned bounds of the transformed box. The radius is scaled by the largest axis scale of M, so it stays
+ * conservative for non rigid transformations.
+ *
+ * @param bounds Bounds in local space.
+ * @param M Affine transformation.
+ *
+ * @return Bounds in the target space.
+ */
+Bounds boundsTransform(const Bounds& bounds, const Matrix4D& M);
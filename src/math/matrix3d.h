@@ -9,32 +9,114 @@ struct Matrix3D
     float n[3][3];
 
 
-    Matrix3D();
-    Matrix3D(float n00, float n01, float n02,
-             float n10, float n11, float n12,
-             float n20, float n21, float n22);
-    Matrix3D(Matrix4D& m);
-
-    static Matrix3D identity();
-    static Matrix3D scale(float sx, float sy, float sz);
+    constexpr Matrix3D()
+        : n{}
+    {
+
+    }
+
+    constexpr Matrix3D(float n00, float n01, float n02,
+                       float n10, float n11, float n12,
+                       float n20, float n21, float n22)
+        : n{{n00, n10, n20},
+            {n01, n11, n21},
+            {n02, n12, n22}}
+    {
+
+    }
+
+    /* defined in matrix4d.h */
+    constexpr Matrix3D(const Matrix4D& M);
+
+    static constexpr Matrix3D identity()
+    {
+        return Matrix3D( 1, 0, 0,
+                         0, 1, 0,
+                         0, 0, 1 );
+    }
+
+    static constexpr Matrix3D scale(float sx, float sy, float sz)
+    {
+        return Matrix3D( sx,  0.0f, 0.0f,
+                        0.0f,  sy,  0.0f,
+                        0.0f, 0.0f,  sz);
+    }
+
     static Matrix3D rotationX(float r);
     static Matrix3D rotationY(float r);
     static Matrix3D rotationZ(float r);
     static Matrix3D rotation(float r, const Vector3D& a);
     static Vector3D eulerAngles(const Matrix3D& m);
 
-    float& operator ()(int i, int j);
-    const float& operator ()(int i, int j) const;
-    Vector3D& operator [](int j);
-    const Vector3D& operator [](int j) const;
-    const float* ptr() const;
+    constexpr float& operator ()(int i, int j)
+    {
+        assert(i < 3 && j < 3);
+        return n[j][i];
+    }
+
+    constexpr const float& operator ()(int i, int j) const
+    {
+        assert(i < 3 && j < 3);
+        return n[j][i];
+    }
+
+    Vector3D& operator [](int j)
+    {
+        assert(j < 3);
+        return *reinterpret_cast<Vector3D *>(n[j]);
+    }
+
+    const Vector3D& operator [](int j) const
+    {
+        assert(j < 3);
+        return *reinterpret_cast<const Vector3D *>(n[j]);
+    }
+
+    constexpr const float* ptr() const
+    {
+        return &(n[0][0]);
+    }
 
     friend std::ostream& operator<<(std::ostream& os, const Matrix3D& M);
 };
 
-Matrix3D operator *(const Matrix3D& A, const Matrix3D& B);
-Vector3D operator *(const Matrix3D& M, const Vector3D& v);
+constexpr Matrix3D operator *(const Matrix3D& A, const Matrix3D& B)
+{
+    return (Matrix3D(A(0,0) * B(0,0) + A(0,1) * B(1,0) + A(0,2) * B(2,0),
+                     A(0,0) * B(0,1) + A(0,1) * B(1,1) + A(0,2) * B(2,1),
+                     A(0,0) * B(0,2) + A(0,1) * B(1,2) + A(0,2) * B(2,2),
+
+                     A(1,0) * B(0,0) + A(1,1) * B(1,0) + A(1,2) * B(2,0),
+                     A(1,0) * B(0,1) + A(1,1) * B(1,1) + A(1,2) * B(2,1),
+                     A(1,0) * B(0,2) + A(1,1) * B(1,2) + A(1,2) * B(2,2),
+
+                     A(2,0) * B(0,0) + A(2,1) * B(1,0) + A(2,2) * B(2,0),
+                     A(2,0) * B(0,1) + A(2,1) * B(1,1) + A(2,2) * B(2,1),
+                     A(2,0) * B(0,2) + A(2,1) * B(1,2) + A(2,2) * B(2,2)));
+}
+
+constexpr Vector3D operator *(const Matrix3D& M, const Vector3D& v)
+{
+    return (Vector3D(M(0,0) * v.x + M(0,1) * v.y + M(0,2) * v.z,
+                     M(1,0) * v.x + M(1,1) * v.y + M(1,2) * v.z,
+                     M(2,0) * v.x + M(2,1) * v.y + M(2,2) * v.z));
+}
+
+constexpr Matrix3D inverse(const Matrix3D& M)
+{
+    Vector3D a(M.n[0][0], M.n[0][1], M.n[0][2]);
+    Vector3D b(M.n[1][0], M.n[1][1], M.n[1][2]);
+    Vector3D c(M.n[2][0], M.n[2][1], M.n[2][2]);
+
+    Vector3D r0 = cross(b, c);
+    Vector3D r1 = cross(c, a);
+    Vector3D r2 = cross(a, b);
+
+    float invDet = 1.0F / dot(r2, c);
 
-Matrix3D inverse(const Matrix3D& M);
+    return (Matrix3D(r0.x * invDet, r0.y * invDet, r0.z * invDet,
+                     r1.x * invDet, r1.y * invDet, r1.z * invDet,
+                     r2.x * invDet, r2.y * invDet, r2.z * invDet));
+}
 
 const std::string toString(const Matrix3D& M);
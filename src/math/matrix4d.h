@@ -1,44 +1,351 @@
 #pragma once
 
 #include "matrix3d.h"
+#include "simd.h"
 #include "vector4d.h"
 
+#include <type_traits>
 
-struct Matrix4D
+/* column major, 16 byte aligned so every column can be loaded as one SIMD register */
+struct alignas(16) Matrix4D
 {
     float n[4][4];
 
-    Matrix4D();
-    Matrix4D(float n00, float n01, float n02, float n03,
-             float n10, float n11, float n12, float n13,
-             float n20, float n21, float n22, float n23,
-             float n30, float n31, float n32, float n33);
+    constexpr Matrix4D()
+        : n{}
+    {
 
-    Matrix4D(const Vector4D& a, const Vector4D& b, const Vector4D& c, const Vector4D& d);
-    Matrix4D(const Matrix3D& M);
+    }
+
+    constexpr Matrix4D(float n00, float n01, float n02, float n03,
+                       float n10, float n11, float n12, float n13,
+                       float n20, float n21, float n22, float n23,
+                       float n30, float n31, float n32, float n33)
+        : n{{n00, n10, n20, n30},
+            {n01, n11, n21, n31},
+            {n02, n12, n22, n32},
+            {n03, n13, n23, n33}}
+    {
+
+    }
+
+    constexpr Matrix4D(const Vector4D& a, const Vector4D& b, const Vector4D& c, const Vector4D& d)
+        : n{{a.x, a.y, a.z, a.w},
+            {b.x, b.y, b.z, b.w},
+            {c.x, c.y, c.z, c.w},
+            {d.x, d.y, d.z, d.w}}
+    {
+
+    }
+
+    constexpr Matrix4D(const Matrix3D& M)
+        : n{{M(0,0), M(1,0), M(2,0), 0},
+            {M(0,1), M(1,1), M(2,1), 0},
+            {M(0,2), M(1,2), M(2,2), 0},
+            {0,      0,      0,      1}}
+    {
+
+    }
+
+    static constexpr Matrix4D identity()
+    {
+        return Matrix4D(1, 0, 0, 0,
+                        0, 1, 0, 0,
+                        0, 0, 1, 0,
+                        0, 0, 0, 1);
+    }
+
+    static constexpr Matrix4D scale(float sx, float sy, float sz)
+    {
+        return Matrix4D(Matrix3D::scale(sx, sy, sz));
+    }
 
-    static Matrix4D identity();
-    static Matrix4D scale(float sx, float sy, float sz);
     static Matrix4D rotationX(float r);
     static Matrix4D rotationY(float r);
     static Matrix4D rotationZ(float r);
     static Matrix4D rotation(float r, const Vector3D& a);
-    static Matrix4D translation(const Vector3D& v);
+
+    static constexpr Matrix4D translation(const Vector3D& v)
+    {
+        return Matrix4D(1, 0, 0, v.x,
+                        0, 1, 0, v.y,
+                        0, 0, 1, v.z,
+                        0, 0, 0,  1  );
+    }
+
     static Matrix4D perspective(float fov, float aspect, float nearPlane, float farPlane);
-    static Matrix4D ortho(float left, float bottom, float right, float top, float nearPlane, float farPlane);
 
-    float& operator ()(int i, int j);
-    const float& operator ()(int i, int j) const;
-    Vector4D& operator [](int j);
-    const Vector4D& operator [](int j) const;
-    const float* ptr() const;
+    static constexpr Matrix4D ortho(float left, float bottom, float right, float top, float near, float far)
+    {
+        return Matrix4D(
+                    2.0f / (right - left),  0.0f,                   0.0f,                   -(right+left)/(right-left),
+                    0.0f,                   2.0f / (top - bottom),  0.0f,                   -(top+bottom)/(top-bottom),
+                    0.0f,                   0.0f,                   -2.0f / (far - near),   -(far+near)/(far-near),
+                    0.0f,                   0.0f,                   0.0f,                   1.0f
+                    );
+    }
+
+    constexpr float& operator ()(int i, int j)
+    {
+        assert(i < 4 && j < 4);
+        return n[j][i];
+    }
+
+    constexpr const float& operator ()(int i, int j) const
+    {
+        assert(i < 4 && j < 4);
+        return n[j][i];
+    }
+
+    Vector4D& operator [](int j)
+    {
+        assert(j < 4);
+        return *reinterpret_cast<Vector4D *>(n[j]);
+    }
+
+    const Vector4D& operator [](int j) const
+    {
+        assert(j < 4);
+        return *reinterpret_cast<const Vector4D *>(n[j]);
+    }
+
+    constexpr const float* ptr() const
+    {
+        return &(n[0][0]);
+    }
 
     friend std::ostream& operator<<(std::ostream& os, const Matrix4D& M);
 };
 
-Matrix4D operator *(const Matrix4D& A, const Matrix4D& B);
-Vector4D operator *(const Matrix4D& M, const Vector4D& v);
+constexpr Matrix3D::Matrix3D(const Matrix4D& M)
+    : n{{M(0,0), M(1,0), M(2,0)},
+        {M(0,1), M(1,1), M(2,1)},
+        {M(0,2), M(1,2), M(2,2)}}
+{
+
+}
+
+namespace detail
+{
+
+/* scalar kernels, used for constant evaluation and on targets without SSE */
+constexpr Matrix4D multiplyScalar(const Matrix4D& A, const Matrix4D& B)
+{
+    Matrix4D R;
+    for(int j = 0; j < 4; j++)
+    {
+        for(int i = 0; i < 4; i++)
+        {
+            R.n[j][i] = A.n[0][i] * B.n[j][0] + A.n[1][i] * B.n[j][1] + A.n[2][i] * B.n[j][2] + A.n[3][i] * B.n[j][3];
+        }
+    }
+    return R;
+}
+
+constexpr Vector4D multiplyScalar(const Matrix4D& M, const Vector4D& v)
+{
+    return Vector4D(M.n[0][0] * v.x + M.n[1][0] * v.y + M.n[2][0] * v.z + M.n[3][0] * v.w,
+                    M.n[0][1] * v.x + M.n[1][1] * v.y + M.n[2][1] * v.z + M.n[3][1] * v.w,
+                    M.n[0][2] * v.x + M.n[1][2] * v.y + M.n[2][2] * v.z + M.n[3][2] * v.w,
+                    M.n[0][3] * v.x + M.n[1][3] * v.y + M.n[2][3] * v.z + M.n[3][3] * v.w);
+}
+
+constexpr Matrix4D inverseScalar(const Matrix4D& M)
+{
+    Vector3D a(M.n[0][0], M.n[0][1], M.n[0][2]);
+    Vector3D b(M.n[1][0], M.n[1][1], M.n[1][2]);
+    Vector3D c(M.n[2][0], M.n[2][1], M.n[2][2]);
+    Vector3D d(M.n[3][0], M.n[3][1], M.n[3][2]);
+
+    float x = M(3,0);
+    float y = M(3,1);
+    float z = M(3,2);
+    float w = M(3,3);
+
+    Vector3D s = cross(a, b);
+    Vector3D t = cross(c, d);
+    Vector3D u = a * y - b * x;
+    Vector3D v = c * w - d * z;
+
+    float invDet = 1.0f / (dot(s, v) + dot(t, u));
+    s *= invDet;
+    t *= invDet;
+    u *= invDet;
+    v *= invDet;
+
+    Vector3D r0 = cross(b, v) + t * y;
+    Vector3D r1 = cross(v, a) - t * x;
+    Vector3D r2 = cross(d, u) + s * w;
+    Vector3D r3 = cross(u, c) - s * z;
+
+    return (Matrix4D(r0.x, r0.y, r0.z, -dot(b, t),
+                     r1.x, r1.y, r1.z,  dot(a, t),
+                     r2.x, r2.y, r2.z, -dot(d, s),
+                     r3.x, r3.y, r3.z,  dot(c, s)));
+}
+
+#ifdef MATH_SIMD_SSE
 
-Matrix4D inverse(const Matrix4D& M);
+inline Matrix4D multiplySimd(const Matrix4D& A, const Matrix4D& B)
+{
+    Matrix4D R;
+
+#ifdef MATH_SIMD_AVX
+    /* two result columns per iteration, every 128 bit half broadcasts its own column of B */
+    __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(A.n[0]));
+    __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(A.n[1]));
+    __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(A.n[2]));
+    __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(A.n[3]));
+
+    for(int j = 0; j < 4; j += 2)
+    {
+        __m256 b = _mm256_loadu_ps(B.n[j]);
+        __m256 r = _mm256_mul_ps(a0, _mm256_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1))));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2))));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm256_storeu_ps(R.n[j], r);
+    }
+#else
+    /* column j of the result is A's columns weighted by column j of B */
+    __m128 a0 = _mm_load_ps(A.n[0]);
+    __m128 a1 = _mm_load_ps(A.n[1]);
+    __m128 a2 = _mm_load_ps(A.n[2]);
+    __m128 a3 = _mm_load_ps(A.n[3]);
+
+    for(int j = 0; j < 4; j++)
+    {
+        __m128 r = _mm_mul_ps(a0, _mm_set1_ps(B.n[j][0]));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(B.n[j][1])));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(B.n[j][2])));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(B.n[j][3])));
+        _mm_store_ps(R.n[j], r);
+    }
+#endif
+
+    return R;
+}
+
+inline Vector4D multiplySimd(const Matrix4D& M, const Vector4D& v)
+{
+    __m128 r = _mm_mul_ps(_mm_load_ps(M.n[0]), _mm_set1_ps(v.x));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(M.n[1]), _mm_set1_ps(v.y)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(M.n[2]), _mm_set1_ps(v.z)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(M.n[3]), _mm_set1_ps(v.w)));
+
+    Vector4D result;
+    _mm_store_ps(&result.x, r);
+    return result;
+}
+
+/* a.yzx * b.zxy - a.zxy * b.yzx, the w lane stays zero as long as a.w * b.w is finite */
+inline __m128 cross3(__m128 a, __m128 b)
+{
+    __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+    return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+/* dot product broadcast to all lanes */
+inline __m128 dot4(__m128 a, __m128 b)
+{
+    __m128 m = _mm_mul_ps(a, b);
+    __m128 s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+inline Matrix4D inverseSimd(const Matrix4D& M)
+{
+    /* same algorithm as the scalar path, the columns carry the bottom row in their w lane */
+    __m128 a = _mm_load_ps(M.n[0]);
+    __m128 b = _mm_load_ps(M.n[1]);
+    __m128 c = _mm_load_ps(M.n[2]);
+    __m128 d = _mm_load_ps(M.n[3]);
+
+    __m128 x = _mm_set1_ps(M.n[0][3]);
+    __m128 y = _mm_set1_ps(M.n[1][3]);
+    __m128 z = _mm_set1_ps(M.n[2][3]);
+    __m128 w = _mm_set1_ps(M.n[3][3]);
+
+    /* the w lanes of s, t, u, v cancel to zero */
+    __m128 s = cross3(a, b);
+    __m128 t = cross3(c, d);
+    __m128 u = _mm_sub_ps(_mm_mul_ps(a, y), _mm_mul_ps(b, x));
+    __m128 v = _mm_sub_ps(_mm_mul_ps(c, w), _mm_mul_ps(d, z));
+
+    __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), _mm_add_ps(dot4(s, v), dot4(t, u)));
+    s = _mm_mul_ps(s, invDet);
+    t = _mm_mul_ps(t, invDet);
+    u = _mm_mul_ps(u, invDet);
+    v = _mm_mul_ps(v, invDet);
+
+    /* b, a, d, c still carry their w lane, mask it out before the dot products */
+    const __m128 xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    const __m128 lastLane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+    const __m128 negate = _mm_set1_ps(-0.0f);
+
+    __m128 r0 = _mm_add_ps(cross3(b, v), _mm_mul_ps(t, y));
+    __m128 r1 = _mm_sub_ps(cross3(v, a), _mm_mul_ps(t, x));
+    __m128 r2 = _mm_add_ps(cross3(d, u), _mm_mul_ps(s, w));
+    __m128 r3 = _mm_sub_ps(cross3(u, c), _mm_mul_ps(s, z));
+
+    r0 = _mm_and_ps(r0, xyz);
+    r1 = _mm_and_ps(r1, xyz);
+    r2 = _mm_and_ps(r2, xyz);
+    r3 = _mm_and_ps(r3, xyz);
+
+    r0 = _mm_or_ps(r0, _mm_and_ps(_mm_xor_ps(dot4(_mm_and_ps(b, xyz), t), negate), lastLane));
+    r1 = _mm_or_ps(r1, _mm_and_ps(dot4(_mm_and_ps(a, xyz), t), lastLane));
+    r2 = _mm_or_ps(r2, _mm_and_ps(_mm_xor_ps(dot4(_mm_and_ps(d, xyz), s), negate), lastLane));
+    r3 = _mm_or_ps(r3, _mm_and_ps(dot4(_mm_and_ps(c, xyz), s), lastLane));
+
+    /* r0..r3 are rows, storage is column major */
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    Matrix4D R;
+    _mm_store_ps(R.n[0], r0);
+    _mm_store_ps(R.n[1], r1);
+    _mm_store_ps(R.n[2], r2);
+    _mm_store_ps(R.n[3], r3);
+    return R;
+}
+
+#endif
+
+}
+
+constexpr Matrix4D operator *(const Matrix4D& A, const Matrix4D& B)
+{
+#ifdef MATH_SIMD_SSE
+    if(!std::is_constant_evaluated())
+    {
+        return detail::multiplySimd(A, B);
+    }
+#endif
+    return detail::multiplyScalar(A, B);
+}
+
+constexpr Vector4D operator *(const Matrix4D& M, const Vector4D& v)
+{
+#ifdef MATH_SIMD_SSE
+    if(!std::is_constant_evaluated())
+    {
+        return detail::multiplySimd(M, v);
+    }
+#endif
+    return detail::multiplyScalar(M, v);
+}
+
+constexpr Matrix4D inverse(const Matrix4D& M)
+{
+#ifdef MATH_SIMD_SSE
+    if(!std::is_constant_evaluated())
+    {
+        return detail::inverseSimd(M);
+    }
+#endif
+    return detail::inverseScalar(M);
+}
 
 const std::string toString(const Matrix4D& M);
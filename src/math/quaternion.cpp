@@ -0,0 +1,88 @@
+#include "quaternion.h"
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <cassert>
+#include <sstream>
+
+Quaternion Quaternion::rotation(float r, const Vector3D& a)
+{
+    float s = std::sin(0.5f * r);
+    return Quaternion(a * s, std::cos(0.5f * r));
+}
+
+Quaternion Quaternion::fromMatrix(const Matrix3D& M)
+{
+    /* pick the largest of w, x, y, z to divide by, keeps the result accurate for any rotation angle */
+    float trace = M(0,0) + M(1,1) + M(2,2);
+    if(trace > 0.0f)
+    {
+        float s = 2.0f * std::sqrt(1.0f + trace);
+        return Quaternion((M(2,1) - M(1,2)) / s, (M(0,2) - M(2,0)) / s, (M(1,0) - M(0,1)) / s, 0.25f * s);
+    }
+    if(M(0,0) > M(1,1) && M(0,0) > M(2,2))
+    {
+        float s = 2.0f * std::sqrt(1.0f + M(0,0) - M(1,1) - M(2,2));
+        return Quaternion(0.25f * s, (M(0,1) + M(1,0)) / s, (M(0,2) + M(2,0)) / s, (M(2,1) - M(1,2)) / s);
+    }
+    if(M(1,1) > M(2,2))
+    {
+        float s = 2.0f * std::sqrt(1.0f + M(1,1) - M(0,0) - M(2,2));
+        return Quaternion((M(0,1) + M(1,0)) / s, 0.25f * s, (M(1,2) + M(2,1)) / s, (M(0,2) - M(2,0)) / s);
+    }
+    float s = 2.0f * std::sqrt(1.0f + M(2,2) - M(0,0) - M(1,1));
+    return Quaternion((M(0,2) + M(2,0)) / s, (M(1,2) + M(2,1)) / s, 0.25f * s, (M(1,0) - M(0,1)) / s);
+}
+
+float length(const Quaternion& q)
+{
+    return std::sqrt(dot(q, q));
+}
+
+Quaternion normalize(const Quaternion& q)
+{
+    assert(length(q) != 0.0f);
+    float s = 1.0f / length(q);
+    return Quaternion(q.x * s, q.y * s, q.z * s, q.w * s);
+}
+
+Quaternion nlerp(const Quaternion& a, const Quaternion& b, float t)
+{
+    /* q and -q are the same rotation, flip b onto a's hemisphere to take the shorter arc */
+    float sign = dot(a, b) < 0.0f ? -1.0f : 1.0f;
+    float s = 1.0f - t;
+    float u = sign * t;
+    return normalize(Quaternion(s * a.x + u * b.x, s * a.y + u * b.y, s * a.z + u * b.z, s * a.w + u * b.w));
+}
+
+Quaternion slerp(const Quaternion& a, const Quaternion& b, float t)
+{
+    float cosAngle = dot(a, b);
+    float sign = 1.0f;
+    if(cosAngle < 0.0f)
+    {
+        cosAngle = -cosAngle;
+        sign = -1.0f;
+    }
+
+    /* nearly parallel, sin(angle) would divide by ~0 and nlerp is exact enough */
+    if(cosAngle > 0.9995f)
+    {
+        return nlerp(a, b, t);
+    }
+
+    float angle = std::acos(cosAngle);
+    float invSin = 1.0f / std::sin(angle);
+    float s = std::sin((1.0f - t) * angle) * invSin;
+    float u = sign * std::sin(t * angle) * invSin;
+    return Quaternion(s * a.x + u * b.x, s * a.y + u * b.y, s * a.z + u * b.z, s * a.w + u * b.w);
+}
+
+std::ostream& operator<<(std::ostream& os, const Quaternion& q) {
+    os << toString(q);
+    return os;
+}
+
+const std::string toString(const Quaternion& q) {
+    return "x: " +  std::to_string(q.x) + ", y: " + std::to_string(q.y) + ", z: " + std::to_string(q.z) + ", w: " + std::to_string(q.w);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "matrix4d.h"
+
+/* unit quaternion x*i + y*j + z*k + w describing a rotation, composes like matrices: (a * b) applies b first */
+struct Quaternion
+{
+    float x, y, z, w;
+
+
+    constexpr Quaternion(float x = 0, float y = 0, float z = 0, float w = 1)
+        : x(x), y(y), z(z), w(w)
+    {
+
+    }
+
+    constexpr Quaternion(const Vector3D& v, float w)
+        : x(v.x), y(v.y), z(v.z), w(w)
+    {
+
+    }
+
+    static constexpr Quaternion identity()
+    {
+        return Quaternion(0, 0, 0, 1);
+    }
+
+    /**
+     * @brief Rotation by r rad around the (normalized) axis a.
+     */
+    static Quaternion rotation(float r, const Vector3D& a);
+
+    /**
+     * @brief Rotation part of an orthonormal matrix.
+     */
+    static Quaternion fromMatrix(const Matrix3D& M);
+
+    constexpr Vector3D vector() const
+    {
+        return Vector3D(x, y, z);
+    }
+
+    constexpr Quaternion operator -() const
+    {
+        return Quaternion(-x, -y, -z, -w);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Quaternion& q);
+};
+
+constexpr Quaternion operator *(const Quaternion& a, const Quaternion& b)
+{
+    return Quaternion(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                      a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                      a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+                      a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+}
+
+constexpr float dot(const Quaternion& a, const Quaternion& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+/* inverse rotation of a unit quaternion */
+constexpr Quaternion conjugate(const Quaternion& q)
+{
+    return Quaternion(-q.x, -q.y, -q.z, q.w);
+}
+
+/* q * v * q^-1 without building the matrix */
+constexpr Vector3D rotate(const Quaternion& q, const Vector3D& v)
+{
+    Vector3D u = q.vector();
+    Vector3D t = 2.0f * cross(u, v);
+    return v + q.w * t + cross(u, t);
+}
+
+constexpr Matrix3D toMatrix3D(const Quaternion& q)
+{
+    float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+    float xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+    float xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+    float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+
+    return Matrix3D(1.0f - yy - zz, xy - wz,        xz + wy,
+                    xy + wz,        1.0f - xx - zz, yz - wx,
+                    xz - wy,        yz + wx,        1.0f - xx - yy);
+}
+
+/* rigid transformation, rotation by q followed by the translation t, written column by column */
+constexpr Matrix4D toMatrix4D(const Quaternion& q, const Vector3D& t = {0, 0, 0})
+{
+    float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+    float xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+    float xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+    float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+
+    return Matrix4D(Vector4D(1.0f - yy - zz, xy + wz,        xz - wy,        0.0f),
+                    Vector4D(xy - wz,        1.0f - xx - zz, yz + wx,        0.0f),
+                    Vector4D(xz + wy,        yz - wx,        1.0f - xx - yy, 0.0f),
+                    Vector4D(t, 1.0f));
+}
+
+float length(const Quaternion& q);
+Quaternion normalize(const Quaternion& q);
+
+/**
+ * @brief Normalized linear interpolation along the shorter arc. Cheaper than slerp and close to it for small angles,
+ * but the angular speed is not constant.
+ */
+Quaternion nlerp(const Quaternion& a, const Quaternion& b, float t);
+
+/**
+ * @brief Spherical linear interpolation along the shorter arc with constant angular speed.
+ *
+ * @param a Rotation at t = 0.
+ * @param b Rotation at t = 1.
+ * @param t Interpolation parameter in [0, 1].
+ *
+ * @return Interpolated unit quaternion.
+ */
+Quaternion slerp(const Quaternion& a, const Quaternion& b, float t);
+
+const std::string toString(const Quaternion& q);
@@ -0,0 +1,49 @@
+#pragma once
+
+/* SSE is baseline on x86-64, AVX only when the compiler is allowed to emit it (ENABLE_AVX) */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_SIMD_SSE 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define MATH_SIMD_AVX 1
+#include <immintrin.h>
+#endif
+
+#ifdef MATH_SIMD_SSE
+
+/**
+ * @brief Sine of four floats. Reduces to [-pi/2, pi/2] and evaluates an odd polynomial, max. error ~1e-6 for |x| < 1e4.
+ *
+ * @param x Angles in rad.
+ *
+ * @return sin(x) per lane.
+ */
+inline __m128 simdSin(__m128 x)
+{
+    const __m128 invPi = _mm_set1_ps(0.318309886183790671f);
+    const __m128 pi0 = _mm_set1_ps(3.140625f);
+    const __m128 pi1 = _mm_set1_ps(9.67502593994140625e-4f);
+    const __m128 pi2 = _mm_set1_ps(1.509957990978376432e-7f);
+
+    /* x = k * pi + r, sin(x) = (-1)^k * sin(r) */
+    __m128i k = _mm_cvtps_epi32(_mm_mul_ps(x, invPi));
+    __m128 kf = _mm_cvtepi32_ps(k);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(kf, pi0));
+    r = _mm_sub_ps(r, _mm_mul_ps(kf, pi1));
+    r = _mm_sub_ps(r, _mm_mul_ps(kf, pi2));
+
+    __m128 r2 = _mm_mul_ps(r, r);
+    __m128 p = _mm_set1_ps(-2.50521083854417187751e-8f);
+    p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(2.75573192239858906526e-6f));
+    p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(-1.98412698412698412698e-4f));
+    p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(8.33333333333333333333e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(-1.66666666666666666667e-1f));
+    p = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, r2), r), r);
+
+    __m128 sign = _mm_castsi128_ps(_mm_slli_epi32(k, 31));
+    return _mm_xor_ps(p, sign);
+}
+
+#endif
@@ -0,0 +1,215 @@
+#include "transform.h"
+
+#include <algorithm>
+
+namespace detail
+{
+
+template<bool point>
+inline void transformScalar(const Matrix4D& M, float x, float y, float z, float& outX, float& outY, float& outZ)
+{
+    float rx = M.n[0][0] * x + M.n[1][0] * y + M.n[2][0] * z;
+    float ry = M.n[0][1] * x + M.n[1][1] * y + M.n[2][1] * z;
+    float rz = M.n[0][2] * x + M.n[1][2] * y + M.n[2][2] * z;
+    if constexpr(point)
+    {
+        rx += M.n[3][0];
+        ry += M.n[3][1];
+        rz += M.n[3][2];
+    }
+
+    outX = rx;
+    outY = ry;
+    outZ = rz;
+}
+
+#ifdef MATH_SIMD_SSE
+
+/* the matrix entries broadcast to all lanes, m[3 * column + row] */
+struct TransformSse
+{
+    __m128 m[12];
+
+    explicit TransformSse(const Matrix4D& M)
+    {
+        for(int c = 0; c < 4; c++)
+        {
+            for(int r = 0; r < 3; r++)
+            {
+                m[3 * c + r] = _mm_set1_ps(M.n[c][r]);
+            }
+        }
+    }
+
+    template<bool point>
+    void apply(__m128& x, __m128& y, __m128& z) const
+    {
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], x), _mm_mul_ps(m[3], y)), _mm_mul_ps(m[6], z));
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[1], x), _mm_mul_ps(m[4], y)), _mm_mul_ps(m[7], z));
+        __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[2], x), _mm_mul_ps(m[5], y)), _mm_mul_ps(m[8], z));
+        if constexpr(point)
+        {
+            rx = _mm_add_ps(rx, m[9]);
+            ry = _mm_add_ps(ry, m[10]);
+            rz = _mm_add_ps(rz, m[11]);
+        }
+
+        x = rx;
+        y = ry;
+        z = rz;
+    }
+};
+
+#endif
+
+#ifdef MATH_SIMD_AVX
+
+struct TransformAvx
+{
+    __m256 m[12];
+
+    explicit TransformAvx(const Matrix4D& M)
+    {
+        for(int c = 0; c < 4; c++)
+        {
+            for(int r = 0; r < 3; r++)
+            {
+                m[3 * c + r] = _mm256_set1_ps(M.n[c][r]);
+            }
+        }
+    }
+
+    template<bool point>
+    void apply(__m256& x, __m256& y, __m256& z) const
+    {
+        __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[0], x), _mm256_mul_ps(m[3], y)), _mm256_mul_ps(m[6], z));
+        __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[1], x), _mm256_mul_ps(m[4], y)), _mm256_mul_ps(m[7], z));
+        __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[2], x), _mm256_mul_ps(m[5], y)), _mm256_mul_ps(m[8], z));
+        if constexpr(point)
+        {
+            rx = _mm256_add_ps(rx, m[9]);
+            ry = _mm256_add_ps(ry, m[10]);
+            rz = _mm256_add_ps(rz, m[11]);
+        }
+
+        x = rx;
+        y = ry;
+        z = rz;
+    }
+};
+
+#endif
+
+template<bool point>
+void transformSoa(const Matrix4D& M, const float* x, const float* y, const float* z,
+                  float* outX, float* outY, float* outZ, size_t count)
+{
+    size_t i = 0;
+
+    /* broadcasting the matrix costs about as much as a few scalar points, only do it for at least one full batch */
+#ifdef MATH_SIMD_AVX
+    if(count >= 8)
+    {
+        TransformAvx avx(M);
+        for(; i + 8 <= count; i += 8)
+        {
+            __m256 vx = _mm256_loadu_ps(x + i);
+            __m256 vy = _mm256_loadu_ps(y + i);
+            __m256 vz = _mm256_loadu_ps(z + i);
+            avx.apply<point>(vx, vy, vz);
+            _mm256_storeu_ps(outX + i, vx);
+            _mm256_storeu_ps(outY + i, vy);
+            _mm256_storeu_ps(outZ + i, vz);
+        }
+    }
+#endif
+
+#ifdef MATH_SIMD_SSE
+    if(count - i >= 4)
+    {
+        TransformSse sse(M);
+        for(; i + 4 <= count; i += 4)
+        {
+            __m128 vx = _mm_loadu_ps(x + i);
+            __m128 vy = _mm_loadu_ps(y + i);
+            __m128 vz = _mm_loadu_ps(z + i);
+            sse.apply<point>(vx, vy, vz);
+            _mm_storeu_ps(outX + i, vx);
+            _mm_storeu_ps(outY + i, vy);
+            _mm_storeu_ps(outZ + i, vz);
+        }
+    }
+#endif
+
+    for(; i < count; i++)
+    {
+        transformScalar<point>(M, x[i], y[i], z[i], outX[i], outY[i], outZ[i]);
+    }
+}
+
+template<bool point>
+void transformAos(const Matrix4D& M, const Vector3D* in, Vector3D* out, size_t count)
+{
+    size_t i = 0;
+
+#ifdef MATH_SIMD_SSE
+    /* four packed points are three registers: (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3), shuffled to x, y, z lanes and back */
+    if(count >= 4)
+    {
+        TransformSse sse(M);
+        for(; i + 4 <= count; i += 4)
+        {
+            const float* src = &in[i].x;
+            __m128 a = _mm_loadu_ps(src);
+            __m128 b = _mm_loadu_ps(src + 4);
+            __m128 c = _mm_loadu_ps(src + 8);
+
+            __m128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+            __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 2, 0, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 1, 0, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+            sse.apply<point>(x, y, z);
+
+            a = _mm_shuffle_ps(_mm_unpacklo_ps(x, y), _mm_shuffle_ps(z, x, _MM_SHUFFLE(0, 1, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+            b = _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(0, 1, 0, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+            c = _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(0, 3, 0, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(0, 3, 0, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+
+            float* dst = &out[i].x;
+            _mm_storeu_ps(dst, a);
+            _mm_storeu_ps(dst + 4, b);
+            _mm_storeu_ps(dst + 8, c);
+        }
+    }
+#endif
+
+    for(; i < count; i++)
+    {
+        transformScalar<point>(M, in[i].x, in[i].y, in[i].z, out[i].x, out[i].y, out[i].z);
+    }
+}
+
+}
+
+static_assert(sizeof(Vector3D) == 3 * sizeof(float), "Vector3D has to be tightly packed for the batch transforms");
+
+void transformPoints(const Matrix4D& M, const Vector3D* in, Vector3D* out, size_t count)
+{
+    detail::transformAos<true>(M, in, out, count);
+}
+
+void transformDirections(const Matrix4D& M, const Vector3D* in, Vector3D* out, size_t count)
+{
+    detail::transformAos<false>(M, in, out, count);
+}
+
+void transformPoints(const Matrix4D& M, const float* x, const float* y, const float* z,
+                     float* outX, float* outY, float* outZ, size_t count)
+{
+    detail::transformSoa<true>(M, x, y, z, outX, outY, outZ, count);
+}
+
+void transformDirections(const Matrix4D& M, const float* x, const float* y, const float* z,
+                         float* outX, float* outY, float* outZ, size_t count)
+{
+    detail::transformSoa<false>(M, x, y, z, outX, outY, outZ, count);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "matrix4d.h"
+
+#include <cstddef>
+
+/* Batch transforms of many points or directions by one matrix. The matrix is treated as affine: the bottom row is
+ * ignored and w is 1 for points and 0 for directions. Input and output may be the same array. */
+
+/**
+ * @brief Transform an array of points (AoS), out[i] = M * (in[i], 1).
+ *
+ * @param M Affine transformation.
+ * @param in Points to transform.
+ * @param out Receives the transformed points, may alias in.
+ * @param count Number of points.
+ */
+void transformPoints(const Matrix4D& M, const Vector3D* in, Vector3D* out, size_t count);
+
+/**
+ * @brief Transform an array of directions (AoS), out[i] = M * (in[i], 0). The result is not normalized.
+ */
+void transformDirections(const Matrix4D& M, const Vector3D* in, Vector3D* out, size_t count);
+
+/**
+ * @brief Transform points given as separate coordinate arrays (SoA).
+ *
+ * @param M Affine transformation.
+ * @param x, y, z Coordinates of the points.
+ * @param outX, outY, outZ Receive the transformed coordinates, may alias the inputs.
+ * @param count Number of points.
+ */
+void transformPoints(const Matrix4D& M, const float* x, const float* y, const float* z,
+                     float* outX, float* outY, float* outZ, size_t count);
+
+/**
+ * @brief Transform directions given as separate coordinate arrays (SoA). The result is not normalized.
+ */
+void transformDirections(const Matrix4D& M, const float* x, const float* y, const float* z,
+                         float* outX, float* outY, float* outZ, size_t count);
@@ -1,41 +1,111 @@
 #pragma once
 
+#include <cassert>
 #include <string>
 
 struct Vector2D
 {
     float x, y;
 
-    Vector2D(float x = 0, float y = 0);
+    constexpr Vector2D(float x = 0, float y = 0)
+        : x(x), y(y)
+    {
 
-    Vector2D& operator *=(float s);
-    Vector2D& operator /=(float s);
+    }
 
-    Vector2D& operator +=(const Vector2D& v);
-    Vector2D& operator -=(const Vector2D& v);
+    constexpr Vector2D& operator *=(float s)
+    {
+        x *= s;
+        y *= s;
+        return *this;
+    }
 
-     Vector2D operator -() const;
+    constexpr Vector2D& operator /=(float s)
+    {
+        assert(s != 0.0f);
+        return *this *= (1.0 / s);
+    }
 
-    float& operator [](unsigned int i);
-    const float& operator [](unsigned int i) const;
+    constexpr Vector2D& operator +=(const Vector2D& v)
+    {
+        x += v.x;
+        y += v.y;
+        return *this;
+    }
+
+    constexpr Vector2D& operator -=(const Vector2D& v)
+    {
+        x -= v.x;
+        y -= v.y;
+        return *this;
+    }
+
+    constexpr Vector2D operator -() const
+    {
+        return Vector2D(-x, -y);
+    }
+
+    constexpr float& operator [](unsigned int i)
+    {
+        assert(i < 2);
+        return i == 0 ? x : y;
+    }
+
+    constexpr const float& operator [](unsigned int i) const
+    {
+        assert(i < 2);
+        return i == 0 ? x : y;
+    }
 
     friend std::ostream& operator<<(std::ostream& os, const Vector2D& v);
 };
 
-Vector2D operator *(const Vector2D& v, float s);
-Vector2D operator /(const Vector2D& v, float s);
-Vector2D operator *(float s, const Vector2D& v);
-Vector2D operator /(float s, const Vector2D& v);
+constexpr Vector2D operator *(const Vector2D& v, float s)
+{
+    return Vector2D(v.x * s, v.y * s);
+}
+
+constexpr Vector2D operator /(const Vector2D& v, float s)
+{
+    return Vector2D(v.x / s, v.y / s);
+}
+
+constexpr Vector2D operator *(float s, const Vector2D& v)
+{
+    return Vector2D(v.x * s, v.y * s);
+}
+
+constexpr Vector2D operator /(float s, const Vector2D& v)
+{
+    return Vector2D(v.x / s, v.y / s);
+}
 
-Vector2D operator +(const Vector2D& a, const Vector2D& b);
-Vector2D operator -(const Vector2D& a, const Vector2D& b);
+constexpr Vector2D operator +(const Vector2D& a, const Vector2D& b)
+{
+    return Vector2D(a.x + b.x, a.y + b.y);
+}
+
+constexpr Vector2D operator -(const Vector2D& a, const Vector2D& b)
+{
+    return Vector2D(a.x - b.x, a.y - b.y);
+}
 
 float length(const Vector2D& v);
 Vector2D normalize(const Vector2D& v);
 
-float dot(const Vector2D& a, const Vector2D& b);
+constexpr float dot(const Vector2D& a, const Vector2D& b)
+{
+    return a.x * b.x + a.y * b.y;
+}
+
+constexpr Vector2D project(const Vector2D& a, const Vector2D& b)
+{
+    return (b * (dot(a, b) / dot(b, b)));
+}
 
-Vector2D project(const Vector2D& a, const Vector2D& b);
-Vector2D reject(const Vector2D& a, const Vector2D& b);
+constexpr Vector2D reject(const Vector2D& a, const Vector2D& b)
+{
+    return (a - b * (dot(a, b) / dot(b, b)));
+}
 
 const std::string toString(const Vector2D& v);
@@ -1,35 +1,139 @@
 #pragma once
 
+#include "simd.h"
 #include "vector3d.h"
 
-struct Vector4D
+#include <type_traits>
+
+struct alignas(16) Vector4D
 {
     float x, y, z, w;
 
 
-    Vector4D(const Vector3D& v, float w = 1.0f);
-    Vector4D(float x = 0, float y = 0, float z = 0, float w = 0);
+    constexpr Vector4D(const Vector3D& v, float w = 1.0f)
+        : x(v.x), y(v.y), z(v.z), w(w)
+    {
+
+    }
+
+    constexpr Vector4D(float x = 0, float y = 0, float z = 0, float w = 0)
+        : x(x), y(y), z(z), w(w)
+    {
+
+    }
+
+    constexpr Vector4D& operator *=(float s)
+    {
+#ifdef MATH_SIMD_SSE
+        if(!std::is_constant_evaluated())
+        {
+            _mm_store_ps(&x, _mm_mul_ps(_mm_load_ps(&x), _mm_set1_ps(s)));
+            return *this;
+        }
+#endif
+        x *= s;
+        y *= s;
+        z *= s;
+        w *= s;
+        return *this;
+    }
 
-    Vector4D& operator *=(float s);
-    Vector4D& operator /=(float s);
+    constexpr Vector4D& operator /=(float s)
+    {
+        assert(s != 0.0f);
+        return *this *= (1.0 / s);
+    }
 
-    Vector4D& operator +=(const Vector4D& v);
-    Vector4D& operator -=(const Vector4D& v);
+    constexpr Vector4D& operator +=(const Vector4D& v)
+    {
+#ifdef MATH_SIMD_SSE
+        if(!std::is_constant_evaluated())
+        {
+            _mm_store_ps(&x, _mm_add_ps(_mm_load_ps(&x), _mm_load_ps(&v.x)));
+            return *this;
+        }
+#endif
+        x += v.x;
+        y += v.y;
+        z += v.z;
+        w += v.w;
+        return *this;
+    }
 
-    Vector4D operator -() const;
+    constexpr Vector4D& operator -=(const Vector4D& v)
+    {
+#ifdef MATH_SIMD_SSE
+        if(!std::is_constant_evaluated())
+        {
+            _mm_store_ps(&x, _mm_sub_ps(_mm_load_ps(&x), _mm_load_ps(&v.x)));
+            return *this;
+        }
+#endif
+        x -= v.x;
+        y -= v.y;
+        z -= v.z;
+        w -= v.w;
+        return *this;
+    }
 
-    float& operator [](unsigned int i);
-    const float& operator [](unsigned int i) const;
+    constexpr Vector4D operator -() const
+    {
+        return Vector4D(-x, -y, -z, -w);
+    }
+
+    constexpr float& operator [](unsigned int i)
+    {
+        assert(i < 4);
+        return i == 0 ? x : (i == 1 ? y : (i == 2 ? z : w));
+    }
+
+    constexpr const float& operator [](unsigned int i) const
+    {
+        assert(i < 4);
+        return i == 0 ? x : (i == 1 ? y : (i == 2 ? z : w));
+    }
 
     friend std::ostream& operator<<(std::ostream& os, const Vector4D& v);
 };
 
-Vector4D operator *(const Vector4D& v, float s);
-Vector4D operator /(const Vector4D& v, float s);
-Vector4D operator *(float s, const Vector4D& v);
-Vector4D operator /(float s, const Vector4D& v);
+constexpr Vector3D::Vector3D(const Vector4D& v)
+    : x(v.x), y(v.y), z(v.z)
+{
+
+}
+
+constexpr Vector4D operator *(const Vector4D& v, float s)
+{
+    Vector4D r = v;
+    return r *= s;
+}
+
+constexpr Vector4D operator /(const Vector4D& v, float s)
+{
+    return Vector4D(v.x / s, v.y / s, v.z / s, v.w / s);
+}
+
+constexpr Vector4D operator *(float s, const Vector4D& v)
+{
+    Vector4D r = v;
+    return r *= s;
+}
 
-Vector4D operator +(const Vector4D& a, const Vector4D& b);
-Vector4D operator -(const Vector4D& a, const Vector4D& b);
+constexpr Vector4D operator /(float s, const Vector4D& v)
+{
+    return Vector4D(v.x / s, v.y / s, v.z / s, v.w / s);
+}
+
+constexpr Vector4D operator +(const Vector4D& a, const Vector4D& b)
+{
+    Vector4D r = a;
+    return r += b;
+}
+
+constexpr Vector4D operator -(const Vector4D& a, const Vector4D& b)
+{
+    Vector4D r = a;
+    return r -= b;
+}
 
 const std::string toString(const Vector4D& v);
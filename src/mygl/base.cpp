@@ -54,7 +54,7 @@ void glfw_error_callback(int error, const char* description)
     std::cerr << "GLFW Error: " <<  description << std::endl;
 }
 
-GLFWwindow* windowCreate(const std::string& title, unsigned int width = 1280, unsigned int height = 720)
+GLFWwindow* windowCreate(const std::string& title, unsigned int width = 1280, unsigned int height = 720, bool headless = false)
 {
     /*-------------- init glfw ----------------*/
     if(!glfwInit())
@@ -72,6 +72,7 @@ GLFWwindow* windowCreate(const std::string& title, unsigned int width = 1280, un
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, headless ? GLFW_FALSE : GLFW_TRUE);
 
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
@@ -88,7 +89,8 @@ GLFWwindow* windowCreate(const std::string& title, unsigned int width = 1280, un
 
     /* make context the current one */
     glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);
+    /* headless runs measure frame times, vsync would clamp them to the refresh rate */
+    glfwSwapInterval(headless ? 0 : 1);
 
     /*-------------- init glad ----------------*/
     /* load opengl extensions */
@@ -16,6 +16,8 @@
 #include "math/vector4d.h"
 #include "math/matrix3d.h"
 #include "math/matrix4d.h"
+#include "math/quaternion.h"
+#include "math/transform.h"
 
 
 /**
@@ -24,10 +26,12 @@
  * @param title Window title
  * @param width Window width
  * @param height Window height
+ * @param headless Create a hidden window without vsync, for offscreen runs. With GLFW built with OSMesa the context
+ * renders into system memory and needs no display.
  *
  * @return Initialized GLFW window.
  */
-GLFWwindow* windowCreate(const std::string &title, unsigned int width, unsigned int height);
+GLFWwindow* windowCreate(const std::string &title, unsigned int width, unsigned int height, bool headless);
 /**
  * @brief Delete GLFW window and OpenGL contexst. Has to be called for each window after it is not used anymore.
  *
@@ -1,24 +1,11 @@
 #include "camera.h"
 
+#include <math/simd.h>
+
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <algorithm>
-
-namespace detail
-{
-
-Vector3D sphericalCoords(const Camera& cam)
-{
-    Vector3D cartVec = cam.position - cam.lookAt;
-
-    auto r = length(cartVec);
-    auto phi = atan2(cartVec.x, cartVec.z);
-    auto theta = atan2(sqrt(cartVec.x * cartVec.x + cartVec.z * cartVec.z), cartVec.y);
-
-    return Vector3D(r, phi, theta);
-}
-
-}
+#include <cmath>
 
 Camera cameraCreate(float width, float height, float fov, float nearPlane, float farPlane, const Vector3D &initPos, const Vector3D &lookAt, const Vector3D &initUp)
 {
@@ -48,25 +35,201 @@ Matrix4D cameraView(const Camera &cam)
 
 void cameraUpdateOrbit(Camera& cam, const Vector2D& mouseDiff, float zoom)
 {
-    Vector3D spherCoord = detail::sphericalCoords(cam);
-    float r = spherCoord[0];
-    float phi = spherCoord[1];
-    float theta = spherCoord[2];
+    const Vector3D up(0.0f, 1.0f, 0.0f);
+    Vector3D offset = cam.position - cam.lookAt;
+
+    /* yaw around the world up axis, pitch around the horizontal axis perpendicular to the offset */
+    Quaternion yaw = Quaternion::rotation(mouseDiff.x * (M_PI / cam.width), up);
+    Vector3D side(offset.z, 0.0f, -offset.x);
+    if(dot(side, side) > 0.0f)
+    {
+        Vector3D pitched = rotate(Quaternion::rotation(mouseDiff.y * (M_PI / cam.height), normalize(side)), offset);
+
+        /* clamp the polar angle to [1e-4, pi - 1e-4], passing over a pole flips the horizontal direction */
+        const float minAngle = 1e-4f;
+        const float maxCos = std::cos(minAngle);
+        if(pitched.y * pitched.y > maxCos * maxCos * dot(pitched, pitched) || pitched.x * offset.x + pitched.z * offset.z <= 0.0f)
+        {
+            float r = length(offset);
+            Vector3D horizontal = normalize(Vector3D(offset.x, 0.0f, offset.z));
+            pitched = horizontal * (r * std::sin(minAngle)) + up * (pitched.y > 0.0f ? r * maxCos : -r * maxCos);
+        }
+        offset = pitched;
+    }
+    offset = rotate(yaw, offset);
+
+    /* zoom, without collapsing onto the look at point */
+    float scale = std::max(1.0f + zoom, 0.0f);
+    if(dot(offset, offset) * scale * scale < 1e-8f)
+    {
+        scale = 1e-4f / length(offset);
+    }
+
+    cam.position = cam.lookAt + offset * scale;
+}
 
-    phi += mouseDiff.x * (M_PI / cam.width);
-    theta += mouseDiff.y * (M_PI / cam.height);
-    r += zoom * r;
+void cameraFollow(Camera& cam, const Vector3D& pos)
+{
+    cam.position += pos - cam.lookAt;
+    cam.lookAt = pos;
+}
 
-    theta = std::clamp<float>(theta, 1e-4, M_PI - 1e-4);
-    r = std::max(r, 1e-4f);
+float cameraScreenRadius(const Camera& cam, const Vector3D& center, float radius)
+{
+    float distance = length(center - cam.position);
+    if(distance <= radius)
+    {
+        return cam.height;
+    }
+    return 0.5f * cam.height * radius / (distance * std::tan(0.5f * cam.fov));
+}
 
-    Vector3D cartCoord(r * sin(theta) * sin(phi), r * cos(theta), r * sin(theta) * cos(phi));
+Frustum cameraFrustum(const Matrix4D& viewProjection)
+{
+    const Matrix4D& M = viewProjection;
+    Vector4D row[4];
+    for(int i = 0; i < 4; i++)
+    {
+        row[i] = Vector4D(M(i,0), M(i,1), M(i,2), M(i,3));
+    }
+
+    Frustum frustum;
+    frustum.planes[0] = row[3] + row[0];
+    frustum.planes[1] = row[3] - row[0];
+    frustum.planes[2] = row[3] + row[1];
+    frustum.planes[3] = row[3] - row[1];
+    frustum.planes[4] = row[3] + row[2];
+    frustum.planes[5] = row[3] - row[2];
+
+    for(auto& plane : frustum.planes)
+    {
+        plane *= 1.0f / length(Vector3D(plane));
+    }
+
+    return frustum;
+}
 
-    cam.position = cam.lookAt + cartCoord;
+Frustum cameraFrustum(const Camera& cam)
+{
+    return cameraFrustum(cameraProjection(cam) * cameraView(cam));
 }
 
-void cameraFollow(Camera& cam, const Vector3D& pos)
+bool frustumContains(const Frustum& frustum, const Bounds& bounds)
 {
-    cam.position += pos - cam.lookAt;
-    cam.lookAt = pos;
+    for(const auto& plane : frustum.planes)
+    {
+        /* distance of the center and projected half extent of the box onto the plane normal */
+        float d = plane.x * bounds.center.x + plane.y * bounds.center.y + plane.z * bounds.center.z + plane.w;
+        float r = std::abs(plane.x) * bounds.extent.x + std::abs(plane.y) * bounds.extent.y + std::abs(plane.z) * bounds.extent.z;
+        if(d < -r)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+namespace detail
+{
+
+/* append the indices of the set bits of a 4 bit mask */
+inline size_t frustumAppendVisible(int mask, uint32_t base, uint32_t* visible, size_t n)
+{
+    for(uint32_t j = 0; j < 4; j++)
+    {
+        if(mask & (1 << j))
+        {
+            visible[n++] = base + j;
+        }
+    }
+    return n;
+}
+
+}
+
+size_t frustumCullSpheres(const Frustum& frustum, const Vector4D* spheres, size_t count, uint32_t* visible)
+{
+    size_t n = 0;
+    size_t i = 0;
+
+#ifdef MATH_SIMD_SSE
+    for(; i + 4 <= count; i += 4)
+    {
+        /* four spheres to x, y, z, radius lanes */
+        __m128 x = _mm_load_ps(&spheres[i].x);
+        __m128 y = _mm_load_ps(&spheres[i + 1].x);
+        __m128 z = _mm_load_ps(&spheres[i + 2].x);
+        __m128 r = _mm_load_ps(&spheres[i + 3].x);
+        _MM_TRANSPOSE4_PS(x, y, z, r);
+        __m128 negR = _mm_sub_ps(_mm_setzero_ps(), r);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for(const auto& plane : frustum.planes)
+        {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)),
+                                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), z), _mm_set1_ps(plane.w)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+        }
+
+        n = detail::frustumAppendVisible(_mm_movemask_ps(inside), (uint32_t) i, visible, n);
+    }
+#endif
+
+    for(; i < count; i++)
+    {
+        bool inside = true;
+        for(const auto& plane : frustum.planes)
+        {
+            inside &= plane.x * spheres[i].x + plane.y * spheres[i].y + plane.z * spheres[i].z + plane.w >= -spheres[i].w;
+        }
+
+        if(inside)
+        {
+            visible[n++] = (uint32_t) i;
+        }
+    }
+
+    return n;
+}
+
+size_t frustumCullBoxes(const Frustum& frustum, const Bounds* bounds, size_t count, uint32_t* visible)
+{
+    size_t n = 0;
+    size_t i = 0;
+
+#ifdef MATH_SIMD_SSE
+    for(; i + 4 <= count; i += 4)
+    {
+        const Bounds* b = bounds + i;
+        __m128 cx = _mm_setr_ps(b[0].center.x, b[1].center.x, b[2].center.x, b[3].center.x);
+        __m128 cy = _mm_setr_ps(b[0].center.y, b[1].center.y, b[2].center.y, b[3].center.y);
+        __m128 cz = _mm_setr_ps(b[0].center.z, b[1].center.z, b[2].center.z, b[3].center.z);
+        __m128 ex = _mm_setr_ps(b[0].extent.x, b[1].extent.x, b[2].extent.x, b[3].extent.x);
+        __m128 ey = _mm_setr_ps(b[0].extent.y, b[1].extent.y, b[2].extent.y, b[3].extent.y);
+        __m128 ez = _mm_setr_ps(b[0].extent.z, b[1].extent.z, b[2].extent.z, b[3].extent.z);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for(const auto& plane : frustum.planes)
+        {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), cx), _mm_mul_ps(_mm_set1_ps(plane.y), cy)),
+                                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), cz), _mm_set1_ps(plane.w)));
+            __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::abs(plane.x)), ex), _mm_mul_ps(_mm_set1_ps(std::abs(plane.y)), ey)),
+                                  _mm_mul_ps(_mm_set1_ps(std::abs(plane.z)), ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+        }
+
+        n = detail::frustumAppendVisible(_mm_movemask_ps(inside), (uint32_t) i, visible, n);
+    }
+#endif
+
+    for(; i < count; i++)
+    {
+        if(frustumContains(frustum, bounds[i]))
+        {
+            visible[n++] = (uint32_t) i;
+        }
+    }
+
+    return n;
 }
@@ -3,6 +3,11 @@
 #include <math/vector2d.h>
 #include <math/vector3d.h>
 #include <math/matrix4d.h>
+#include <math/quaternion.h>
+#include <math/bounds.h>
+
+#include <cstddef>
+#include <cstdint>
 
 struct Camera
 {
@@ -16,6 +21,12 @@ struct Camera
     Vector3D initUp;
 };
 
+/* six normalized planes (n, d) with n * p + d >= 0 for points inside: left, right, bottom, top, near, far */
+struct Frustum
+{
+    Vector4D planes[6];
+};
+
 /**
  * @brief Function to initialize a camera.
  *
@@ -51,11 +62,11 @@ Matrix4D cameraProjection(const Camera& cam);
 Matrix4D cameraView(const Camera& cam);
 
 /**
- * @brief Update camera position on the orbit around the look at point using spherical coordinates.
+ * @brief Update camera position on the orbit around the look at point by rotating its offset with quaternions.
  *
  * @param cam Camera that gets updated.
- * @param mouseDiff X and Y distances that are used to change the spherical coordinate angles of the camera position.
- * with respect to the look at point.
+ * @param mouseDiff X and Y distances that are used to change the yaw and pitch of the camera position with respect to
+ * the look at point.
  * @param zoom Factor to zoom in (-) or out (+) (distance of camera position to look at point is de-/increased).
  */
 void cameraUpdateOrbit(Camera &cam, const Vector2D &mouseDiff, float zoom);
@@ -68,3 +79,53 @@ void cameraUpdateOrbit(Camera &cam, const Vector2D &mouseDiff, float zoom);
  * @param pos New lookAt position.
  */
 void cameraFollow(Camera& cam, const Vector3D& pos);
+
+/**
+ * @brief Approximate radius of a sphere on screen, for level of detail selection.
+ *
+ * @param cam Camera, fov is the vertical field of view.
+ * @param center Sphere center in world space.
+ * @param radius Sphere radius.
+ *
+ * @return Radius in pixels, the image height when the camera is inside the sphere.
+ */
+float cameraScreenRadius(const Camera& cam, const Vector3D& center, float radius);
+
+/**
+ * @brief Extract the frustum planes from a view projection matrix (Gribb/Hartmann).
+ *
+ * @param viewProjection Projection * view, planes are then in world space. With projection only they are in view space.
+ *
+ * @return Frustum with normalized planes.
+ */
+Frustum cameraFrustum(const Matrix4D& viewProjection);
+
+/**
+ * @brief World space frustum of a camera.
+ */
+Frustum cameraFrustum(const Camera& cam);
+
+/**
+ * @brief Test a single box against the frustum. Conservative: boxes close to a frustum corner may pass although they
+ * are outside.
+ *
+ * @return Whether the box is (potentially) visible.
+ */
+bool frustumContains(const Frustum& frustum, const Bounds& bounds);
+
+/**
+ * @brief Cull many spheres at once, four per SSE iteration.
+ *
+ * @param frustum Frustum to test against.
+ * @param spheres Sphere centers in xyz, radius in w.
+ * @param count Number of spheres.
+ * @param visible Receives the indices of the visible spheres, has to hold count entries.
+ *
+ * @return Number of visible spheres.
+ */
+size_t frustumCullSpheres(const Frustum& frustum, const Vector4D* spheres, size_t count, uint32_t* visible);
+
+/**
+ * @brief Cull many boxes at once, four per SSE iteration. Same output as frustumCullSpheres.
+ */
+size_t frustumCullBoxes(const Frustum& frustum, const Bounds* bounds, size_t count, uint32_t* visible);
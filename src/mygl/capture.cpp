@@ -0,0 +1,368 @@
+#include "capture.h"
+#include "profiler.h"
+
+#include <stb_image/stb_image_write.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace detail
+{
+
+void captureEncode(Capture* capture)
+{
+    profilerSetThreadName("capture encoder");
+
+    std::unique_lock<std::mutex> lock(capture->mutex);
+    while(true)
+    {
+        capture->wake.wait(lock, [&] { return capture->stop || !capture->queue.empty(); });
+        if(capture->queue.empty())
+        {
+            return;
+        }
+        CaptureFrame frame = std::move(capture->queue.front());
+        capture->queue.pop_front();
+        lock.unlock();
+
+        bool ok;
+        {
+            PROFILE_ZONE("captureEncode");
+            ok = stbi_write_png(frame.path.c_str(), frame.width, frame.height, 4, frame.pixels.data(), frame.width * 4);
+        }
+        if(!ok)
+        {
+            std::cerr << "Couldn't write " << frame.path << std::endl;
+        }
+
+        lock.lock();
+        (ok ? capture->stats.encoded : capture->stats.failed)++;
+        capture->freePixels.push_back(std::move(frame.pixels));
+    }
+}
+
+/* copy a finished readback out of its pixel buffer and queue it for the PNG encoders and the video. Unless forced, a
+ * frame is dropped from a full queue before anything is copied. */
+void captureRetire(Capture& capture, Capture::Slot& slot, bool force)
+{
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    CaptureFrame frame = {.width = slot.width, .height = slot.height, .path = std::move(slot.screenshotPath)};
+    slot.screenshotPath.clear();
+    bool png = slot.png || !frame.path.empty();
+    {
+        std::lock_guard<std::mutex> lock(capture.mutex);
+        if(png && !force && frame.path.empty() && capture.queue.size() >= capture.queueMax)
+        {
+            capture.stats.dropped++;
+            png = false;
+        }
+        if(png && !capture.freePixels.empty())
+        {
+            frame.pixels = std::move(capture.freePixels.back());
+            capture.freePixels.pop_back();
+        }
+    }
+
+    /* the size is checked when the readback starts */
+    std::vector<uint8_t> videoFrame;
+    bool video = slot.video && capture.recording && videoWriterAcquire(capture.video, videoFrame, force);
+    if(!png && !video)
+    {
+        return;
+    }
+
+    size_t size = size_t(slot.width) * slot.height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if(data && png)
+    {
+        frame.pixels.resize(size);
+        memcpy(frame.pixels.data(), data, size);
+    }
+    if(data && video)
+    {
+        memcpy(videoFrame.data(), data, size);
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if(data && video)
+    {
+        videoWriterPush(capture.video, std::move(videoFrame));
+    }
+
+    std::lock_guard<std::mutex> lock(capture.mutex);
+    if(!data)
+    {
+        capture.stats.failed++;
+        return;
+    }
+    if(!png)
+    {
+        return;
+    }
+    if(frame.path.empty())
+    {
+        char path[4096];
+        snprintf(path, sizeof(path), capture.pattern.c_str(), capture.sequence++);
+        frame.path = path;
+    }
+    capture.queue.push_back(std::move(frame));
+    capture.stats.captured++;
+    capture.wake.notify_one();
+}
+
+bool captureSignaled(GLsync fence, GLbitfield flags, GLuint64 timeout)
+{
+    GLenum result = glClientWaitSync(fence, flags, timeout);
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+/* retire all pending readbacks, waiting for the GPU */
+void captureFinish(Capture& capture)
+{
+    for(unsigned int i = 0; i < CAPTURE_BUFFERS; i++)
+    {
+        Capture::Slot& slot = capture.slots[(capture.next + i) % CAPTURE_BUFFERS];
+        if(slot.fence)
+        {
+            captureSignaled(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            captureRetire(capture, slot, true);
+        }
+    }
+}
+
+void captureDropped(Capture& capture)
+{
+    std::lock_guard<std::mutex> lock(capture.mutex);
+    capture.stats.dropped++;
+}
+
+}
+
+void captureCreate(Capture& capture, unsigned int encoderCount)
+{
+    for(auto& slot : capture.slots)
+    {
+        glGenBuffers(1, &slot.pbo);
+    }
+
+    GLboolean doubleBuffer = GL_TRUE;
+    glGetBooleanv(GL_DOUBLEBUFFER, &doubleBuffer);
+    capture.readBuffer = doubleBuffer ? GL_BACK : GL_FRONT;
+
+    /* glReadPixels rows are bottom up, like in screenshotToPNG */
+    stbi_flip_vertically_on_write(true);
+
+    if(encoderCount == 0)
+    {
+        encoderCount = std::max(1u, std::thread::hardware_concurrency() / 2);
+    }
+    capture.queueMax = 2 * encoderCount;
+    capture.stop = false;
+    for(unsigned int i = 0; i < encoderCount; i++)
+    {
+        capture.encoders.emplace_back(detail::captureEncode, &capture);
+    }
+}
+
+void captureDelete(Capture& capture)
+{
+    captureRecordStop(capture);
+    detail::captureFinish(capture);
+
+    {
+        std::lock_guard<std::mutex> lock(capture.mutex);
+        capture.stop = true;
+    }
+    capture.wake.notify_all();
+    for(auto& encoder : capture.encoders)
+    {
+        encoder.join();
+    }
+    capture.encoders.clear();
+
+    for(auto& slot : capture.slots)
+    {
+        glDeleteBuffers(1, &slot.pbo);
+        slot.pbo = 0;
+        slot.size = 0;
+    }
+    capture.freePixels.clear();
+}
+
+void captureScreenshot(Capture& capture, const std::string& filepath)
+{
+    capture.screenshotPath = filepath;
+}
+
+void captureContinuous(Capture& capture, unsigned int every, const std::string& pattern)
+{
+    std::filesystem::path directory = std::filesystem::path(pattern).parent_path();
+    if(every > 0 && !directory.empty())
+    {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+    }
+
+    capture.every = every;
+    capture.pattern = pattern;
+    capture.frame = 0;
+}
+
+bool capturePatternValid(const std::string& pattern)
+{
+    unsigned int conversions = 0;
+    for(size_t i = 0; i < pattern.size(); i++)
+    {
+        if(pattern[i] != '%')
+        {
+            continue;
+        }
+        if(i + 1 < pattern.size() && pattern[i + 1] == '%')
+        {
+            i++;
+            continue;
+        }
+
+        /* zero flag and width are digits only, anything else before the 'u' is rejected */
+        size_t end = i + 1;
+        while(end < pattern.size() && pattern[end] >= '0' && pattern[end] <= '9')
+        {
+            end++;
+        }
+        if(end == pattern.size() || pattern[end] != 'u')
+        {
+            return false;
+        }
+        conversions++;
+        i = end;
+    }
+    return conversions == 1;
+}
+
+bool captureRecordStart(Capture& capture, const std::string& filepath, unsigned int fps)
+{
+    if(capture.recording)
+    {
+        return false;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    /* a frame every 16.7 ms at 60 Hz, the queue absorbs writer hiccups of about 0.1 s */
+    if(!videoWriterCreate(capture.video, filepath, viewport[2], viewport[3], fps, 8))
+    {
+        return false;
+    }
+    capture.recording = true;
+    return true;
+}
+
+void captureRecordStop(Capture& capture)
+{
+    if(!capture.recording)
+    {
+        return;
+    }
+
+    detail::captureFinish(capture);
+    capture.recording = false;
+    videoWriterDelete(capture.video);
+
+    std::lock_guard<std::mutex> lock(capture.mutex);
+    capture.stats.video = capture.video.stats;
+}
+
+void captureFrame(Capture& capture)
+{
+    PROFILE_ZONE("captureFrame");
+    auto start = std::chrono::steady_clock::now();
+
+    /* queue the readbacks the GPU finished, oldest first */
+    for(unsigned int i = 0; i < CAPTURE_BUFFERS; i++)
+    {
+        Capture::Slot& slot = capture.slots[(capture.next + i) % CAPTURE_BUFFERS];
+        if(!slot.fence)
+        {
+            continue;
+        }
+        if(!detail::captureSignaled(slot.fence, 0, 0))
+        {
+            break;
+        }
+        detail::captureRetire(capture, slot, false);
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    bool screenshot = !capture.screenshotPath.empty();
+    bool png = capture.every > 0 && capture.frame % capture.every == 0;
+    bool video = capture.recording;
+    if(video && (viewport[2] != capture.video.width || viewport[3] != capture.video.height))
+    {
+        detail::captureDropped(capture);
+        video = false;
+    }
+    capture.frame++;
+
+    Capture::Slot& slot = capture.slots[capture.next];
+    if(slot.fence && screenshot)
+    {
+        detail::captureSignaled(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        detail::captureRetire(capture, slot, true);
+    }
+    if((screenshot || png || video) && slot.fence)
+    {
+        /* the GPU is CAPTURE_BUFFERS frames behind */
+        detail::captureDropped(capture);
+    }
+    else if(screenshot || png || video)
+    {
+        slot.width = viewport[2];
+        slot.height = viewport[3];
+        slot.screenshotPath = std::move(capture.screenshotPath);
+        capture.screenshotPath.clear();
+        slot.png = png;
+        slot.video = video;
+
+        size_t size = size_t(slot.width) * slot.height * 4;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        if(slot.size < size)
+        {
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+            slot.size = size;
+        }
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glReadBuffer(capture.readBuffer);
+        glReadPixels(viewport[0], viewport[1], slot.width, slot.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        capture.next = (capture.next + 1) % CAPTURE_BUFFERS;
+    }
+
+    std::lock_guard<std::mutex> lock(capture.mutex);
+    capture.stats.captureTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+CaptureStats captureStats(Capture& capture)
+{
+    CaptureStats stats;
+    {
+        std::lock_guard<std::mutex> lock(capture.mutex);
+        stats = capture.stats;
+    }
+    if(capture.recording)
+    {
+        stats.video = videoWriterStats(capture.video);
+    }
+    return stats;
+}
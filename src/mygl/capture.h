@@ -0,0 +1,166 @@
+#pragma once
+
+#include "base.h"
+#include "video_writer.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* pixel buffers read back in turn, a frame is mapped CAPTURE_BUFFERS - 1 frames after its glReadPixels */
+#define CAPTURE_BUFFERS 3
+
+/* a read back frame waiting for the encoder, rows bottom up like glReadPixels returns them */
+struct CaptureFrame
+{
+    std::vector<uint8_t> pixels;
+    int width = 0;
+    int height = 0;
+    std::string path;
+};
+
+struct CaptureStats
+{
+    /* frames queued for encoding and written as PNG */
+    unsigned int captured = 0;
+    unsigned int encoded = 0;
+    unsigned int failed = 0;
+
+    /* continuous and video frames skipped because the GPU fell behind or the frame size changed while recording; frames
+     * the queues rejected are counted here for PNGs and in video.dropped for the recording */
+    unsigned int dropped = 0;
+
+    /* render thread time spent in captureFrame, summed up */
+    double captureTime = 0.0;
+
+    /* writer statistics of the current or last recording */
+    VideoWriterStats video;
+};
+
+/**
+ * Asynchronous framebuffer capture. glReadPixels goes into a ring of pixel buffer objects, each followed by a fence;
+ * a buffer is mapped once its fence signaled, so neither the readback nor the copy waits for the GPU. Copies are
+ * encoded as PNG by encoder threads fed through a bounded queue, or streamed into a Y4M video by a VideoWriter while
+ * recording. Continuous capture and recording that can't keep up drop frames instead of stalling the render loop.
+ */
+struct Capture
+{
+    struct Slot
+    {
+        GLuint pbo = 0;
+        size_t size = 0;
+
+        /* pending readback, fence is nullptr while the slot is free. Continuous frames are named when they are
+         * queued, so the files are numbered without gaps even if frames are dropped. */
+        GLsync fence = nullptr;
+        int width = 0;
+        int height = 0;
+        std::string screenshotPath;
+        bool png = false;
+        bool video = false;
+    };
+    Slot slots[CAPTURE_BUFFERS];
+
+    /* slot written next, also the oldest pending one */
+    unsigned int next = 0;
+
+    /* GL_BACK, or GL_FRONT for single buffered contexts */
+    GLenum readBuffer = GL_BACK;
+
+    /* path of the screenshot taken with the next captureFrame, empty if none */
+    std::string screenshotPath;
+
+    /* continuous capture of every n-th frame to a printf pattern of the capture index, every 0 is off */
+    unsigned int every = 0;
+    std::string pattern;
+    unsigned int frame = 0;
+    unsigned int sequence = 0;
+
+    /* every frame is read back into video while recording */
+    VideoWriter video;
+    bool recording = false;
+
+    /* encoder threads; queue, stats and the recycled pixel buffers are guarded by mutex */
+    std::vector<std::thread> encoders;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stop = false;
+    std::deque<CaptureFrame> queue;
+    size_t queueMax = 0;
+    std::vector<std::vector<uint8_t>> freePixels;
+    CaptureStats stats;
+};
+
+/**
+ * @brief Create the pixel buffers and start the encoder threads. Needs a current context (GL 3.2 for fences).
+ *
+ * @param capture Capture to initialize.
+ * @param encoderCount Number of PNG encoder threads, 0 uses half the hardware concurrency.
+ */
+void captureCreate(Capture& capture, unsigned int encoderCount = 0);
+
+/**
+ * @brief Finish all pending readbacks, wait until every queued frame is written and delete the pixel buffers. Has to
+ * be called for each capture after it is not used anymore.
+ *
+ * @param capture Capture to delete.
+ */
+void captureDelete(Capture& capture);
+
+/**
+ * @brief Save the frame of the next captureFrame as PNG. Screenshots are never dropped.
+ *
+ * @param capture Capture.
+ * @param filepath Path to output image.
+ */
+void captureScreenshot(Capture& capture, const std::string& filepath);
+
+/**
+ * @brief Start or stop continuous capture.
+ *
+ * @param capture Capture.
+ * @param every Capture every n-th frame, 0 stops.
+ * @param pattern Output path with one printf conversion for the capture index, e.g. "capture/frame_%06u.png". Missing
+ * directories are created.
+ */
+void captureContinuous(Capture& capture, unsigned int every, const std::string& pattern);
+
+/**
+ * @brief Check that a continuous capture pattern is safe to use as printf format, i.e. it holds exactly one unsigned
+ * conversion "%u" or "%0Nu" and otherwise only literal "%%".
+ *
+ * @param pattern Output path pattern.
+ * @return True if the pattern is valid.
+ */
+bool capturePatternValid(const std::string& pattern);
+
+/**
+ * @brief Start recording every frame into a Y4M video of the current viewport size. Frames of another size, e.g.
+ * after resizing the window, are dropped.
+ *
+ * @param capture Capture.
+ * @param filepath Output file, usually *.y4m.
+ * @param fps Playback frame rate of the video.
+ *
+ * @return False if the file couldn't be opened or a recording is running.
+ */
+bool captureRecordStart(Capture& capture, const std::string& filepath, unsigned int fps);
+
+/**
+ * @brief Finish the readbacks of the recording, write all queued frames and close the video.
+ */
+void captureRecordStop(Capture& capture);
+
+/**
+ * @brief Queue the finished readbacks of earlier frames and start the readback of the current viewport if a screenshot,
+ * continuous capture or a recording wants this frame. Call once per frame after drawing, before swapping the buffers.
+ */
+void captureFrame(Capture& capture);
+
+/**
+ * @brief Copy of the statistics, can be called while the encoders run.
+ */
+CaptureStats captureStats(Capture& capture);
@@ -1,11 +1,14 @@
 #include "cube_map.h"
+#include "mesh_arena.h"
+#include "profiler.h"
 
-#include <stdexcept>
-#include <iostream>
-
-#include <stb_image/stb_image.h>
+void meshCubeMapVertexAttributes()
+{
+    glEnableVertexAttribArray(eDataIdxCubeMap::PositionCubeMap);
+    glVertexAttribPointer(eDataIdxCubeMap::PositionCubeMap,   3, GL_FLOAT, GL_FALSE, sizeof(Vector3D), nullptr);
+}
 
-MeshCubeMap meshCubeMapCreate(const std::vector<Vector3D> &vertices, const std::vector<unsigned int> &indices)
+MeshCubeMap meshCubeMapCreate(std::span<const Vector3D> vertices, std::span<const unsigned int> indices)
 {
     GLuint vao = 0, vbo = 0, ebo = 0;
 
@@ -23,8 +26,7 @@ MeshCubeMap meshCubeMapCreate(const std::vector<Vector3D> &vertices, const std::
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
         glCheckError();
 
-        glEnableVertexAttribArray(eDataIdxCubeMap::PositionCubeMap);
-        glVertexAttribPointer(eDataIdxCubeMap::PositionCubeMap,   3, GL_FLOAT, GL_FALSE, sizeof(Vector3D), nullptr);
+        meshCubeMapVertexAttributes();
         glCheckError();
     }
 
@@ -35,42 +37,45 @@ MeshCubeMap meshCubeMapCreate(const std::vector<Vector3D> &vertices, const std::
     return MeshCubeMap{vao, vbo, ebo, (unsigned int) vertices.size(), (unsigned int) indices.size()};
 }
 
+MeshCubeMap meshCubeMapCreate(MeshArena& arena, std::span<const Vector3D> vertices, std::span<const unsigned int> indices)
+{
+    MeshRange range = meshArenaAlloc(arena, vertices.data(), vertices.size(), indices);
+
+    MeshCubeMap mesh;
+    mesh.vao = arena.vao;
+    mesh.size_vbo = range.vertexCount;
+    mesh.size_ibo = range.indexCount;
+    mesh.baseVertex = range.baseVertex;
+    mesh.firstIndex = range.firstIndex;
+    mesh.arena = &arena;
+    return mesh;
+}
+
 void meshCubeMapDelete(const MeshCubeMap &mesh)
 {
+    if(mesh.arena)
+    {
+        meshArenaFree(*mesh.arena, {mesh.baseVertex, mesh.size_vbo, mesh.firstIndex, mesh.size_ibo});
+        return;
+    }
+
     glDeleteBuffers(1, &mesh.vbo);
     glDeleteBuffers(1, &mesh.ebo);
     glDeleteVertexArrays(1, &mesh.vao);
 }
 
-TextureCube textureCubeLoad(const std::array<std::string, 6>& image_paths)
+namespace detail
 {
-    int width = 0, height = 0, components = 0;
-
-    /* flip image to match opengl's texture coordinates */
-    stbi_set_flip_vertically_on_load(false);
 
-    GLuint id = 0;
-    glGenTextures(1, &id);
+void textureCubeFace(GLuint id, unsigned int face, const TextureImage& image)
+{
     glBindTexture(GL_TEXTURE_CUBE_MAP, id);
+    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGBA8, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.data);
+    glCheckError();
+}
 
-    for (auto i=0u; i<image_paths.size(); i++)
-    {
-        /* load image */
-        unsigned char* data = stbi_load(image_paths[i].c_str(), &width, &height, &components, 4);
-        if (data == nullptr)
-        {
-            std::cerr << "[TextureCube] couldn't load image file " << image_paths[i] << std::endl;
-            std::cerr.flush();
-            stbi_image_free(data);
-            glDeleteTextures(1, &id);
-            throw std::runtime_error("[TextureCube] couldn't load image file " + image_paths[i]);
-        }
-        /* upload data */
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        glCheckError();
-        stbi_image_free(data);
-    }
-
+void textureCubeParameters()
+{
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
@@ -78,9 +83,60 @@ TextureCube textureCubeLoad(const std::array<std::string, 6>& image_paths)
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glCheckError();
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+}
+
+}
+
+TextureCube textureCubeCreate(const std::array<TextureImage, 6>& faces)
+{
+    GLuint id = 0;
+    glGenTextures(1, &id);
+    for(auto i = 0u; i < faces.size(); i++)
+    {
+        detail::textureCubeFace(id, i, faces[i]);
+    }
+    detail::textureCubeParameters();
+
+    return TextureCube{id, faces[5].width, faces[5].height};
+}
+
+TextureCube textureCubeLoad(const std::array<std::string, 6>& image_paths, JobSystem* jobs)
+{
+    PROFILE_ZONE("textureCubeLoad");
+
+    GLuint id = 0;
+    glGenTextures(1, &id);
+
+    /* a face is uploaded and freed right after it is decoded, so at most the faces in flight are in memory */
+    std::array<TextureImage, 6> faces;
+    std::vector<JobHandle> uploads;
+    for(auto i = 0u; i < image_paths.size(); i++)
+    {
+        JobHandle decode = jobSubmit(jobs, [&, i]{ faces[i] = textureImageLoad(image_paths[i], false); });
+        uploads.push_back(jobSubmit(jobs, [&, i]
+        {
+            detail::textureCubeFace(id, i, faces[i]);
+            textureImageFree(faces[i]);
+        }, {decode}, JOB_MAIN));
+    }
+
+    try
+    {
+        jobWait(jobs, uploads);
+    }
+    catch(...)
+    {
+        for(auto& face : faces)
+        {
+            textureImageFree(face);
+        }
+        glDeleteTextures(1, &id);
+        throw;
+    }
+    detail::textureCubeParameters();
 
-    return TextureCube{id, (unsigned int) width, (unsigned int) height};
+    return TextureCube{id, faces[5].width, faces[5].height};
 }
 
 void textureCubeDelete(const TextureCube& texture)
@@ -88,10 +144,10 @@ void textureCubeDelete(const TextureCube& texture)
     glDeleteTextures(1, &texture.id);
 }
 
-CubeMap cubeMapCreate(const std::vector<Vector3D>& vertices, const std::vector<unsigned int>& indices, const std::array<std::string, 6>& image_paths)
+CubeMap cubeMapCreate(std::span<const Vector3D> vertices, std::span<const unsigned int> indices, const std::array<std::string, 6>& image_paths, MeshArena* arena, JobSystem* jobs)
 {
-    MeshCubeMap mesh = meshCubeMapCreate(vertices, indices);
-    TextureCube texture = textureCubeLoad(image_paths);
+    MeshCubeMap mesh = arena ? meshCubeMapCreate(*arena, vertices, indices) : meshCubeMapCreate(vertices, indices);
+    TextureCube texture = textureCubeLoad(image_paths, jobs);
     return CubeMap{mesh, texture};
 }
 
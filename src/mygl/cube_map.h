@@ -1,12 +1,17 @@
 #pragma once
 
 #include "base.h"
+#include "job_system.h"
+#include "texture.h"
 
+#include <span>
 #include <vector>
 #include <array>
 
 enum eDataIdxCubeMap { PositionCubeMap = 0 };
 
+struct MeshArena;
+
 struct MeshCubeMap
 {
     GLuint vao = 0;
@@ -15,10 +20,24 @@ struct MeshCubeMap
 
     unsigned int size_vbo = 0;
     unsigned int size_ibo = 0;
+
+    /* same as in Mesh: position in the buffers and the owning arena, if any */
+    unsigned int baseVertex = 0;
+    unsigned int firstIndex = 0;
+    MeshArena* arena = nullptr;
 };
 
+/**
+ * @brief Set and enable the position attribute of cube map meshes for the bound VAO and array buffer.
+ */
+void meshCubeMapVertexAttributes();
 
-MeshCubeMap meshCubeMapCreate(const std::vector<Vector3D>& vertices, const std::vector<unsigned int>& indices);
+MeshCubeMap meshCubeMapCreate(std::span<const Vector3D> vertices, std::span<const unsigned int> indices);
+
+/**
+ * @brief Allocate a cube map mesh in an arena with the cube map layout (meshCubeMapVertexAttributes).
+ */
+MeshCubeMap meshCubeMapCreate(MeshArena& arena, std::span<const Vector3D> vertices, std::span<const unsigned int> indices);
 
 /**
  * @brief Cleanup and delete all OpenGL buffers of a mesh. Has to be called for each mesh after it is not used anymore.
@@ -37,13 +56,25 @@ struct TextureCube
 };
 
 /**
- * @brief Initialize OpenGL cube map texture and load it from file.
+ * @brief Initialize OpenGL cube map texture from decoded faces.
  *
- * @param path Path to folder containing texture files. They need to be 
+ * @param faces Unflipped images in the order +x, -x, +y, -y, +z, -z.
  *
  * @return Initialized texture object.
  */
-TextureCube textureCubeLoad(const std::array<std::string, 6>& image_paths);
+TextureCube textureCubeCreate(const std::array<TextureImage, 6>& faces);
+
+/**
+ * @brief Initialize OpenGL cube map texture and load it from file. The faces are decoded as jobs, each is uploaded by
+ * the calling thread as soon as it is decoded.
+ *
+ * @param image_paths Image files of the faces in the order +x, -x, +y, -y, +z, -z.
+ * @param jobs Job system created on the calling thread, nullptr decodes on the calling thread.
+ *
+ * @return Initialized texture object.
+ */
+TextureCube textureCubeLoad(const std::array<std::string, 6>& image_paths, JobSystem* jobs = nullptr);
+
 /**
  * @brief Delete texture cube object. Has to be called for each texture after it is not used anymore.
  *
@@ -57,6 +88,12 @@ struct CubeMap
     TextureCube texture;
 };
 
-CubeMap cubeMapCreate(const std::vector<Vector3D>& vertices, const std::vector<unsigned int>& indices, const std::array<std::string, 6>& image_paths);
+/**
+ * @brief Create the cube mesh and load the cube map texture.
+ *
+ * @param arena Arena with the cube map layout to allocate the mesh from, nullptr for own buffers.
+ * @param jobs Job system to decode the faces with, see textureCubeLoad.
+ */
+CubeMap cubeMapCreate(std::span<const Vector3D> vertices, std::span<const unsigned int> indices, const std::array<std::string, 6>& image_paths, MeshArena* arena = nullptr, JobSystem* jobs = nullptr);
 
 void cubeMapDelete(const CubeMap& cubeMap);
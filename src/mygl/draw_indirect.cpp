@@ -0,0 +1,121 @@
+#include "draw_indirect.h"
+
+namespace detail
+{
+
+/* grow a buffer to hold size bytes and upload data, orphaning the old storage so the driver does not wait for the
+ * previous frame */
+void drawIndirectBufferData(GLenum target, GLuint buffer, const void* data, size_t size)
+{
+    glBindBuffer(target, buffer);
+    glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(target, 0, size, data);
+    glBindBuffer(target, 0);
+}
+
+}
+
+bool drawIndirectSupported()
+{
+    return (GLAD_GL_ARB_multi_draw_indirect && GLAD_GL_ARB_base_instance && GLAD_GL_ARB_draw_indirect && GLAD_GL_ARB_instanced_arrays) != 0;
+}
+
+DrawIndirect drawIndirectCreate(const MeshArena& arena)
+{
+    DrawIndirect draws;
+    glGenBuffers(1, &draws.commandBuffer);
+    glGenBuffers(1, &draws.drawBuffer);
+    glGenBuffers(1, &draws.matrixBuffer);
+    glGenTextures(1, &draws.matrixTexture);
+
+    /* per draw instance index, advanced once per instance and offset by baseInstance; glad only loads the 3.2 core
+     * functions, the divisor of the 3.3 context comes through the extension entry point */
+    if(drawIndirectSupported())
+    {
+        glBindVertexArray(arena.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, draws.drawBuffer);
+        glEnableVertexAttribArray(eDataIdx::Instance);
+        glVertexAttribIPointer(eDataIdx::Instance, 1, GL_UNSIGNED_INT, sizeof(GLuint), nullptr);
+        glVertexAttribDivisorARB(eDataIdx::Instance, 1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    /* the texture needs storage before it can be bound */
+    Matrix4D identity = Matrix4D::identity();
+    detail::drawIndirectBufferData(GL_TEXTURE_BUFFER, draws.matrixBuffer, identity.ptr(), sizeof(Matrix4D));
+    glBindTexture(GL_TEXTURE_BUFFER, draws.matrixTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, draws.matrixBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glCheckError();
+
+    return draws;
+}
+
+void drawIndirectClear(DrawIndirect& draws)
+{
+    draws.commands.clear();
+    draws.drawInstance.clear();
+    draws.matrices.clear();
+}
+
+void drawIndirectAdd(DrawIndirect& draws, const Mesh& mesh, unsigned int indexOffset, unsigned int indexCount, GLuint matrix)
+{
+    GLuint draw = draws.commands.size();
+    draws.commands.push_back({indexCount, 1, mesh.firstIndex + indexOffset, (GLint) mesh.baseVertex, draw});
+    draws.drawInstance.push_back(matrix);
+}
+
+void drawIndirectUpload(DrawIndirect& draws)
+{
+    if(!draws.matrices.empty())
+    {
+        detail::drawIndirectBufferData(GL_TEXTURE_BUFFER, draws.matrixBuffer, draws.matrices.data(), draws.matrices.size() * sizeof(Matrix4D));
+    }
+
+    if(drawIndirectSupported() && !draws.commands.empty())
+    {
+        detail::drawIndirectBufferData(GL_DRAW_INDIRECT_BUFFER, draws.commandBuffer, draws.commands.data(), draws.commands.size() * sizeof(DrawElementsIndirectCommand));
+        detail::drawIndirectBufferData(GL_ARRAY_BUFFER, draws.drawBuffer, draws.drawInstance.data(), draws.drawInstance.size() * sizeof(GLuint));
+    }
+    glCheckError();
+}
+
+void drawIndirectBindMatrices(const DrawIndirect& draws, unsigned int unit)
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_BUFFER, draws.matrixTexture);
+}
+
+void drawIndirectBindArena(const MeshArena& arena, bool indirect)
+{
+    glBindVertexArray(arena.vao);
+    if(drawIndirectSupported() && indirect)
+    {
+        glEnableVertexAttribArray(eDataIdx::Instance);
+    }
+    else if(drawIndirectSupported())
+    {
+        glDisableVertexAttribArray(eDataIdx::Instance);
+    }
+}
+
+void drawIndirectSubmit(const DrawIndirect& draws, size_t first, size_t count)
+{
+    if(count == 0)
+    {
+        return;
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, draws.commandBuffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*) (first * sizeof(DrawElementsIndirectCommand)), count, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void drawIndirectDelete(const DrawIndirect& draws)
+{
+    glDeleteBuffers(1, &draws.commandBuffer);
+    glDeleteBuffers(1, &draws.drawBuffer);
+    glDeleteBuffers(1, &draws.matrixBuffer);
+    glDeleteTextures(1, &draws.matrixTexture);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "mesh_arena.h"
+
+#include <vector>
+
+/* memory layout of one glMultiDrawElementsIndirect command */
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+/* Per frame draw data for the instanced shaders. Every draw reads its model matrix from uInstances (a buffer texture,
+ * four texels per matrix) at the index given by the attribute eDataIdx::Instance. With multi draw indirect the
+ * attribute is an instanced array indexed by the baseInstance of each command, the fallback loop sets it as a constant
+ * attribute value before each glDrawElementsBaseVertex. */
+struct DrawIndirect
+{
+    GLuint commandBuffer = 0;
+    GLuint drawBuffer = 0;
+    GLuint matrixBuffer = 0;
+    GLuint matrixTexture = 0;
+
+    /* filled by the caller each frame, then uploaded by drawIndirectUpload */
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<GLuint> drawInstance;
+    std::vector<Matrix4D> matrices;
+};
+
+/**
+ * @brief Whether the context can submit draws with glMultiDrawElementsIndirect and per command baseInstance (GL 4.3 or
+ * ARB_multi_draw_indirect + ARB_base_instance).
+ */
+bool drawIndirectSupported();
+
+/**
+ * @brief Create the buffers and attach the per draw instance attribute to the arena's VAO.
+ *
+ * @param arena Arena all indirect draws read their geometry from.
+ *
+ * @return Empty draw list.
+ */
+DrawIndirect drawIndirectCreate(const MeshArena& arena);
+
+/**
+ * @brief Clear commands, draw data and matrices for a new frame.
+ */
+void drawIndirectClear(DrawIndirect& draws);
+
+/**
+ * @brief Append a command drawing part of a mesh in the arena.
+ *
+ * @param draws Draw list.
+ * @param mesh Mesh in the arena.
+ * @param indexOffset First index relative to the mesh.
+ * @param indexCount Number of indices.
+ * @param matrix Index of the model matrix in draws.matrices.
+ */
+void drawIndirectAdd(DrawIndirect& draws, const Mesh& mesh, unsigned int indexOffset, unsigned int indexCount, GLuint matrix);
+
+/**
+ * @brief Upload matrices, and if supported also commands and draw data, for the current frame.
+ */
+void drawIndirectUpload(DrawIndirect& draws);
+
+/**
+ * @brief Bind the matrix buffer texture to a texture unit, the shader's uInstances has to use the same unit.
+ */
+void drawIndirectBindMatrices(const DrawIndirect& draws, unsigned int unit);
+
+/**
+ * @brief Bind the arena VAO for one of the submission paths. For multi draw indirect the instance attribute reads the
+ * per draw data, for single draws it is disabled so the value set with glVertexAttribI4ui is used.
+ *
+ * @param arena Arena passed to drawIndirectCreate.
+ * @param indirect Whether the next draws are submitted with drawIndirectSubmit.
+ */
+void drawIndirectBindArena(const MeshArena& arena, bool indirect);
+
+/**
+ * @brief Submit commands [first, first + count) with one glMultiDrawElementsIndirect, after drawIndirectBindArena(arena, true).
+ */
+void drawIndirectSubmit(const DrawIndirect& draws, size_t first, size_t count);
+
+/**
+ * @brief Delete all buffers of a draw list.
+ */
+void drawIndirectDelete(const DrawIndirect& draws);
@@ -2,13 +2,13 @@
 
 #include "mesh.h"
 
-#include <vector>
+#include <array>
 
-/* cube geometry */
+/* cube geometry, constexpr so the tables live in read-only data and need no static initialization */
 namespace cube
 {
-    inline static const std::vector<Vector3D> vertexPos =
-            {
+    inline constexpr std::array<Vector3D, 8> vertexPos =
+            {{
                     {-1.0f, -1.0f, 1.0f},
                     {-1.0f,  1.0f, 1.0f},
                     { 1.0f,  1.0f, 1.0f},
@@ -18,10 +18,10 @@ namespace cube
                     {-1.0f,  1.0f, -1.0f},
                     { 1.0f,  1.0f, -1.0f},
                     { 1.0f, -1.0f, -1.0f}
-            };
+            }};
 
-    inline static const std::vector<Vertex> vertices =
-            {
+    inline constexpr std::array<Vertex, 8> vertices =
+            {{
                     {{-1.0, -1.0, 1.0}, {1.0, 0.0, 0.0}, {0.0, 0.0}},
                     {{-1.0,  1.0, 1.0}, {1.0, 0.0, 0.0}, {1.0, 0.0}},
                     {{ 1.0,  1.0, 1.0}, {1.0, 0.0, 0.0}, {1.0, 1.0}},
@@ -31,9 +31,9 @@ namespace cube
                     {{-1.0,  1.0, -1.0}, {1.0, 0.0, 0.0}, {1.0, 0.0}},
                     {{ 1.0,  1.0, -1.0}, {1.0, 0.0, 0.0}, {1.0, 1.0}},
                     {{ 1.0, -1.0, -1.0}, {1.0, 0.0, 0.0}, {0.0, 1.0}}
-            };
+            }};
 
-    inline static const std::vector<unsigned int> indices =
+    inline constexpr std::array<unsigned int, 36> indices =
             {
                     0, 1, 2,
                     2, 3, 0,
@@ -60,15 +60,15 @@ namespace cube
 namespace quad
 {
 
-    inline static const std::vector<Vertex> vertices =
-            {
+    inline constexpr std::array<Vertex, 4> vertices =
+            {{
                     {{-1.0, -1.0, 0.0}, {0.0, 0.0, -1.0}, {0.0, 0.0}},
                     {{-1.0,  1.0, 0.0}, {0.0, 0.0, -1.0}, {0.0, 1.0}},
                     {{ 1.0,  1.0, 0.0}, {0.0, 0.0, -1.0}, {1.0, 1.0}},
                     {{ 1.0, -1.0, 0.0}, {0.0, 0.0, -1.0}, {1.0, 0.0}}
-            };
+            }};
 
-    inline static const std::vector<unsigned int> indices =
+    inline constexpr std::array<unsigned int, 6> indices =
             {
                     0, 1, 2,
                     2, 3, 0
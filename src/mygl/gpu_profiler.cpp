@@ -0,0 +1,104 @@
+#include "gpu_profiler.h"
+
+#include <algorithm>
+
+namespace detail
+{
+
+GLuint gpuProfilerQuery(GpuProfiler& gpu)
+{
+    if(gpu.freeQueries.empty())
+    {
+        GLuint queries[32];
+        glGenQueries(32, queries);
+        gpu.freeQueries.insert(gpu.freeQueries.end(), queries, queries + 32);
+    }
+
+    GLuint query = gpu.freeQueries.back();
+    gpu.freeQueries.pop_back();
+    return query;
+}
+
+/* map the GL clock to the profiler clock, GL_TIMESTAMP is the time when all previous commands reached the GPU */
+void gpuProfilerCalibrate(GpuProfiler& gpu)
+{
+    GLint64 glTime = 0;
+    glGetInteger64v(GL_TIMESTAMP, &glTime);
+    gpu.offset = int64_t(profilerNow()) - glTime;
+}
+
+}
+
+GpuProfiler gpuProfilerCreate()
+{
+    GpuProfiler gpu;
+    gpu.track = profilerTrackCreate("GPU");
+    detail::gpuProfilerCalibrate(gpu);
+    return gpu;
+}
+
+void gpuProfilerDelete(GpuProfiler& gpu)
+{
+    for(auto& frame : gpu.frames)
+    {
+        for(const auto& zone : frame.zones)
+        {
+            gpu.freeQueries.push_back(zone.begin);
+            gpu.freeQueries.push_back(zone.end);
+        }
+        frame.zones.clear();
+    }
+
+    glDeleteQueries(gpu.freeQueries.size(), gpu.freeQueries.data());
+    gpu.freeQueries.clear();
+}
+
+unsigned int gpuProfilerBegin(GpuProfiler& gpu, const char* name)
+{
+    if(!gProfiler.enabled.load(std::memory_order_relaxed))
+    {
+        return ~0u;
+    }
+
+    GpuProfilerFrame& frame = gpu.frames[gpu.frame];
+    GLuint begin = detail::gpuProfilerQuery(gpu);
+    glQueryCounter(begin, GL_TIMESTAMP);
+    frame.zones.push_back({name, begin, 0});
+    return frame.zones.size() - 1;
+}
+
+void gpuProfilerEnd(GpuProfiler& gpu, unsigned int zone)
+{
+    if(zone == ~0u)
+    {
+        return;
+    }
+
+    GLuint end = detail::gpuProfilerQuery(gpu);
+    glQueryCounter(end, GL_TIMESTAMP);
+    gpu.frames[gpu.frame].zones[zone].end = end;
+}
+
+void gpuProfilerEndFrame(GpuProfiler& gpu)
+{
+    gpu.frame = (gpu.frame + 1) % (GPU_PROFILER_LATENCY + 1);
+
+    /* the frame recorded GPU_PROFILER_LATENCY frames ago, reused for the next one */
+    GpuProfilerFrame& oldest = gpu.frames[gpu.frame];
+    for(const auto& zone : oldest.zones)
+    {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(zone.begin, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(zone.end, GL_QUERY_RESULT, &end);
+        profilerEmit(gpu.track, zone.name, uint64_t(std::max<int64_t>(int64_t(begin) + gpu.offset, 0)), uint64_t(std::max<int64_t>(int64_t(end) + gpu.offset, 0)));
+
+        gpu.freeQueries.push_back(zone.begin);
+        gpu.freeQueries.push_back(zone.end);
+    }
+    oldest.zones.clear();
+
+    if(gProfiler.enabled.load(std::memory_order_relaxed))
+    {
+        detail::gpuProfilerCalibrate(gpu);
+    }
+}
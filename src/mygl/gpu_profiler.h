@@ -0,0 +1,90 @@
+#pragma once
+
+#include "base.h"
+#include "profiler.h"
+
+#include <vector>
+
+/* frames in flight before the timestamps of a frame are read back */
+#define GPU_PROFILER_LATENCY 3
+
+/* GPU zones of one frame, each a pair of GL_TIMESTAMP queries */
+struct GpuProfilerFrame
+{
+    struct Zone
+    {
+        const char* name;
+        GLuint begin;
+        GLuint end;
+    };
+    std::vector<Zone> zones;
+};
+
+/**
+ * GPU side of the profiler. Zones are bracketed with glQueryCounter timestamps and read back GPU_PROFILER_LATENCY
+ * frames later, so reading them never stalls. The GPU clock is mapped to profilerNow once per frame with
+ * GL_TIMESTAMP and the zones are emitted to a "GPU" track of gProfiler, next to the CPU zones of the same frame.
+ */
+struct GpuProfiler
+{
+    GpuProfilerFrame frames[GPU_PROFILER_LATENCY + 1];
+    unsigned int frame = 0;
+
+    /* query objects of finished zones, reused */
+    std::vector<GLuint> freeQueries;
+
+    /* profilerNow minus GL time, in nanoseconds */
+    int64_t offset = 0;
+    ProfilerTrack* track = nullptr;
+};
+
+/**
+ * @brief Create the GPU track. Needs a current context with timer queries (GL 3.3).
+ */
+GpuProfiler gpuProfilerCreate();
+
+/**
+ * @brief Delete all query objects.
+ */
+void gpuProfilerDelete(GpuProfiler& gpu);
+
+/**
+ * @brief Start a GPU zone, a no-op while the profiler is disabled.
+ *
+ * @param gpu GPU profiler.
+ * @param name Zone name, has to outlive the profiler (string literal).
+ *
+ * @return Zone index for gpuProfilerEnd, ~0u if disabled.
+ */
+unsigned int gpuProfilerBegin(GpuProfiler& gpu, const char* name);
+
+/**
+ * @brief End a GPU zone started with gpuProfilerBegin.
+ */
+void gpuProfilerEnd(GpuProfiler& gpu, unsigned int zone);
+
+/**
+ * @brief End the frame: emit the zones of the oldest frame in flight and start recording the next one. Call once per
+ * frame after all zones ended.
+ */
+void gpuProfilerEndFrame(GpuProfiler& gpu);
+
+/* measures its scope on the GPU */
+struct GpuProfilerZone
+{
+    GpuProfiler& gpu;
+    unsigned int zone;
+
+    GpuProfilerZone(GpuProfiler& gpu, const char* name) : gpu(gpu), zone(gpuProfilerBegin(gpu, name)) {}
+    ~GpuProfilerZone() { gpuProfilerEnd(gpu, zone); }
+
+    GpuProfilerZone(const GpuProfilerZone&) = delete;
+    GpuProfilerZone& operator=(const GpuProfilerZone&) = delete;
+};
+
+/* PROFILE_GPU_ZONE(gpu, "name") times the rest of the enclosing scope on the CPU and on the GPU */
+#ifdef PROFILER_ENABLED
+#define PROFILE_GPU_ZONE(gpu, name) PROFILE_ZONE(name); GpuProfilerZone PROFILER_CONCAT(gpuProfilerZone, __LINE__)(gpu, name)
+#else
+#define PROFILE_GPU_ZONE(gpu, name) ((void) 0)
+#endif
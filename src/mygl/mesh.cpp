@@ -1,6 +1,28 @@
 #include "mesh.h"
+#include "mesh_arena.h"
+#include "vertex_pack.h"
 
-Mesh meshCreate(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+void meshVertexAttributes()
+{
+    glEnableVertexAttribArray(eDataIdx::Position);
+    glEnableVertexAttribArray(eDataIdx::Normal);
+    glEnableVertexAttribArray(eDataIdx::UV);
+    glVertexAttribPointer(eDataIdx::Position,   3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, pos));
+    glVertexAttribPointer(eDataIdx::Normal,     3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, normal));
+    glVertexAttribPointer(eDataIdx::UV,         2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, uv));
+}
+
+void meshPackedVertexAttributes()
+{
+    glEnableVertexAttribArray(eDataIdx::Position);
+    glEnableVertexAttribArray(eDataIdx::Normal);
+    glEnableVertexAttribArray(eDataIdx::UV);
+    glVertexAttribPointer(eDataIdx::Position,   3, GL_UNSIGNED_SHORT,  GL_FALSE, sizeof(PackedVertex), (void*) offsetof(PackedVertex, pos));
+    glVertexAttribPointer(eDataIdx::Normal,     2, GL_SHORT,           GL_TRUE,  sizeof(PackedVertex), (void*) offsetof(PackedVertex, normal));
+    glVertexAttribPointer(eDataIdx::UV,         2, GL_HALF_FLOAT,      GL_FALSE, sizeof(PackedVertex), (void*) offsetof(PackedVertex, uv));
+}
+
+Mesh meshCreate(std::span<const Vertex> vertices, std::span<const unsigned int> indices)
 {
     GLuint vao = 0, vbo = 0, ebo = 0;
 
@@ -18,12 +40,7 @@ Mesh meshCreate(const std::vector<Vertex> &vertices, const std::vector<unsigned
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
         glCheckError();
 
-        glEnableVertexAttribArray(eDataIdx::Position);
-        glEnableVertexAttribArray(eDataIdx::Normal);
-        glEnableVertexAttribArray(eDataIdx::UV);
-        glVertexAttribPointer(eDataIdx::Position,   3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, pos));
-        glVertexAttribPointer(eDataIdx::Normal,     3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, normal));
-        glVertexAttribPointer(eDataIdx::UV,         2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, uv));
+        meshVertexAttributes();
         glCheckError();
     }
 
@@ -34,8 +51,44 @@ Mesh meshCreate(const std::vector<Vertex> &vertices, const std::vector<unsigned
     return Mesh{vao, vbo, ebo, (unsigned int) vertices.size(), (unsigned int) indices.size()};
 }
 
+Mesh meshCreate(MeshArena& arena, std::span<const Vertex> vertices, std::span<const unsigned int> indices)
+{
+    MeshRange range = meshArenaAlloc(arena, vertices.data(), vertices.size(), indices);
+
+    Mesh mesh;
+    mesh.vao = arena.vao;
+    mesh.size_vbo = range.vertexCount;
+    mesh.size_ibo = range.indexCount;
+    mesh.baseVertex = range.baseVertex;
+    mesh.firstIndex = range.firstIndex;
+    mesh.arena = &arena;
+    return mesh;
+}
+
+Mesh meshCreatePacked(MeshArena& arena, std::span<const Vertex> vertices, std::span<const unsigned int> indices, const VertexQuantization& quantization)
+{
+    std::vector<PackedVertex> packed = vertexPack(vertices, quantization);
+    MeshRange range = meshArenaAlloc(arena, packed.data(), packed.size(), indices);
+
+    Mesh mesh;
+    mesh.vao = arena.vao;
+    mesh.size_vbo = range.vertexCount;
+    mesh.size_ibo = range.indexCount;
+    mesh.baseVertex = range.baseVertex;
+    mesh.firstIndex = range.firstIndex;
+    mesh.arena = &arena;
+    mesh.quantization = quantization;
+    return mesh;
+}
+
 void meshDelete(const Mesh &mesh)
 {
+    if(mesh.arena)
+    {
+        meshArenaFree(*mesh.arena, {mesh.baseVertex, mesh.size_vbo, mesh.firstIndex, mesh.size_ibo});
+        return;
+    }
+
     glDeleteBuffers(1, &mesh.vbo);
     glDeleteBuffers(1, &mesh.ebo);
     glDeleteVertexArrays(1, &mesh.vao);
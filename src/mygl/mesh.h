@@ -2,9 +2,11 @@
 
 #include "base.h"
 
+#include <cstdint>
+#include <span>
 #include <vector>
 
-enum eDataIdx { Position = 0, Normal = 1, UV = 2 };
+enum eDataIdx { Position = 0, Normal = 1, UV = 2, Instance = 3 };
 
 struct Vertex
 {
@@ -14,6 +16,25 @@ struct Vertex
 };
 
 
+/* Compressed vertex, 16 instead of 32 bytes: the position as 16 bit integers on a per mesh grid (VertexQuantization),
+ * the normal octahedral encoded in two snorm16 and the uv as half floats. Built with vertexPack. */
+struct PackedVertex
+{
+    uint16_t pos[3];
+    uint16_t pad;
+    int16_t normal[2];
+    uint16_t uv[2];
+};
+
+/* grid of the packed positions, position = offset + scale * integer position; identity for float vertices */
+struct VertexQuantization
+{
+    Vector3D offset = {0.0f, 0.0f, 0.0f};
+    Vector3D scale = {1.0f, 1.0f, 1.0f};
+};
+
+struct MeshArena;
+
 struct Mesh
 {
     GLuint vao = 0;
@@ -22,8 +43,29 @@ struct Mesh
 
     unsigned int size_vbo = 0;
     unsigned int size_ibo = 0;
+
+    /* first vertex and index of the mesh in its buffers, non zero for meshes in an arena */
+    unsigned int baseVertex = 0;
+    unsigned int firstIndex = 0;
+
+    /* arena the mesh was allocated from, the vbo and ebo then belong to the arena and are 0 here */
+    MeshArena* arena = nullptr;
+
+    /* decodes the positions of packed meshes, see uPositionOffset/uPositionScale in default.vert */
+    VertexQuantization quantization;
 };
 
+/**
+ * @brief Set and enable the attribute pointers of the Vertex layout for the bound VAO and array buffer.
+ */
+void meshVertexAttributes();
+
+/**
+ * @brief Set and enable the attribute pointers of the PackedVertex layout for the bound VAO and array buffer. The
+ * integer positions arrive unnormalized, the normals as snorm and the uvs as half floats.
+ */
+void meshPackedVertexAttributes();
+
 
 /**
  * @brief Initializes all buffer objects (VBO, IBO) required for the mesh and fill it with data. Further, a vertex array
@@ -41,10 +83,39 @@ struct Mesh
  *   glDrawElements(GL_TRIANGLES, myMesh.size_ibo, GL_UNSIGNED_INT, nullptr);
  *
  */
-Mesh meshCreate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+Mesh meshCreate(std::span<const Vertex> vertices, std::span<const unsigned int> indices);
+
+/**
+ * @brief Allocate a mesh in a shared arena instead of own buffers. The mesh uses the arena's VAO, so the indices have
+ * to be drawn with firstIndex and baseVertex:
+ *
+ *   glDrawElementsBaseVertex(GL_TRIANGLES, myMesh.size_ibo, GL_UNSIGNED_INT,
+ *                            (const void*) (myMesh.firstIndex*sizeof(unsigned int)), myMesh.baseVertex);
+ *
+ * @param arena Arena with the Vertex layout (meshVertexAttributes).
+ * @param vertices Data for each vertex of the mesh.
+ * @param indices List of indices that form polygons in the mesh.
+ *
+ * @return Mesh inside the arena.
+ */
+Mesh meshCreate(MeshArena& arena, std::span<const Vertex> vertices, std::span<const unsigned int> indices);
+
+/**
+ * @brief Pack vertices into the PackedVertex layout and allocate them in an arena with that layout
+ * (meshPackedVertexAttributes). Draw like any arena mesh, the shader decodes with mesh.quantization.
+ *
+ * @param arena Arena with the PackedVertex layout.
+ * @param vertices Float vertices, packed with vertexPack.
+ * @param indices List of indices that form polygons in the mesh.
+ * @param quantization Position grid, usually vertexQuantization of the mesh bounds.
+ *
+ * @return Mesh inside the arena.
+ */
+Mesh meshCreatePacked(MeshArena& arena, std::span<const Vertex> vertices, std::span<const unsigned int> indices, const VertexQuantization& quantization);
 
 /**
- * @brief Cleanup and delete all OpenGL buffers of a mesh. Has to be called for each mesh after it is not used anymore.
+ * @brief Cleanup and delete all OpenGL buffers of a mesh, or release its ranges if it lives in an arena. Has to be
+ * called for each mesh after it is not used anymore.
  *
  * @param mesh Mesh to delete.
  */
@@ -0,0 +1,153 @@
+#include "mesh_arena.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace detail
+{
+
+/* reallocate a buffer with a larger size and copy the old content over on the GPU */
+GLuint meshArenaGrowBuffer(GLuint buffer, size_t oldSize, size_t newSize)
+{
+    GLuint grown = 0;
+    glGenBuffers(1, &grown);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+    if(oldSize > 0)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glCheckError();
+
+    glDeleteBuffers(1, &buffer);
+    return grown;
+}
+
+/* allocate count elements, growing the allocator to at least twice its capacity if nothing fits */
+unsigned int meshArenaReserve(RangeAllocator& allocator, unsigned int count)
+{
+    unsigned int offset = rangeAllocatorAlloc(allocator, count);
+    if(offset != RangeAllocator::INVALID)
+    {
+        return offset;
+    }
+
+    /* the free range at the end is extended, so it has to cover what it lacks of count */
+    unsigned int tail = 0;
+    if(!allocator.free.empty() && allocator.free.back().offset + allocator.free.back().count == allocator.capacity)
+    {
+        tail = allocator.free.back().count;
+    }
+    rangeAllocatorGrow(allocator, std::max(2 * allocator.capacity, allocator.capacity + count - tail));
+    return rangeAllocatorAlloc(allocator, count);
+}
+
+}
+
+MeshArena meshArenaCreate(unsigned int vertexSize, void (*vertexAttributes)(), unsigned int vertexCapacity, unsigned int indexCapacity)
+{
+    MeshArena arena;
+    arena.vertexSize = vertexSize;
+    arena.vertexAttributes = vertexAttributes;
+    arena.vertices = rangeAllocatorCreate(vertexCapacity);
+    arena.indices = rangeAllocatorCreate(indexCapacity);
+
+    glGenVertexArrays(1, &arena.vao);
+    glGenBuffers(1, &arena.vbo);
+    glGenBuffers(1, &arena.ebo);
+
+    glBindVertexArray(arena.vao);
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, arena.vbo);
+        glBufferData(GL_ARRAY_BUFFER, size_t(vertexCapacity) * vertexSize, nullptr, GL_STATIC_DRAW);
+        glCheckError();
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, size_t(indexCapacity) * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+        glCheckError();
+
+        arena.vertexAttributes();
+        glCheckError();
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    return arena;
+}
+
+MeshRange meshArenaAlloc(MeshArena& arena, const void* vertices, unsigned int vertexCount, std::span<const unsigned int> indices)
+{
+    /* capacities before allocating, to see whether the buffers have to grow */
+    unsigned int vertexCapacity = arena.vertices.capacity;
+    unsigned int indexCapacity = arena.indices.capacity;
+
+    MeshRange range;
+    range.vertexCount = vertexCount;
+    range.indexCount = indices.size();
+    range.baseVertex = detail::meshArenaReserve(arena.vertices, vertexCount);
+    range.firstIndex = detail::meshArenaReserve(arena.indices, range.indexCount);
+    if(range.baseVertex == RangeAllocator::INVALID || range.firstIndex == RangeAllocator::INVALID)
+    {
+        throw std::runtime_error("[MeshArena] Couldn't allocate mesh with " + std::to_string(vertexCount) + " vertices");
+    }
+
+    /* the VAO keeps its attribute state, only the buffer bindings have to be renewed after growing */
+    glBindVertexArray(arena.vao);
+    if(arena.vertices.capacity != vertexCapacity)
+    {
+        arena.vbo = detail::meshArenaGrowBuffer(arena.vbo, size_t(vertexCapacity) * arena.vertexSize, size_t(arena.vertices.capacity) * arena.vertexSize);
+        glBindBuffer(GL_ARRAY_BUFFER, arena.vbo);
+        arena.vertexAttributes();
+    }
+    if(arena.indices.capacity != indexCapacity)
+    {
+        arena.ebo = detail::meshArenaGrowBuffer(arena.ebo, size_t(indexCapacity) * sizeof(unsigned int), size_t(arena.indices.capacity) * sizeof(unsigned int));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.ebo);
+    }
+    glBindVertexArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, arena.vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, size_t(range.baseVertex) * arena.vertexSize, size_t(vertexCount) * arena.vertexSize, vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arena.ebo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, size_t(range.firstIndex) * sizeof(unsigned int), indices.size_bytes(), indices.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glCheckError();
+
+    arena.meshCount++;
+    return range;
+}
+
+void meshArenaFree(MeshArena& arena, const MeshRange& range)
+{
+    rangeAllocatorFree(arena.vertices, {range.baseVertex, range.vertexCount});
+    rangeAllocatorFree(arena.indices, {range.firstIndex, range.indexCount});
+    arena.meshCount--;
+}
+
+MeshArenaStats meshArenaStats(const MeshArena& arena)
+{
+    RangeAllocatorStats vertices = rangeAllocatorStats(arena.vertices);
+    RangeAllocatorStats indices = rangeAllocatorStats(arena.indices);
+
+    MeshArenaStats stats;
+    stats.bytesAllocated = size_t(vertices.capacity) * arena.vertexSize + size_t(indices.capacity) * sizeof(unsigned int);
+    stats.bytesInUse = size_t(vertices.used) * arena.vertexSize + size_t(indices.used) * sizeof(unsigned int);
+    stats.bytesWasted = size_t(vertices.wasted) * arena.vertexSize + size_t(indices.wasted) * sizeof(unsigned int);
+    stats.freeRanges = vertices.freeRanges + indices.freeRanges;
+    stats.meshCount = arena.meshCount;
+    return stats;
+}
+
+void meshArenaDelete(const MeshArena& arena)
+{
+    glDeleteBuffers(1, &arena.vbo);
+    glDeleteBuffers(1, &arena.ebo);
+    glDeleteVertexArrays(1, &arena.vao);
+}
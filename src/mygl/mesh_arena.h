@@ -0,0 +1,90 @@
+#pragma once
+
+#include "mesh.h"
+#include "range_allocator.h"
+
+#include <cstddef>
+
+/* place of one mesh inside a MeshArena, indices are relative to baseVertex */
+struct MeshRange
+{
+    unsigned int baseVertex = 0;
+    unsigned int vertexCount = 0;
+    unsigned int firstIndex = 0;
+    unsigned int indexCount = 0;
+};
+
+/* One vertex and one index buffer shared by all meshes of one vertex format, drawn through a single VAO. Vertex and
+ * index ranges are sub-allocated with a free list, so meshes can be added and removed at runtime; when no free range
+ * is large enough the buffers grow on the GPU and the VAO is pointed at the new storage. */
+struct MeshArena
+{
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    GLuint ebo = 0;
+
+    /* vertex format: size of one vertex and the function setting the attribute pointers of the bound VAO */
+    unsigned int vertexSize = 0;
+    void (*vertexAttributes)() = nullptr;
+
+    RangeAllocator vertices;
+    RangeAllocator indices;
+    unsigned int meshCount = 0;
+};
+
+struct MeshArenaStats
+{
+    /* GPU memory of the vertex and index buffer */
+    size_t bytesAllocated = 0;
+
+    /* memory held by live meshes */
+    size_t bytesInUse = 0;
+
+    /* free memory in holes left by removed meshes, only usable by meshes that fit into them */
+    size_t bytesWasted = 0;
+
+    unsigned int freeRanges = 0;
+    unsigned int meshCount = 0;
+};
+
+/**
+ * @brief Allocate the shared buffers and the VAO of one vertex format.
+ *
+ * @param vertexSize Size of one vertex in bytes.
+ * @param vertexAttributes Sets the attribute pointers, called with the VAO and the vertex buffer bound, e.g.
+ * meshVertexAttributes.
+ * @param vertexCapacity Initial number of vertices.
+ * @param indexCapacity Initial number of indices.
+ *
+ * @return Empty arena.
+ */
+MeshArena meshArenaCreate(unsigned int vertexSize, void (*vertexAttributes)(), unsigned int vertexCapacity, unsigned int indexCapacity);
+
+/**
+ * @brief Allocate a mesh in the arena and upload its data, the buffers grow if there is no free range large enough.
+ *
+ * @param arena Arena to allocate from.
+ * @param vertices Vertex data, vertexCount * arena.vertexSize bytes.
+ * @param vertexCount Number of vertices.
+ * @param indices Indices relative to the first vertex of the mesh.
+ *
+ * @return Range of the mesh, draw it with glDrawElementsBaseVertex or an indirect command.
+ */
+MeshRange meshArenaAlloc(MeshArena& arena, const void* vertices, unsigned int vertexCount, std::span<const unsigned int> indices);
+
+/**
+ * @brief Release the ranges of a mesh, they are reused by later allocations.
+ */
+void meshArenaFree(MeshArena& arena, const MeshRange& range);
+
+/**
+ * @brief Memory usage and fragmentation of an arena.
+ */
+MeshArenaStats meshArenaStats(const MeshArena& arena);
+
+/**
+ * @brief Delete the buffers and the VAO of an arena.
+ *
+ * @param arena Arena to delete.
+ */
+void meshArenaDelete(const MeshArena& arena);
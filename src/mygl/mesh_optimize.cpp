@@ -0,0 +1,412 @@
+#include "mesh_optimize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace detail
+{
+
+/* FIFO post-transform cache: a vertex is cached while fewer than cacheSize misses happened since its own miss */
+struct FifoCache
+{
+    std::vector<unsigned int> stamp;
+    unsigned int cacheSize;
+    unsigned int time;
+
+    FifoCache(unsigned int vertexCount, unsigned int cacheSize)
+        : stamp(vertexCount, 0), cacheSize(cacheSize), time(cacheSize + 1)
+    {
+    }
+
+    /* transform the vertices of one triangle, returns the number of misses */
+    unsigned int triangle(const unsigned int* corner)
+    {
+        unsigned int misses = 0;
+        for(int i = 0; i < 3; i++)
+        {
+            if(time - stamp[corner[i]] > cacheSize)
+            {
+                stamp[corner[i]] = time++;
+                misses++;
+            }
+        }
+        return misses;
+    }
+
+    void reset()
+    {
+        time += cacheSize + 1;
+    }
+};
+
+constexpr unsigned int forsythCacheSize = 32;
+
+/* Forsyth's vertex score: recently used vertices score high, the three of the last triangle a little lower so strips
+ * do not turn back onto themselves, and vertices with few remaining triangles get a boost so they are finished off */
+float forsythScore(int cachePosition, unsigned int liveTriangles)
+{
+    if(liveTriangles == 0)
+    {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if(cachePosition >= 0)
+    {
+        score = cachePosition < 3 ? 0.75f : std::pow(1.0f - float(cachePosition - 3) / (forsythCacheSize - 3), 1.5f);
+    }
+    return score + 2.0f / std::sqrt(float(liveTriangles));
+}
+
+struct VertexHash
+{
+    size_t operator()(const Vertex& vertex) const
+    {
+        uint32_t words[sizeof(Vertex) / 4];
+        std::memcpy(words, &vertex, sizeof(Vertex));
+
+        uint64_t hash = 14695981039346656037ull;
+        for(uint32_t word : words)
+        {
+            hash = (hash ^ word) * 1099511628211ull;
+        }
+        return size_t(hash ^ (hash >> 32));
+    }
+};
+
+struct VertexEqual
+{
+    bool operator()(const Vertex& a, const Vertex& b) const
+    {
+        return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+    }
+};
+
+/* cluster of consecutive triangles for the overdraw order */
+struct OverdrawCluster
+{
+    unsigned int first;
+    unsigned int count;
+    float sortKey;
+};
+
+}
+
+MeshCacheStats meshCacheStats(std::span<const unsigned int> indices, unsigned int vertexCount, unsigned int cacheSize)
+{
+    MeshCacheStats stats;
+    if(indices.size() < 3)
+    {
+        return stats;
+    }
+
+    detail::FifoCache cache(vertexCount, cacheSize);
+    std::vector<bool> referenced(vertexCount, false);
+    unsigned int misses = 0, unique = 0;
+    for(size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        misses += cache.triangle(&indices[i]);
+        for(int j = 0; j < 3; j++)
+        {
+            unique += !referenced[indices[i + j]];
+            referenced[indices[i + j]] = true;
+        }
+    }
+
+    stats.acmr = float(misses) / float(indices.size() / 3);
+    stats.atvr = float(misses) / float(unique);
+    return stats;
+}
+
+void meshWeld(std::vector<Vertex>& vertices, std::span<unsigned int> indices)
+{
+    std::unordered_map<Vertex, unsigned int, detail::VertexHash, detail::VertexEqual> unique;
+    unique.reserve(vertices.size());
+
+    std::vector<unsigned int> remap(vertices.size());
+    std::vector<Vertex> welded;
+    for(size_t i = 0; i < vertices.size(); i++)
+    {
+        auto [it, inserted] = unique.try_emplace(vertices[i], welded.size());
+        if(inserted)
+        {
+            welded.push_back(vertices[i]);
+        }
+        remap[i] = it->second;
+    }
+
+    for(auto& index : indices)
+    {
+        index = remap[index];
+    }
+    vertices.swap(welded);
+}
+
+void meshOptimizeVertexCache(std::span<unsigned int> indices, unsigned int vertexCount)
+{
+    const unsigned int triangleCount = indices.size() / 3;
+    if(triangleCount == 0)
+    {
+        return;
+    }
+
+    /* triangles per vertex; emitted triangles are swapped behind the live ones, so live counts the remaining ones */
+    std::vector<unsigned int> live(vertexCount, 0);
+    for(unsigned int i = 0; i < triangleCount * 3; i++)
+    {
+        live[indices[i]]++;
+    }
+
+    std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+    for(unsigned int v = 0; v < vertexCount; v++)
+    {
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + live[v];
+    }
+
+    std::vector<unsigned int> adjacency(triangleCount * 3);
+    std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for(unsigned int i = 0; i < triangleCount * 3; i++)
+    {
+        adjacency[fill[indices[i]]++] = i / 3;
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for(unsigned int v = 0; v < vertexCount; v++)
+    {
+        vertexScore[v] = detail::forsythScore(-1, live[v]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    unsigned int best = 0;
+    for(unsigned int t = 0; t < triangleCount; t++)
+    {
+        triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+        best = triangleScore[t] > triangleScore[best] ? t : best;
+    }
+
+    std::vector<unsigned int> output;
+    output.reserve(triangleCount * 3);
+
+    unsigned int cache[detail::forsythCacheSize + 3];
+    unsigned int cacheCount = 0;
+    unsigned int restart = 0;
+
+    while(best != ~0u)
+    {
+        const unsigned int* corner = &indices[3 * best];
+        output.insert(output.end(), corner, corner + 3);
+        emitted[best] = true;
+
+        for(int i = 0; i < 3; i++)
+        {
+            unsigned int v = corner[i];
+            unsigned int* list = &adjacency[adjacencyOffset[v]];
+            unsigned int* it = std::find(list, list + live[v], best);
+            if(it != list + live[v])
+            {
+                std::swap(*it, list[--live[v]]);
+            }
+        }
+
+        /* LRU: the triangle goes to the front, the overflow drops out */
+        unsigned int next[detail::forsythCacheSize + 3];
+        unsigned int nextCount = 0;
+        for(int i = 0; i < 3; i++)
+        {
+            if(std::find(next, next + nextCount, corner[i]) == next + nextCount)
+            {
+                next[nextCount++] = corner[i];
+            }
+        }
+        for(unsigned int i = 0; i < cacheCount; i++)
+        {
+            if(std::find(next, next + nextCount, cache[i]) == next + nextCount)
+            {
+                next[nextCount++] = cache[i];
+            }
+        }
+
+        /* rescore the vertices whose position or valence changed, only their triangles change score */
+        for(unsigned int i = 0; i < nextCount; i++)
+        {
+            unsigned int v = next[i];
+            cachePosition[v] = i < detail::forsythCacheSize ? int(i) : -1;
+
+            float score = detail::forsythScore(cachePosition[v], live[v]);
+            float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            for(unsigned int j = 0; j < live[v]; j++)
+            {
+                triangleScore[adjacency[adjacencyOffset[v] + j]] += delta;
+            }
+        }
+
+        cacheCount = std::min(nextCount, detail::forsythCacheSize);
+        std::copy(next, next + cacheCount, cache);
+
+        /* next triangle: best one touching the cache, otherwise the first remaining one */
+        best = ~0u;
+        float bestScore = -1e30f;
+        for(unsigned int i = 0; i < cacheCount; i++)
+        {
+            unsigned int v = cache[i];
+            for(unsigned int j = 0; j < live[v]; j++)
+            {
+                unsigned int t = adjacency[adjacencyOffset[v] + j];
+                if(triangleScore[t] > bestScore)
+                {
+                    best = t;
+                    bestScore = triangleScore[t];
+                }
+            }
+        }
+
+        if(best == ~0u)
+        {
+            while(restart < triangleCount && emitted[restart])
+            {
+                restart++;
+            }
+            best = restart < triangleCount ? restart : ~0u;
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void meshOptimizeOverdraw(std::span<unsigned int> indices, std::span<const Vertex> vertices, float threshold)
+{
+    const unsigned int triangleCount = indices.size() / 3;
+    if(triangleCount < 2)
+    {
+        return;
+    }
+
+    /* hard boundaries: triangles that miss with all three vertices, the cache starts over there anyway */
+    detail::FifoCache cache(vertices.size(), 16);
+    std::vector<unsigned int> misses(triangleCount);
+    std::vector<unsigned int> hard;
+    for(unsigned int t = 0; t < triangleCount; t++)
+    {
+        misses[t] = cache.triangle(&indices[3 * t]);
+        if(t == 0 || misses[t] == 3)
+        {
+            hard.push_back(t);
+        }
+    }
+    hard.push_back(triangleCount);
+
+    /* soft boundaries: cut a hard cluster as soon as the part before the cut, simulated from a cold cache, is within
+     * threshold of the ACMR of the whole cluster */
+    std::vector<detail::OverdrawCluster> clusters;
+    for(size_t h = 0; h + 1 < hard.size(); h++)
+    {
+        unsigned int begin = hard[h], end = hard[h + 1];
+        unsigned int clusterMisses = 0;
+        for(unsigned int t = begin; t < end; t++)
+        {
+            clusterMisses += misses[t];
+        }
+        float clusterAcmr = float(clusterMisses) / float(end - begin);
+
+        cache.reset();
+        unsigned int first = begin, firstMisses = 0;
+        for(unsigned int t = begin; t < end; t++)
+        {
+            firstMisses += cache.triangle(&indices[3 * t]);
+            if(t + 1 == end || float(firstMisses) <= threshold * clusterAcmr * float(t + 1 - first))
+            {
+                clusters.push_back({first, t + 1 - first, 0.0f});
+                first = t + 1;
+                firstMisses = 0;
+                cache.reset();
+            }
+        }
+    }
+
+    /* area weighted centroid and normal per cluster, clusters whose surface points away from the mesh center are
+     * likely in front of the others from any view and are drawn first */
+    std::vector<Vector3D> centroid(clusters.size(), Vector3D(0.0f, 0.0f, 0.0f));
+    std::vector<Vector3D> normal(clusters.size(), Vector3D(0.0f, 0.0f, 0.0f));
+    Vector3D meshCentroid(0.0f, 0.0f, 0.0f);
+    float meshArea = 0.0f;
+    for(size_t c = 0; c < clusters.size(); c++)
+    {
+        float clusterArea = 0.0f;
+        for(unsigned int t = clusters[c].first; t < clusters[c].first + clusters[c].count; t++)
+        {
+            const Vector3D& p0 = vertices[indices[3 * t]].pos;
+            const Vector3D& p1 = vertices[indices[3 * t + 1]].pos;
+            const Vector3D& p2 = vertices[indices[3 * t + 2]].pos;
+            Vector3D n = cross(p1 - p0, p2 - p0);
+            float area = length(n);
+            centroid[c] += area * (p0 + p1 + p2);
+            normal[c] += n;
+            clusterArea += area;
+        }
+        meshCentroid += centroid[c];
+        meshArea += clusterArea;
+        centroid[c] = clusterArea > 0.0f ? (1.0f / (3.0f * clusterArea)) * centroid[c] : vertices[indices[3 * clusters[c].first]].pos;
+    }
+    meshCentroid = meshArea > 0.0f ? (1.0f / (3.0f * meshArea)) * meshCentroid : centroid[0];
+
+    for(size_t c = 0; c < clusters.size(); c++)
+    {
+        float normalLength = length(normal[c]);
+        clusters[c].sortKey = normalLength > 0.0f ? dot(centroid[c] - meshCentroid, normal[c]) / normalLength : 0.0f;
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](const auto& a, const auto& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    for(const auto& cluster : clusters)
+    {
+        output.insert(output.end(), indices.begin() + 3 * cluster.first, indices.begin() + 3 * (cluster.first + cluster.count));
+    }
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void meshOptimizeVertexFetch(std::vector<Vertex>& vertices, std::span<unsigned int> indices)
+{
+    std::vector<unsigned int> remap(vertices.size(), ~0u);
+    std::vector<Vertex> ordered;
+    ordered.reserve(vertices.size());
+    for(auto& index : indices)
+    {
+        if(remap[index] == ~0u)
+        {
+            remap[index] = ordered.size();
+            ordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(ordered);
+}
+
+MeshOptimizeStats meshOptimize(std::vector<Vertex>& vertices, std::span<unsigned int> indices, std::span<const Range> ranges)
+{
+    MeshOptimizeStats stats;
+    stats.inputVertices = vertices.size();
+    stats.triangles = indices.size() / 3;
+
+    meshWeld(vertices, indices);
+    stats.before = meshCacheStats(indices, vertices.size());
+
+    for(const auto& range : ranges)
+    {
+        std::span<unsigned int> part = indices.subspan(range.offset, range.count);
+        meshOptimizeVertexCache(part, vertices.size());
+        meshOptimizeOverdraw(part, vertices);
+    }
+
+    meshOptimizeVertexFetch(vertices, indices);
+    stats.outputVertices = vertices.size();
+    stats.after = meshCacheStats(indices, vertices.size());
+
+    return stats;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "mesh.h"
+#include "range_allocator.h"
+
+/* post-transform vertex cache efficiency of an index buffer, simulated with a FIFO cache */
+struct MeshCacheStats
+{
+    /* average cache miss ratio: transformed vertices per triangle, 3 without any reuse, about 0.6 for good grids */
+    float acmr = 0.0f;
+
+    /* average transform to vertex ratio: transformed vertices per referenced vertex, 1 is optimal */
+    float atvr = 0.0f;
+};
+
+/* result of meshOptimize: vertex count and cache efficiency of the welded mesh in input order and after optimizing */
+struct MeshOptimizeStats
+{
+    unsigned int inputVertices = 0;
+    unsigned int outputVertices = 0;
+    unsigned int triangles = 0;
+
+    MeshCacheStats before;
+    MeshCacheStats after;
+};
+
+/**
+ * @brief Simulate a FIFO post-transform cache for an indexed triangle list.
+ *
+ * @param indices Triangle list.
+ * @param vertexCount Number of vertices the indices refer to.
+ * @param cacheSize Cache entries, 16 to 32 are typical for current GPUs.
+ *
+ * @return ACMR and ATVR, the ATVR counts only referenced vertices.
+ */
+MeshCacheStats meshCacheStats(std::span<const unsigned int> indices, unsigned int vertexCount, unsigned int cacheSize = 16);
+
+/**
+ * @brief Merge bitwise identical vertices, e.g. the three corners per face an OBJ is expanded to.
+ *
+ * @param vertices Vertices, replaced by the unique vertices in order of first occurrence.
+ * @param indices Triangle list, remapped to the unique vertices.
+ */
+void meshWeld(std::vector<Vertex>& vertices, std::span<unsigned int> indices);
+
+/**
+ * @brief Reorder triangles for the post-transform vertex cache with Forsyth's linear-speed algorithm: triangles are
+ * emitted greedily by the score of their vertices in a simulated 32 entry LRU cache, favouring recently used vertices
+ * and vertices with few remaining triangles.
+ *
+ * @param indices Triangle list, reordered in place, the triangles themselves are kept.
+ * @param vertexCount Number of vertices the indices refer to.
+ */
+void meshOptimizeVertexCache(std::span<unsigned int> indices, unsigned int vertexCount);
+
+/**
+ * @brief Reorder cache optimized triangles to reduce overdraw (Sander et al., "Fast Triangle Reordering for Vertex
+ * Locality and Reduced Overdraw"). The triangle list is cut into clusters where the vertex cache starts over anyway, or
+ * where the cut costs less than threshold in ACMR, and the clusters are sorted so the ones facing outwards from the
+ * mesh center come first and occlude the rest.
+ *
+ * @param indices Triangle list after meshOptimizeVertexCache, reordered in place.
+ * @param vertices Vertices the indices refer to.
+ * @param threshold Allowed ACMR growth, 1.05 accepts 5% more vertex transformations.
+ */
+void meshOptimizeOverdraw(std::span<unsigned int> indices, std::span<const Vertex> vertices, float threshold = 1.05f);
+
+/**
+ * @brief Reorder the vertices by first use in the index buffer so the vertex fetch walks memory linearly, unreferenced
+ * vertices are dropped.
+ *
+ * @param vertices Vertices, reordered and shrunk.
+ * @param indices Triangle list, remapped to the new order.
+ */
+void meshOptimizeVertexFetch(std::vector<Vertex>& vertices, std::span<unsigned int> indices);
+
+/**
+ * @brief Run the whole pipeline on a mesh: weld, vertex cache and overdraw order per range, then vertex fetch order.
+ * Triangles never move between ranges, so index ranges of materials stay valid.
+ *
+ * @param vertices Vertices, welded and reordered.
+ * @param indices Triangle list, reordered in place.
+ * @param ranges Index ranges that are optimized independently, they have to hold whole triangles.
+ *
+ * @return Vertex counts and cache efficiency before (welded, input order) and after.
+ */
+MeshOptimizeStats meshOptimize(std::vector<Vertex>& vertices, std::span<unsigned int> indices, std::span<const Range> ranges);
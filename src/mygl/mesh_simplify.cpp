@@ -0,0 +1,461 @@
+#include "mesh_simplify.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace detail
+{
+
+/* symmetric plane quadric: sum of w * (n * p + d)^2 over the accumulated planes, w being the total weight */
+struct Quadric
+{
+    double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+    double c = 0.0;
+    double w = 0.0;
+
+    Quadric& operator +=(const Quadric& q)
+    {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+        b0 += q.b0; b1 += q.b1; b2 += q.b2;
+        c += q.c;
+        w += q.w;
+        return *this;
+    }
+};
+
+void quadricAddPlane(Quadric& q, const Vector3D& n, float d, float weight)
+{
+    q.a00 += weight * n.x * n.x; q.a01 += weight * n.x * n.y; q.a02 += weight * n.x * n.z;
+    q.a11 += weight * n.y * n.y; q.a12 += weight * n.y * n.z; q.a22 += weight * n.z * n.z;
+    q.b0 += weight * n.x * d; q.b1 += weight * n.y * d; q.b2 += weight * n.z * d;
+    q.c += weight * d * d;
+    q.w += weight;
+}
+
+/* weighted mean squared distance of p to the planes */
+double quadricError(const Quadric& q, const Vector3D& p)
+{
+    double x = p.x, y = p.y, z = p.z;
+    double r = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z + 2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z)
+             + 2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+    return q.w > 0.0 ? std::abs(r) / q.w : 0.0;
+}
+
+/* what a position may do: collapse onto any neighbour, only along its border, or not at all */
+enum eSimplifyKind : uint8_t
+{
+    SIMPLIFY_INTERIOR,
+    SIMPLIFY_BORDER,
+    SIMPLIFY_LOCKED
+};
+
+/* open borders are kept with planes through the border edges orthogonal to their triangle, weighted this much more */
+constexpr float simplifyBorderWeight = 10.0f;
+
+uint64_t simplifyEdgeKey(unsigned int a, unsigned int b)
+{
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+struct SimplifyEdge
+{
+    unsigned int count = 0;
+    unsigned int range = 0;
+    bool multiRange = false;
+};
+
+/* collapse of all vertices at position group from onto the vertices at group to */
+struct SimplifyCollapse
+{
+    unsigned int from;
+    unsigned int to;
+    double cost;
+};
+
+}
+
+MeshSimplifyResult meshSimplify(std::span<const Vertex> vertices, std::span<const unsigned int> indices, std::span<const Range> ranges, unsigned int targetTriangles)
+{
+    const unsigned int vertexCount = vertices.size();
+
+    /* triangles with their range, in range order */
+    std::vector<unsigned int> current;
+    std::vector<unsigned int> triangleRange;
+    std::vector<unsigned int> rangeTriangles(ranges.size());
+    for(unsigned int r = 0; r < ranges.size(); r++)
+    {
+        current.insert(current.end(), indices.begin() + ranges[r].offset, indices.begin() + ranges[r].offset + ranges[r].count);
+        triangleRange.insert(triangleRange.end(), ranges[r].count / 3, r);
+        rangeTriangles[r] = ranges[r].count / 3;
+    }
+
+    /* Vertices of one position (wedges: hard edges, uv seams) form a group. Topology and error are tracked on groups,
+     * a collapse moves every wedge of a group onto the wedge of the target group it shares a triangle with, so seams
+     * only collapse along themselves and keep their attributes on both sides. */
+    std::vector<bool> referenced(vertexCount, false);
+    for(unsigned int index : current)
+    {
+        referenced[index] = true;
+    }
+
+    std::vector<unsigned int> wedges;
+    for(unsigned int v = 0; v < vertexCount; v++)
+    {
+        if(referenced[v])
+        {
+            wedges.push_back(v);
+        }
+    }
+    auto positionLess = [&](unsigned int a, unsigned int b)
+    {
+        return std::memcmp(&vertices[a].pos, &vertices[b].pos, sizeof(Vector3D)) < 0;
+    };
+    std::sort(wedges.begin(), wedges.end(), positionLess);
+
+    std::vector<unsigned int> group(vertexCount, ~0u);
+    std::vector<unsigned int> groupStart;
+    for(size_t i = 0; i < wedges.size(); i++)
+    {
+        if(i == 0 || positionLess(wedges[i - 1], wedges[i]))
+        {
+            groupStart.push_back(i);
+        }
+        group[wedges[i]] = groupStart.size() - 1;
+    }
+    const unsigned int groupCount = groupStart.size();
+    groupStart.push_back(wedges.size());
+
+    /* triangles with two corners on one position have no area and only get in the way */
+    size_t kept = 0;
+    for(size_t t = 0; t < current.size() / 3; t++)
+    {
+        unsigned int a = current[3 * t], b = current[3 * t + 1], c = current[3 * t + 2];
+        if(group[a] == group[b] || group[b] == group[c] || group[a] == group[c])
+        {
+            rangeTriangles[triangleRange[t]]--;
+            continue;
+        }
+        std::copy(&current[3 * t], &current[3 * t + 3], &current[3 * kept]);
+        triangleRange[kept++] = triangleRange[t];
+    }
+    current.resize(3 * kept);
+    triangleRange.resize(kept);
+
+    /* edges between positions and quadrics of the triangle planes per position */
+    std::unordered_map<uint64_t, detail::SimplifyEdge> positionEdges;
+    std::vector<detail::Quadric> quadric(groupCount);
+    for(size_t t = 0; t < current.size() / 3; t++)
+    {
+        const unsigned int* corner = &current[3 * t];
+        Vector3D p0 = vertices[corner[0]].pos, p1 = vertices[corner[1]].pos, p2 = vertices[corner[2]].pos;
+        Vector3D n = cross(p1 - p0, p2 - p0);
+        float area = length(n);
+        if(area > 0.0f)
+        {
+            n = n / area;
+            for(int i = 0; i < 3; i++)
+            {
+                detail::quadricAddPlane(quadric[group[corner[i]]], n, -dot(n, p0), 0.5f * area);
+            }
+        }
+
+        for(int i = 0; i < 3; i++)
+        {
+            auto& edge = positionEdges[detail::simplifyEdgeKey(group[corner[i]], group[corner[(i + 1) % 3]])];
+            edge.multiRange |= edge.count > 0 && edge.range != triangleRange[t];
+            edge.range = triangleRange[t];
+            edge.count++;
+        }
+    }
+
+    /* edges between ranges and non manifold edges lock their positions, open borders keep theirs with planes through
+     * the border edges orthogonal to their triangle */
+    std::vector<unsigned int> borderEdges(groupCount, 0);
+    std::vector<bool> locked(groupCount, false);
+    for(const auto& [key, edge] : positionEdges)
+    {
+        unsigned int a = key >> 32, b = key & 0xffffffffu;
+        if(edge.count > 2 || edge.multiRange)
+        {
+            locked[a] = locked[b] = true;
+        }
+        else if(edge.count == 1)
+        {
+            borderEdges[a]++;
+            borderEdges[b]++;
+        }
+    }
+
+    std::vector<detail::eSimplifyKind> kind(groupCount);
+    for(unsigned int g = 0; g < groupCount; g++)
+    {
+        if(locked[g] || (borderEdges[g] > 0 && borderEdges[g] != 2))
+        {
+            kind[g] = detail::SIMPLIFY_LOCKED;
+        }
+        else
+        {
+            kind[g] = borderEdges[g] > 0 ? detail::SIMPLIFY_BORDER : detail::SIMPLIFY_INTERIOR;
+        }
+    }
+
+    for(size_t t = 0; t < current.size() / 3; t++)
+    {
+        const unsigned int* corner = &current[3 * t];
+        Vector3D p0 = vertices[corner[0]].pos, p1 = vertices[corner[1]].pos, p2 = vertices[corner[2]].pos;
+        Vector3D n = cross(p1 - p0, p2 - p0);
+        for(int i = 0; i < 3; i++)
+        {
+            unsigned int a = corner[i], b = corner[(i + 1) % 3];
+            if(positionEdges[detail::simplifyEdgeKey(group[a], group[b])].count != 1)
+            {
+                continue;
+            }
+
+            Vector3D edge = vertices[b].pos - vertices[a].pos;
+            Vector3D plane = cross(edge, n);
+            float planeLength = length(plane);
+            if(planeLength > 0.0f)
+            {
+                plane = plane / planeLength;
+                float weight = detail::simplifyBorderWeight * dot(edge, edge);
+                detail::quadricAddPlane(quadric[group[a]], plane, -dot(plane, vertices[a].pos), weight);
+                detail::quadricAddPlane(quadric[group[b]], plane, -dot(plane, vertices[a].pos), weight);
+            }
+        }
+    }
+
+    double maxCost = 0.0;
+    std::vector<unsigned int> remap(vertexCount);
+    std::vector<unsigned int> adjacencyOffset(vertexCount + 1);
+    std::vector<unsigned int> adjacency;
+    std::unordered_map<uint64_t, unsigned int> edgeCount;
+    std::vector<detail::SimplifyCollapse> collapses;
+    std::vector<bool> touched(groupCount);
+    std::vector<unsigned int> removedPerRange(ranges.size());
+
+    /* wedge of group to that shares a current triangle with wedge from */
+    auto wedgeTarget = [&](unsigned int from, unsigned int to) -> unsigned int
+    {
+        for(unsigned int j = adjacencyOffset[from]; j < adjacencyOffset[from + 1]; j++)
+        {
+            const unsigned int* corner = &current[3 * adjacency[j]];
+            for(int k = 0; k < 3; k++)
+            {
+                if(group[corner[k]] == to)
+                {
+                    return corner[k];
+                }
+            }
+        }
+        return ~0u;
+    };
+
+    auto collapseValid = [&](unsigned int from, unsigned int to)
+    {
+        if(kind[from] == detail::SIMPLIFY_LOCKED ||
+           (kind[from] == detail::SIMPLIFY_BORDER && (kind[to] == detail::SIMPLIFY_INTERIOR || edgeCount[detail::simplifyEdgeKey(from, to)] != 1)))
+        {
+            return false;
+        }
+
+        for(unsigned int i = groupStart[from]; i < groupStart[from + 1]; i++)
+        {
+            unsigned int wedge = wedges[i];
+            if(adjacencyOffset[wedge] != adjacencyOffset[wedge + 1] && wedgeTarget(wedge, to) == ~0u)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    /* the triangles of a moved wedge must not flip */
+    auto flips = [&](unsigned int wedge, const Vector3D& target, unsigned int to)
+    {
+        for(unsigned int j = adjacencyOffset[wedge]; j < adjacencyOffset[wedge + 1]; j++)
+        {
+            const unsigned int* corner = &current[3 * adjacency[j]];
+            if(group[corner[0]] == to || group[corner[1]] == to || group[corner[2]] == to)
+            {
+                continue;
+            }
+
+            Vector3D p[3] = {vertices[corner[0]].pos, vertices[corner[1]].pos, vertices[corner[2]].pos};
+            Vector3D before = cross(p[1] - p[0], p[2] - p[0]);
+            for(int k = 0; k < 3; k++)
+            {
+                p[k] = corner[k] == wedge ? target : p[k];
+            }
+            Vector3D after = cross(p[1] - p[0], p[2] - p[0]);
+            if(dot(before, after) <= 0.25f * length(before) * length(after))
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    while(current.size() / 3 > targetTriangles)
+    {
+        /* triangles around every vertex and triangles per position edge */
+        std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+        for(unsigned int index : current)
+        {
+            adjacencyOffset[index + 1]++;
+        }
+        for(unsigned int v = 0; v < vertexCount; v++)
+        {
+            adjacencyOffset[v + 1] += adjacencyOffset[v];
+        }
+        adjacency.resize(current.size());
+        std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for(unsigned int i = 0; i < current.size(); i++)
+        {
+            adjacency[fill[current[i]]++] = i / 3;
+        }
+
+        edgeCount.clear();
+        for(unsigned int i = 0; i < current.size(); i++)
+        {
+            edgeCount[detail::simplifyEdgeKey(group[current[i]], group[current[i - i % 3 + (i + 1) % 3]])]++;
+        }
+
+        /* cheaper valid direction of every edge */
+        collapses.clear();
+        for(const auto& [key, count] : edgeCount)
+        {
+            unsigned int a = key >> 32, b = key & 0xffffffffu;
+            detail::Quadric q = quadric[a];
+            q += quadric[b];
+
+            const Vector3D& pa = vertices[wedges[groupStart[a]]].pos;
+            const Vector3D& pb = vertices[wedges[groupStart[b]]].pos;
+            double costAB = collapseValid(a, b) ? detail::quadricError(q, pb) : -1.0;
+            double costBA = collapseValid(b, a) ? detail::quadricError(q, pa) : -1.0;
+            if(costAB >= 0.0 && (costBA < 0.0 || costAB <= costBA))
+            {
+                collapses.push_back({a, b, costAB});
+            }
+            else if(costBA >= 0.0)
+            {
+                collapses.push_back({b, a, costBA});
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const auto& x, const auto& y)
+        {
+            return x.cost < y.cost || (x.cost == y.cost && (x.from < y.from || (x.from == y.from && x.to < y.to)));
+        });
+
+        /* independent collapses, cheapest first; collapses next to an earlier one of the pass wait for the next pass */
+        for(unsigned int v = 0; v < vertexCount; v++)
+        {
+            remap[v] = v;
+        }
+        std::fill(touched.begin(), touched.end(), false);
+        unsigned int removed = 0, applied = 0;
+        const unsigned int needed = current.size() / 3 - targetTriangles;
+        for(const auto& collapse : collapses)
+        {
+            if(removed >= needed)
+            {
+                break;
+            }
+            if(touched[collapse.from] || touched[collapse.to])
+            {
+                continue;
+            }
+
+            const Vector3D& target = vertices[wedges[groupStart[collapse.to]]].pos;
+            bool valid = true;
+            std::fill(removedPerRange.begin(), removedPerRange.end(), 0);
+            for(unsigned int i = groupStart[collapse.from]; i < groupStart[collapse.from + 1] && valid; i++)
+            {
+                unsigned int wedge = wedges[i];
+                valid = !flips(wedge, target, collapse.to);
+                for(unsigned int j = adjacencyOffset[wedge]; j < adjacencyOffset[wedge + 1]; j++)
+                {
+                    const unsigned int* corner = &current[3 * adjacency[j]];
+                    if(group[corner[0]] == collapse.to || group[corner[1]] == collapse.to || group[corner[2]] == collapse.to)
+                    {
+                        removedPerRange[triangleRange[adjacency[j]]]++;
+                    }
+                }
+            }
+
+            /* small parts, e.g. a window, may shrink but a range never disappears */
+            for(size_t r = 0; r < ranges.size() && valid; r++)
+            {
+                valid = removedPerRange[r] < rangeTriangles[r];
+            }
+            if(!valid)
+            {
+                continue;
+            }
+
+            for(unsigned int i = groupStart[collapse.from]; i < groupStart[collapse.from + 1]; i++)
+            {
+                unsigned int wedge = wedges[i];
+                for(unsigned int j = adjacencyOffset[wedge]; j < adjacencyOffset[wedge + 1]; j++)
+                {
+                    const unsigned int* corner = &current[3 * adjacency[j]];
+                    touched[group[corner[0]]] = touched[group[corner[1]]] = touched[group[corner[2]]] = true;
+                }
+                if(adjacencyOffset[wedge] != adjacencyOffset[wedge + 1])
+                {
+                    remap[wedge] = wedgeTarget(wedge, collapse.to);
+                }
+            }
+            for(size_t r = 0; r < ranges.size(); r++)
+            {
+                rangeTriangles[r] -= removedPerRange[r];
+                removed += removedPerRange[r];
+            }
+
+            quadric[collapse.to] += quadric[collapse.from];
+            maxCost = std::max(maxCost, collapse.cost);
+            applied++;
+        }
+
+        if(applied == 0)
+        {
+            break;
+        }
+
+        /* drop the triangles that collapsed to a line */
+        kept = 0;
+        for(size_t t = 0; t < current.size() / 3; t++)
+        {
+            unsigned int a = remap[current[3 * t]], b = remap[current[3 * t + 1]], c = remap[current[3 * t + 2]];
+            if(group[a] == group[b] || group[b] == group[c] || group[a] == group[c])
+            {
+                continue;
+            }
+            current[3 * kept] = a;
+            current[3 * kept + 1] = b;
+            current[3 * kept + 2] = c;
+            triangleRange[kept] = triangleRange[t];
+            kept++;
+        }
+        current.resize(3 * kept);
+        triangleRange.resize(kept);
+    }
+
+    MeshSimplifyResult result;
+    result.indices = std::move(current);
+    result.ranges.resize(ranges.size());
+    for(size_t t = 0; t < triangleRange.size(); t++)
+    {
+        result.ranges[triangleRange[t]].count += 3;
+    }
+    for(size_t r = 1; r < ranges.size(); r++)
+    {
+        result.ranges[r].offset = result.ranges[r - 1].offset + result.ranges[r - 1].count;
+    }
+    result.error = float(std::sqrt(maxCost));
+
+    return result;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "mesh.h"
+#include "range_allocator.h"
+
+/* simplified triangle list over the unchanged vertex buffer */
+struct MeshSimplifyResult
+{
+    std::vector<unsigned int> indices;
+
+    /* one range per input range, in the same order */
+    std::vector<Range> ranges;
+
+    /* square root of the largest collapse cost: the area weighted RMS distance of a moved position to the planes of
+     * the triangles it stood for, in model units */
+    float error = 0.0f;
+};
+
+/**
+ * @brief Simplify a welded triangle list with quadric error edge collapses (Garland and Heckbert). Collapses are half
+ * edge collapses onto an existing vertex, so the result indexes the same vertex buffer and LODs can share it.
+ *
+ * Vertices of the same position with different normal or uv (hard edges, uv seams) collapse together, each onto the
+ * vertex of the target position on its side of the seam, so seams only collapse along themselves. Vertices on open
+ * borders only collapse along the border. Vertices on edges between two ranges or on non manifold edges never move,
+ * so ranges, e.g. materials, stay closed against each other at every level, and no range becomes empty.
+ *
+ * @param vertices Vertex buffer, usually after meshWeld.
+ * @param indices Triangle list.
+ * @param ranges Index ranges, triangles never move between them.
+ * @param targetTriangles Triangle count to reach; locked vertices can leave more.
+ *
+ * @return Simplified triangle list with its ranges and error.
+ */
+MeshSimplifyResult meshSimplify(std::span<const Vertex> vertices, std::span<const unsigned int> indices, std::span<const Range> ranges, unsigned int targetTriangles);
@@ -1,7 +1,9 @@
 #include "model.h"
+#include "asset_pack.h"
+#include "vertex_pack.h"
+#include "profiler.h"
 
-#include <cassert>
-#include <fstream>
+#include <algorithm>
 #include <map>
 #include <sstream>
 #include <iostream>
@@ -10,72 +12,33 @@
 namespace detail
 {
 
-void tokenize(std::string const &str, const char delim, std::vector<std::string> &out)
+/* bounds of the vertices referenced by a range of the index list */
+Bounds indexBounds(std::span<const Vertex> vertices, std::span<const unsigned int> indices, size_t offset, size_t count)
 {
-    size_t start;
-    size_t end = 0;
-
-    while( (start = str.find_first_not_of(delim, end)) != std::string::npos )
+    std::vector<Vector3D> positions(count);
+    for(size_t i = 0; i < count; i++)
     {
-        end = str.find(delim, start);
-        out.push_back(str.substr(start, end - start));
+        positions[i] = vertices[indices[offset + i]].pos;
     }
+    return boundsCreate(positions.data(), count);
 }
-
-struct Index
+/* mesh of one object: own buffers, float vertices in the arena, or packed vertices on the grid of the object bounds */
+Mesh modelMesh(std::span<const Vertex> vertices, std::span<const unsigned int> indices, const Bounds& bounds, MeshArena* arena, bool packed)
 {
-    enum eType
-    {
-        V = 1,
-        VN = 2,
-        VT = 4,
-
-        V_VN = V | VN,
-        V_VT_VN = V | VN | VT
-    };
-
-    eType type = V;
-    unsigned int v = 0;
-    unsigned int vt = 0;
-    unsigned int vn = 0;
-
-    friend std::stringstream& operator >>(std::stringstream& in, Index& index)
+    if(arena && packed)
     {
-        std::string data;
-        in >> data;
-
-        std::vector<std::string> tokens;
-        tokenize(data, '/', tokens);
-
-        if(tokens.empty())
-        {
-            return in;
-        }
-
-        index.v = std::stoi( tokens[0] );
-
-        if(tokens.size() == 2)
-        {
-            index.vn = std::stoi( tokens[1] );
-            index.type = V_VN;
-        }
-        else if(tokens.size() == 3)
-        {
-            index.vt = std::stoi( tokens[1] );
-            index.vn = std::stoi( tokens[2] );
-            index.type = V_VT_VN;
-        }
-
-        return in;
+        return meshCreatePacked(*arena, vertices, indices, vertexQuantization(bounds));
     }
-};
-
+    return arena ? meshCreate(*arena, vertices, indices) : meshCreate(vertices, indices);
+}
 }
 
-std::map<std::string, Material> materialLoad(const std::string &filepath)
+std::map<std::string, Material> materialLoad(const std::string &filepath, JobSystem* jobs)
 {
-    std::ifstream materialFile(filepath);
-    if(!materialFile.is_open())
+    PROFILE_ZONE("materialLoad");
+
+    AssetData materialFile;
+    if(!assetRead(filepath, materialFile))
     {
         throw std::runtime_error("[Model] Couldn't open OBJ file at " + filepath);
     }
@@ -83,9 +46,14 @@ std::map<std::string, Material> materialLoad(const std::string &filepath)
     std::map<std::string, Material> materials;
     Material* current = nullptr;
 
+    /* texture slots by image path, filled once the file is parsed; map nodes don't move, so the slots stay valid */
+    std::string directory = filepath.substr(0, filepath.find_last_of("\\/")) + "/";
+    std::map<std::string, std::vector<Texture*>> textures;
+
     /* consume material commands */
+    std::stringstream lines(std::string(reinterpret_cast<const char*>(materialFile.data), materialFile.size));
     std::string line;
-    while(std::getline(materialFile, line))
+    while(std::getline(lines, line))
     {
         std::stringstream ss(line);
 
@@ -130,166 +98,140 @@ std::map<std::string, Material> materialLoad(const std::string &filepath)
         {
             std::string texture_path;
             ss  >> texture_path;
-            current->map_diffuse = textureLoad(filepath.substr(0, filepath.find_last_of("\\/")) + "/" + texture_path);
+            textures[directory + texture_path].push_back(&current->map_diffuse);
         }
         /* specular map */
         else if(code == "map_Ks" && current)
         {
             std::string texture_path;
             ss  >> texture_path;
-            current->map_specular = textureLoad(filepath.substr(0, filepath.find_last_of("\\/")) + "/" + texture_path);
+            textures[directory + texture_path].push_back(&current->map_specular);
         }
         /* normal map */
         else if(code == "map_bump" && current)
         {
             std::string texture_path;
             ss  >> texture_path;
-            current->map_normal = textureLoad(filepath.substr(0, filepath.find_last_of("\\/")) + "/" + texture_path);
+            textures[directory + texture_path].push_back(&current->map_normal);
         }
         /* ambient occlusion map */
         else if(code == "map_Ka" && current)
         {
             std::string texture_path;
             ss  >> texture_path;
-            current->map_ambient = textureLoad(filepath.substr(0, filepath.find_last_of("\\/")) + "/" + texture_path);
+            textures[directory + texture_path].push_back(&current->map_ambient);
         }
     }
 
-    return materials;
-}
-
-std::vector<Model> modelLoad(const std::string &filepath)
-{
-    std::ifstream objFile(filepath);
-    if(!objFile.is_open())
+    /* every image is decoded once as a job and uploaded by this thread as soon as it is ready, one texture per slot */
+    std::vector<TextureImage> images(textures.size());
+    std::vector<JobHandle> uploads;
+    size_t i = 0;
+    for(const auto& [path, slots] : textures)
     {
-        throw std::runtime_error("[Model] Couldn't open OBJ file at " + filepath);
+        TextureImage& image = images[i++];
+        JobHandle decode = jobSubmit(jobs, [&image, &path]{ image = textureImageLoad(path); });
+        uploads.push_back(jobSubmit(jobs, [&image, &slots]
+        {
+            for(Texture* slot : slots)
+            {
+                *slot = textureCreate(image);
+            }
+            textureImageFree(image);
+        }, {decode}, JOB_MAIN));
     }
 
-    /* container for GL related stuff */
-    std::vector<Model> models;
-    std::vector<Vertex> glVertices;
-    std::vector<unsigned int> glIndices;
-
-    /* container for OBJ related stuff */
-    std::map<std::string, Material> materials;
-    std::vector<Vector3D> vertices;
-    std::vector<Vector3D> normals;
-    std::vector<Vector2D> uvs;
-
-
-    /* consume commonds from obj file */
-    std::string line;
-    while(std::getline(objFile, line))
+    try
     {
-        std::stringstream ss(line);
-
-        /* command code */
-        std::string code;
-        ss >> code;
-
-        if(code == "")
-        {
-            continue;
-        }
-        /* create new object */
-        else if(code == "o")
+        jobWait(jobs, uploads);
+    }
+    catch(...)
+    {
+        /* all jobs finished, the uploads that ran before the failure left textures in their slots */
+        for(const auto& [path, slots] : textures)
         {
-            if(!models.empty())
+            for(Texture* slot : slots)
             {
-                Model& model = models.back();
-                model.mesh = meshCreate(glVertices, glIndices);
-
-                if(!model.material.empty())
+                if(slot->id != 0)
                 {
-                    auto& material = model.material.back();
-                    material.indexCount = glVertices.size() - material.indexOffset;
+                    textureDelete(*slot);
                 }
-
-                glVertices.clear();
-                glIndices.clear();
             }
-
-            Model& model = models.emplace_back();
-            ss >> model.name;
         }
-        /* vertex postion */
-        else if(code == "v")
+        for(auto& image : images)
         {
-            auto& v = vertices.emplace_back();
-            ss >> v.x >> v.y >> v.z;
+            textureImageFree(image);
         }
-        /* vertex texture coordinates */
-        else if(code == "vt")
-        {
-            auto& vt = uvs.emplace_back();
-            ss >> vt.x >> vt.y;
-        }
-        /* vertex normal */
-        else if(code == "vn")
-        {
-            auto& vn = normals.emplace_back();
-            ss >> vn.x >> vn.y >> vn.z;
-        }
-        /* face definition (currently only triangles) */
-        else if(code == "f")
-        {
-            detail::Index _idx[3];
-            ss >> _idx[0] >> _idx[1] >> _idx[2];
+        throw;
+    }
 
-            for(int i = 0; i < 3; i++)
-            {
-                glIndices.emplace_back(glVertices.size());
+    return materials;
+}
 
-                Vertex& vertex = glVertices.emplace_back();
-                vertex.pos = vertices[_idx[i].v - 1];
+std::vector<Model> modelLoad(const std::string &filepath, const ModelLoadOptions& options)
+{
+    PROFILE_ZONE("modelLoad");
 
-                if(_idx[i].type == detail::Index::V_VN)
-                {
-                    vertex.normal = normals[_idx[i].vn - 1];
-                }
-                else if(_idx[i].type == detail::Index::V_VT_VN)
-                {
-                    vertex.normal = normals[_idx[i].vn - 1];
-                    vertex.uv = uvs[_idx[i].vt - 1];
-                }
-            }
-        }
-        /* load material file (path in respect to .obj file) */
-        else if(code == "mtllib")
-        {
-            std::string file;
-            ss >> file;
-            materials = materialLoad( filepath.substr(0, filepath.find_last_of("\\/")) + "/" + file );
-        }
-        /* switch to material for next face definitions */
-        else if(code == "usemtl")
-        {
-            auto& model = models.back();
-            std::string name;
-            ss >> name;
+    std::string mtllib;
+    std::vector<ModelGeometry> geometry = modelGeometryLoad(filepath, {.optimize = options.optimize, .lodCount = options.lodCount, .cache = options.cache}, mtllib);
+
+    /* load material file (path in respect to .obj file) */
+    std::map<std::string, Material> materials;
+    if(!mtllib.empty())
+    {
+        materials = materialLoad(filepath.substr(0, filepath.find_last_of("\\/")) + "/" + mtllib, options.jobs);
+    }
 
-            if(!model.material.empty())
+    std::vector<Model> models;
+    for(const auto& object : geometry)
+    {
+        std::span<const Vertex> vertices = modelGeometryVertices(object);
+        std::span<const unsigned int> indices = modelGeometryIndices(object);
+
+        Model& model = models.emplace_back();
+        model.name = object.name;
+        model.optimizeStats = object.optimizeStats;
+        model.lodCount = object.lodCount;
+        std::copy(object.lodError.begin(), object.lodError.end(), model.lodError);
+
+        for(size_t i = 0; i < object.materialName.size(); i++)
+        {
+            auto& material = model.material.emplace_back(materials[object.materialName[i]]);
+            for(unsigned int level = 0; level < model.lodCount; level++)
             {
-                auto& material = model.material.back();
-                material.indexCount = glVertices.size() - material.indexOffset;
+                material.lod[level] = object.lodRange[level * object.materialName.size() + i];
             }
+            material.indexOffset = material.lod[0].offset;
+            material.indexCount = material.lod[0].count;
 
-            auto& material = model.material.emplace_back( materials[name] );
-            material.indexOffset = glVertices.size();
+            /* the levels only drop vertices, so the bounds of level 0 hold for all of them */
+            material.bounds = detail::indexBounds(vertices, indices, material.indexOffset, material.indexCount);
         }
+
+        model.bounds = detail::indexBounds(vertices, indices, 0, indices.size());
+        model.mesh = detail::modelMesh(vertices, indices, model.bounds, options.arena, options.packed);
     }
 
-    /* finnish up last object */
-    Model& model = models.back();
-    model.mesh = meshCreate(glVertices, glIndices);
-    if(!model.material.empty())
+    return models;
+}
+
+unsigned int modelSelectLod(const Model& model, float screenRadius, float threshold)
+{
+    if(model.bounds.radius <= 0.0f)
     {
-        auto& material = model.material.back();
-        material.indexCount = glVertices.size() - material.indexOffset;
+        return 0;
     }
 
-    return models;
+    /* the error scales with the model on screen like the radius does */
+    float pixelsPerUnit = screenRadius / model.bounds.radius;
+    for(unsigned int level = model.lodCount - 1; level > 0; level--)
+    {
+        if(model.lodError[level] * pixelsPerUnit <= threshold)
+        {
+            return level;
+        }
+    }
+    return 0;
 }
 
 void modelDelete(std::vector<Model> &models)
@@ -1,8 +1,14 @@
 #pragma once
 
+#include "job_system.h"
 #include "mesh.h"
+#include "model_geometry.h"
 #include "texture.h"
 
+#include <math/bounds.h>
+
+#include <map>
+
 struct Material
 {
     std::string name;
@@ -19,6 +25,12 @@ struct Material
 
     unsigned int indexOffset;
     unsigned int indexCount;
+
+    /* index range per level of detail of the model, lod[0] is indexOffset/indexCount */
+    Range lod[MODEL_LOD_MAX];
+
+    /* model space bounds of the index range, for culling single parts */
+    Bounds bounds;
 };
 
 struct Model
@@ -26,8 +38,71 @@ struct Model
     Mesh mesh;
     std::string name;
     std::vector<Material> material;
+
+    /* model space bounds of the whole mesh */
+    Bounds bounds;
+
+    /* vertex cache efficiency before and after meshOptimize, zero when the model was loaded unoptimized */
+    MeshOptimizeStats optimizeStats;
+
+    /* levels of detail in the index buffer and their simplification error in model units */
+    unsigned int lodCount = 1;
+    float lodError[MODEL_LOD_MAX] = {};
+};
+
+/* how modelLoad prepares the meshes */
+struct ModelLoadOptions
+{
+    /* arena to allocate the meshes from, nullptr gives every model its own buffers */
+    MeshArena* arena = nullptr;
+
+    /* store the meshes as PackedVertex quantized to the model bounds, the arena needs that layout */
+    bool packed = false;
+
+    /* weld the vertices and reorder every material range with meshOptimize */
+    bool optimize = true;
+
+    /* levels of detail to generate with meshSimplify, at most MODEL_LOD_MAX; needs optimize for the shared vertices */
+    unsigned int lodCount = 1;
+
+    /* read and write the optimized geometry cache next to the OBJ file */
+    bool cache = true;
+
+    /* job system to decode the material textures with, see materialLoad */
+    JobSystem* jobs = nullptr;
 };
 
-std::vector<Model> modelLoad(const std::string &filepath);
+/**
+ * @brief Load all materials of an MTL file including their textures. Each image is decoded once as a job and uploaded
+ * by the calling thread as soon as it is decoded.
+ *
+ * @param filepath Path to the MTL file, texture paths are relative to it.
+ * @param jobs Job system created on the calling thread, nullptr decodes on the calling thread.
+ *
+ * @return Materials by name, without index ranges.
+ */
+std::map<std::string, Material> materialLoad(const std::string &filepath, JobSystem* jobs = nullptr);
+
+/**
+ * @brief Load all objects of an OBJ file, one model per object with its materials as index ranges.
+ *
+ * @param filepath Path to the OBJ file.
+ * @param options Mesh layout and processing, the geometry is prepared with modelGeometryLoad.
+ *
+ * @return Models in file order.
+ */
+std::vector<Model> modelLoad(const std::string &filepath, const ModelLoadOptions& options = {});
+
+/**
+ * @brief Coarsest level of detail whose simplification error stays below a threshold on screen.
+ *
+ * @param model Model with its levels of detail.
+ * @param screenRadius Projected radius of the model bounds in pixels, see cameraScreenRadius.
+ * @param threshold Allowed error in pixels, 0 always selects level 0.
+ *
+ * @return Level of detail.
+ */
+unsigned int modelSelectLod(const Model& model, float screenRadius, float threshold = 1.0f);
+
 void modelDelete(std::vector<Model>& models);
 void modelDelete(Model& model);
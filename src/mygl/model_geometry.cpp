@@ -0,0 +1,546 @@
+#include "model_geometry.h"
+#include "asset_pack.h"
+#include "mesh_simplify.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace detail
+{
+
+void tokenize(std::string const &str, const char delim, std::vector<std::string> &out)
+{
+    size_t start;
+    size_t end = 0;
+
+    while( (start = str.find_first_not_of(delim, end)) != std::string::npos )
+    {
+        end = str.find(delim, start);
+        out.push_back(str.substr(start, end - start));
+    }
+}
+
+struct Index
+{
+    enum eType
+    {
+        V = 1,
+        VN = 2,
+        VT = 4,
+
+        V_VN = V | VN,
+        V_VT_VN = V | VN | VT
+    };
+
+    eType type = V;
+    unsigned int v = 0;
+    unsigned int vt = 0;
+    unsigned int vn = 0;
+
+    friend std::stringstream& operator >>(std::stringstream& in, Index& index)
+    {
+        std::string data;
+        in >> data;
+
+        std::vector<std::string> tokens;
+        tokenize(data, '/', tokens);
+
+        if(tokens.empty())
+        {
+            return in;
+        }
+
+        index.v = std::stoi( tokens[0] );
+
+        if(tokens.size() == 2)
+        {
+            index.vn = std::stoi( tokens[1] );
+            index.type = V_VN;
+        }
+        else if(tokens.size() == 3)
+        {
+            index.vt = std::stoi( tokens[1] );
+            index.vn = std::stoi( tokens[2] );
+            index.type = V_VT_VN;
+        }
+
+        return in;
+    }
+};
+/* close the index range of the current material */
+void materialFinish(ModelGeometry& geometry)
+{
+    if(!geometry.materialRange.empty())
+    {
+        geometry.materialRange.back().count = geometry.indices.size() - geometry.materialRange.back().offset;
+    }
+}
+
+/* parse an OBJ file into unindexed geometry, every face corner is its own vertex */
+std::vector<ModelGeometry> objParse(const std::string& filepath, std::string& mtllib)
+{
+    std::ifstream objFile(filepath);
+    if(!objFile.is_open())
+    {
+        throw std::runtime_error("[Model] Couldn't open OBJ file at " + filepath);
+    }
+
+    std::vector<ModelGeometry> models;
+
+    /* container for OBJ related stuff */
+    std::vector<Vector3D> vertices;
+    std::vector<Vector3D> normals;
+    std::vector<Vector2D> uvs;
+
+    /* consume commonds from obj file */
+    std::string line;
+    while(std::getline(objFile, line))
+    {
+        std::stringstream ss(line);
+
+        /* command code */
+        std::string code;
+        ss >> code;
+
+        if(code == "")
+        {
+            continue;
+        }
+        /* create new object */
+        else if(code == "o")
+        {
+            if(!models.empty())
+            {
+                materialFinish(models.back());
+            }
+
+            ModelGeometry& model = models.emplace_back();
+            ss >> model.name;
+        }
+        /* vertex postion */
+        else if(code == "v")
+        {
+            auto& v = vertices.emplace_back();
+            ss >> v.x >> v.y >> v.z;
+        }
+        /* vertex texture coordinates */
+        else if(code == "vt")
+        {
+            auto& vt = uvs.emplace_back();
+            ss >> vt.x >> vt.y;
+        }
+        /* vertex normal */
+        else if(code == "vn")
+        {
+            auto& vn = normals.emplace_back();
+            ss >> vn.x >> vn.y >> vn.z;
+        }
+        /* face definition (currently only triangles) */
+        else if(code == "f")
+        {
+            auto& model = models.back();
+            detail::Index _idx[3];
+            ss >> _idx[0] >> _idx[1] >> _idx[2];
+
+            for(int i = 0; i < 3; i++)
+            {
+                model.indices.emplace_back(model.vertices.size());
+
+                Vertex& vertex = model.vertices.emplace_back();
+                vertex.pos = vertices[_idx[i].v - 1];
+
+                if(_idx[i].type == detail::Index::V_VN)
+                {
+                    vertex.normal = normals[_idx[i].vn - 1];
+                }
+                else if(_idx[i].type == detail::Index::V_VT_VN)
+                {
+                    vertex.normal = normals[_idx[i].vn - 1];
+                    vertex.uv = uvs[_idx[i].vt - 1];
+                }
+            }
+        }
+        /* material file, loaded once the geometry is done */
+        else if(code == "mtllib")
+        {
+            ss >> mtllib;
+        }
+        /* switch to material for next face definitions */
+        else if(code == "usemtl")
+        {
+            auto& model = models.back();
+            materialFinish(model);
+
+            model.materialName.emplace_back();
+            ss >> model.materialName.back();
+            model.materialRange.push_back({unsigned(model.indices.size()), 0});
+        }
+    }
+
+    /* finnish up last object */
+    if(!models.empty())
+    {
+        materialFinish(models.back());
+    }
+
+    return models;
+}
+
+/* append the simplified levels to the index buffer, each one with half the triangles of the one before */
+void modelLods(ModelGeometry& model, unsigned int lodCount)
+{
+    model.lodCount = 1;
+    model.lodRange = model.materialRange;
+    model.lodError.assign(1, 0.0f);
+
+    const unsigned int fullCount = model.indices.size();
+    unsigned int triangles = fullCount / 3;
+    for(unsigned int level = 1; level < std::min(lodCount, MODEL_LOD_MAX) && !model.materialRange.empty(); level++)
+    {
+        MeshSimplifyResult lod = meshSimplify(model.vertices, std::span(model.indices.data(), fullCount), model.materialRange, (fullCount / 3) >> level);
+        if(lod.indices.size() / 3 > 0.8f * triangles)
+        {
+            break;
+        }
+        triangles = lod.indices.size() / 3;
+
+        unsigned int base = model.indices.size();
+        for(auto& range : lod.ranges)
+        {
+            meshOptimizeVertexCache(std::span(lod.indices).subspan(range.offset, range.count), model.vertices.size());
+            model.lodRange.push_back({base + range.offset, range.count});
+        }
+        model.indices.insert(model.indices.end(), lod.indices.begin(), lod.indices.end());
+        model.lodError.push_back(lod.error);
+        model.lodCount++;
+    }
+}
+
+/* The optimized geometry is cached next to the OBJ file and reused while the OBJ keeps its size and modification time.
+ * Bump the version whenever the optimizer or the layout below changes. */
+constexpr uint32_t modelCacheMagic = 0x4d4f5043;
+constexpr uint32_t modelCacheVersion = 3;
+
+struct ModelCacheKey
+{
+    uint32_t magic = modelCacheMagic;
+    uint32_t version = modelCacheVersion;
+    uint32_t vertexSize = sizeof(Vertex);
+    uint32_t lodCount = 1;
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+};
+
+ModelCacheKey modelCacheKey(const std::string& filepath, unsigned int lodCount)
+{
+    ModelCacheKey key;
+    key.lodCount = lodCount;
+    std::error_code error;
+    key.sourceSize = std::filesystem::file_size(filepath, error);
+    key.sourceTime = std::filesystem::last_write_time(filepath, error).time_since_epoch().count();
+    return key;
+}
+
+struct ModelCacheWriter
+{
+    std::vector<uint8_t> out;
+
+    void write(const void* data, size_t size)
+    {
+        out.insert(out.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+    }
+
+    template<typename T>
+    void write(const T& value)
+    {
+        write(&value, sizeof(T));
+    }
+
+    /* arrays start aligned to their element relative to the start of the data, so a reader can point into it */
+    template<typename T>
+    void write(std::span<const T> values)
+    {
+        write(uint32_t(values.size()));
+        out.resize((out.size() + alignof(T) - 1) / alignof(T) * alignof(T), 0);
+        write(values.data(), values.size() * sizeof(T));
+    }
+
+    template<typename T>
+    void write(const std::vector<T>& values)
+    {
+        write(std::span<const T>(values));
+    }
+
+    void write(const std::string& value)
+    {
+        write(uint32_t(value.size()));
+        write(value.data(), value.size());
+    }
+};
+
+/* reads fail instead of allocating past the end of the data, so a truncated or foreign file is just a cache miss */
+struct ModelCacheReader
+{
+    const uint8_t* in = nullptr;
+    uint64_t remaining = 0;
+    const uint8_t* begin = nullptr;
+
+    bool align(size_t alignment)
+    {
+        uint64_t padding = (alignment - size_t(in - begin) % alignment) % alignment;
+        if(padding > remaining)
+        {
+            return false;
+        }
+        in += padding;
+        remaining -= padding;
+        return true;
+    }
+
+    bool read(void* data, uint64_t size)
+    {
+        if(size > remaining)
+        {
+            return false;
+        }
+        std::memcpy(data, in, size);
+        in += size;
+        remaining -= size;
+        return true;
+    }
+
+    template<typename T>
+    bool read(T& value)
+    {
+        return read(&value, sizeof(T));
+    }
+
+    template<typename T>
+    bool read(std::vector<T>& values)
+    {
+        uint32_t size;
+        if(!read(size) || !align(alignof(T)) || uint64_t(size) * sizeof(T) > remaining)
+        {
+            return false;
+        }
+        values.resize(size);
+        return read(values.data(), uint64_t(size) * sizeof(T));
+    }
+
+    /* the array in place, the data has to outlive the view */
+    template<typename T>
+    bool read(std::span<const T>& values)
+    {
+        uint32_t size;
+        if(!read(size) || !align(alignof(T)) || uint64_t(size) * sizeof(T) > remaining)
+        {
+            return false;
+        }
+        values = std::span<const T>(reinterpret_cast<const T*>(in), size);
+        in += uint64_t(size) * sizeof(T);
+        remaining -= uint64_t(size) * sizeof(T);
+        return true;
+    }
+
+    bool read(std::string& value)
+    {
+        uint32_t size;
+        if(!read(size) || size > remaining)
+        {
+            return false;
+        }
+        value.resize(size);
+        return read(value.data(), size);
+    }
+};
+
+std::vector<uint8_t> modelCacheSerialize(const ModelCacheKey& key, const std::string& mtllib, const std::vector<ModelGeometry>& models)
+{
+    ModelCacheWriter writer;
+    writer.write(key);
+    writer.write(mtllib);
+    writer.write(uint32_t(models.size()));
+    for(const auto& model : models)
+    {
+        writer.write(model.name);
+        writer.write(modelGeometryVertices(model));
+        writer.write(modelGeometryIndices(model));
+        writer.write(uint32_t(model.materialName.size()));
+        for(size_t i = 0; i < model.materialName.size(); i++)
+        {
+            writer.write(model.materialName[i]);
+            writer.write(model.materialRange[i]);
+        }
+        writer.write(model.optimizeStats);
+        writer.write(model.lodCount);
+        writer.write(model.lodRange);
+        writer.write(model.lodError);
+    }
+    return std::move(writer.out);
+}
+
+void modelCacheWrite(const std::string& path, const ModelCacheKey& key, const std::string& mtllib, const std::vector<ModelGeometry>& models)
+{
+    std::vector<uint8_t> data = modelCacheSerialize(key, mtllib, models);
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+    /* the cache is only an optimization, a read only asset folder simply leaves it out */
+    if(!out)
+    {
+        out.close();
+        std::filesystem::remove(path);
+    }
+}
+
+/* geometry of an asset pack (fromPack) has no source file to compare against, and its vertices and indices are served
+ * as views into the mapping; data has to be aligned to at least 4 bytes */
+bool modelCacheParse(const uint8_t* data, size_t size, ModelCacheKey key, bool fromPack, std::string& mtllib, std::vector<ModelGeometry>& models)
+{
+    ModelCacheReader reader{data, size, data};
+    ModelCacheKey cached;
+    if(!reader.read(cached))
+    {
+        return false;
+    }
+    if(fromPack)
+    {
+        key.sourceSize = cached.sourceSize;
+        key.sourceTime = cached.sourceTime;
+    }
+    if(std::memcmp(&cached, &key, sizeof(key)) != 0)
+    {
+        return false;
+    }
+
+    uint32_t count;
+    if(!reader.read(mtllib) || !reader.read(count))
+    {
+        return false;
+    }
+
+    models.clear();
+    for(uint32_t m = 0; m < count; m++)
+    {
+        ModelGeometry& model = models.emplace_back();
+        uint32_t materialCount;
+        if(!reader.read(model.name))
+        {
+            return false;
+        }
+        bool arrays = fromPack ? reader.read(model.vertexView) && reader.read(model.indexView) : reader.read(model.vertices) && reader.read(model.indices);
+        if(!arrays || !reader.read(materialCount))
+        {
+            return false;
+        }
+        size_t indexCount = modelGeometryIndices(model).size();
+
+        for(uint32_t i = 0; i < materialCount; i++)
+        {
+            Range range;
+            if(!reader.read(model.materialName.emplace_back()) || !reader.read(range) ||
+               uint64_t(range.offset) + range.count > indexCount)
+            {
+                return false;
+            }
+            model.materialRange.push_back(range);
+        }
+
+        if(!reader.read(model.optimizeStats) || !reader.read(model.lodCount) || !reader.read(model.lodRange) || !reader.read(model.lodError) ||
+           model.lodCount == 0 || model.lodCount > MODEL_LOD_MAX || model.lodError.size() != model.lodCount ||
+           model.lodRange.size() != model.lodCount * materialCount)
+        {
+            return false;
+        }
+
+        for(const auto& range : model.lodRange)
+        {
+            if(uint64_t(range.offset) + range.count > indexCount)
+            {
+                return false;
+            }
+        }
+    }
+
+    /* every index has to be in range, the buffers are uploaded as they are */
+    for(const auto& model : models)
+    {
+        size_t vertexCount = modelGeometryVertices(model).size();
+        for(unsigned int index : modelGeometryIndices(model))
+        {
+            if(index >= vertexCount)
+            {
+                return false;
+            }
+        }
+    }
+
+    return reader.remaining == 0;
+}
+
+bool modelCacheRead(const std::string& path, const ModelCacheKey& key, std::string& mtllib, std::vector<ModelGeometry>& models)
+{
+    AssetData data;
+    return assetRead(path, data) && modelCacheParse(data.data, data.size, key, false, mtllib, models);
+}
+
+}
+
+std::vector<ModelGeometry> modelGeometryLoad(const std::string& filepath, const ModelGeometryOptions& options, std::string& mtllib)
+{
+    std::vector<ModelGeometry> geometry;
+
+    /* a mounted asset pack holds the geometry as the cache would, optimized with MODEL_LOD_MAX levels; it is used in
+     * place, without a copy */
+    detail::ModelCacheKey key;
+    key.lodCount = options.lodCount;
+    const AssetEntry* packed = assetFind(filepath, ASSET_MESH);
+    if(options.optimize && packed && detail::modelCacheParse(assetEntryData(*packed), packed->size, key, true, mtllib, geometry))
+    {
+        return geometry;
+    }
+
+    std::string cachePath = filepath + ".meshcache";
+    key = detail::modelCacheKey(filepath, options.lodCount);
+    if(options.optimize && options.cache && detail::modelCacheRead(cachePath, key, mtllib, geometry))
+    {
+        return geometry;
+    }
+
+    geometry = detail::objParse(filepath, mtllib);
+    for(auto& model : geometry)
+    {
+        model.lodRange = model.materialRange;
+        model.lodError.assign(1, 0.0f);
+    }
+
+    if(options.optimize)
+    {
+        for(auto& model : geometry)
+        {
+            std::vector<Range> ranges = model.materialRange;
+            if(ranges.empty())
+            {
+                ranges.push_back({0, unsigned(model.indices.size())});
+            }
+            model.optimizeStats = meshOptimize(model.vertices, model.indices, ranges);
+            detail::modelLods(model, options.lodCount);
+        }
+
+        if(options.cache)
+        {
+            detail::modelCacheWrite(cachePath, key, mtllib, geometry);
+        }
+    }
+
+    return geometry;
+}
+
+std::vector<uint8_t> modelGeometrySerialize(const std::string& filepath, const std::vector<ModelGeometry>& geometry, const std::string& mtllib, unsigned int lodCount)
+{
+    return detail::modelCacheSerialize(detail::modelCacheKey(filepath, lodCount), mtllib, geometry);
+}
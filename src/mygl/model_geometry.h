@@ -0,0 +1,89 @@
+#pragma once
+
+#include "mesh.h"
+#include "mesh_optimize.h"
+
+#include <span>
+#include <string>
+#include <vector>
+
+/* levels of detail a model can have, level 0 is the full mesh */
+constexpr unsigned int MODEL_LOD_MAX = 4;
+
+/* one object of an OBJ file before its mesh is created, the materials are index ranges by name */
+struct ModelGeometry
+{
+    std::string name;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+
+    /* geometry of a mounted asset pack is not copied: vertices and indices stay empty and these point into the
+     * mapping, valid while the pack is mapped. Read both through modelGeometryVertices/modelGeometryIndices. */
+    std::span<const Vertex> vertexView;
+    std::span<const unsigned int> indexView;
+
+    std::vector<std::string> materialName;
+    std::vector<Range> materialRange;
+    MeshOptimizeStats optimizeStats;
+
+    /* material ranges of level l at [l * materialRange.size(), (l + 1) * materialRange.size()), level 0 included */
+    unsigned int lodCount = 1;
+    std::vector<Range> lodRange;
+    std::vector<float> lodError;
+};
+
+/**
+ * @brief Vertices of the geometry, owned or a view into the mounted asset pack.
+ */
+inline std::span<const Vertex> modelGeometryVertices(const ModelGeometry& geometry)
+{
+    return geometry.vertices.empty() ? geometry.vertexView : std::span<const Vertex>(geometry.vertices);
+}
+
+/**
+ * @brief Indices of the geometry, owned or a view into the mounted asset pack.
+ */
+inline std::span<const unsigned int> modelGeometryIndices(const ModelGeometry& geometry)
+{
+    return geometry.indices.empty() ? geometry.indexView : std::span<const unsigned int>(geometry.indices);
+}
+
+/* how modelGeometryLoad prepares the geometry */
+struct ModelGeometryOptions
+{
+    /* weld the vertices and reorder every material range with meshOptimize */
+    bool optimize = true;
+
+    /* levels of detail to generate with meshSimplify, at most MODEL_LOD_MAX; needs optimize for the shared vertices */
+    unsigned int lodCount = 1;
+
+    /* read and write <filepath>.meshcache */
+    bool cache = true;
+};
+
+/**
+ * @brief Parse an OBJ file and prepare its geometry on the CPU, without a GL context. Optimized geometry and its levels
+ * of detail are cached in <filepath>.meshcache and reused while the OBJ file keeps its size and modification time.
+ * Every level halves the triangles of the one before, levels that do not get below 80% of it are left out. Geometry
+ * of a mounted asset pack is served as views into the mapping instead.
+ *
+ * @param filepath Path to the OBJ file.
+ * @param options Processing and caching.
+ * @param mtllib Set to the material library named in the file, empty if there is none.
+ *
+ * @return Geometry of every object in file order, unindexed (one vertex per face corner) without optimize.
+ */
+std::vector<ModelGeometry> modelGeometryLoad(const std::string& filepath, const ModelGeometryOptions& options, std::string& mtllib);
+
+/**
+ * @brief Serialize optimized geometry in the mesh cache format, for an ASSET_MESH entry of an asset pack. A mounted
+ * pack with an entry for the OBJ path is used by modelGeometryLoad instead of the OBJ file and the cache.
+ *
+ * @param filepath Path to the OBJ file the geometry was loaded from.
+ * @param geometry Geometry from modelGeometryLoad with optimize.
+ * @param mtllib Material library named in the file.
+ * @param lodCount Levels of detail the geometry was loaded with, the pack is only used for the same number.
+ *
+ * @return Bytes of the entry.
+ */
+std::vector<uint8_t> modelGeometrySerialize(const std::string& filepath, const std::vector<ModelGeometry>& geometry, const std::string& mtllib, unsigned int lodCount);
@@ -0,0 +1,122 @@
+#include "range_allocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+RangeAllocator rangeAllocatorCreate(unsigned int capacity)
+{
+    RangeAllocator allocator;
+    rangeAllocatorGrow(allocator, capacity);
+    return allocator;
+}
+
+unsigned int rangeAllocatorAlloc(RangeAllocator& allocator, unsigned int count)
+{
+    if(count == 0)
+    {
+        return 0;
+    }
+
+    /* best fit keeps the large ranges for large meshes */
+    auto best = allocator.free.end();
+    for(auto it = allocator.free.begin(); it != allocator.free.end(); ++it)
+    {
+        if(it->count >= count && (best == allocator.free.end() || it->count < best->count))
+        {
+            best = it;
+        }
+    }
+
+    if(best == allocator.free.end())
+    {
+        return RangeAllocator::INVALID;
+    }
+
+    unsigned int offset = best->offset;
+    best->offset += count;
+    best->count -= count;
+    if(best->count == 0)
+    {
+        allocator.free.erase(best);
+    }
+
+    allocator.used += count;
+    return offset;
+}
+
+void rangeAllocatorFree(RangeAllocator& allocator, const Range& range)
+{
+    if(range.count == 0)
+    {
+        return;
+    }
+    if(range.offset + range.count > allocator.capacity || range.count > allocator.used)
+    {
+        throw std::runtime_error("[RangeAllocator] Freed range is not allocated");
+    }
+
+    auto next = std::lower_bound(allocator.free.begin(), allocator.free.end(), range.offset,
+                                 [](const Range& r, unsigned int offset) { return r.offset < offset; });
+
+    bool mergePrev = next != allocator.free.begin() && std::prev(next)->offset + std::prev(next)->count == range.offset;
+    bool mergeNext = next != allocator.free.end() && range.offset + range.count == next->offset;
+
+    if(mergePrev && mergeNext)
+    {
+        std::prev(next)->count += range.count + next->count;
+        allocator.free.erase(next);
+    }
+    else if(mergePrev)
+    {
+        std::prev(next)->count += range.count;
+    }
+    else if(mergeNext)
+    {
+        next->offset = range.offset;
+        next->count += range.count;
+    }
+    else
+    {
+        allocator.free.insert(next, range);
+    }
+
+    allocator.used -= range.count;
+}
+
+void rangeAllocatorGrow(RangeAllocator& allocator, unsigned int capacity)
+{
+    if(capacity <= allocator.capacity)
+    {
+        return;
+    }
+
+    Range tail{allocator.capacity, capacity - allocator.capacity};
+    if(!allocator.free.empty() && allocator.free.back().offset + allocator.free.back().count == allocator.capacity)
+    {
+        allocator.free.back().count += tail.count;
+    }
+    else
+    {
+        allocator.free.push_back(tail);
+    }
+    allocator.capacity = capacity;
+}
+
+RangeAllocatorStats rangeAllocatorStats(const RangeAllocator& allocator)
+{
+    RangeAllocatorStats stats;
+    stats.capacity = allocator.capacity;
+    stats.used = allocator.used;
+    stats.freeRanges = allocator.free.size();
+
+    for(const Range& range : allocator.free)
+    {
+        stats.largestFree = std::max(stats.largestFree, range.count);
+        if(range.offset + range.count != allocator.capacity)
+        {
+            stats.wasted += range.count;
+        }
+    }
+
+    return stats;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+/* contiguous range of elements, e.g. vertices or indices of a buffer */
+struct Range
+{
+    unsigned int offset = 0;
+    unsigned int count = 0;
+};
+
+/* Free list allocator over [0, capacity) that only does the bookkeeping, the memory itself lives elsewhere (a GPU
+ * buffer). Free ranges are kept sorted by offset and merged with their neighbours when a range is freed. */
+struct RangeAllocator
+{
+    static constexpr unsigned int INVALID = ~0u;
+
+    unsigned int capacity = 0;
+    unsigned int used = 0;
+    std::vector<Range> free;
+};
+
+struct RangeAllocatorStats
+{
+    unsigned int capacity = 0;
+    unsigned int used = 0;
+
+    /* free elements in holes between allocations; the free range at the end is not counted, it can take any size */
+    unsigned int wasted = 0;
+    unsigned int largestFree = 0;
+    unsigned int freeRanges = 0;
+};
+
+/**
+ * @brief Create an allocator with all elements free.
+ */
+RangeAllocator rangeAllocatorCreate(unsigned int capacity);
+
+/**
+ * @brief Allocate count contiguous elements from the smallest free range they fit in.
+ *
+ * @return Offset of the allocation, RangeAllocator::INVALID if no free range is large enough.
+ */
+unsigned int rangeAllocatorAlloc(RangeAllocator& allocator, unsigned int count);
+
+/**
+ * @brief Return an allocation, it is merged with adjacent free ranges.
+ */
+void rangeAllocatorFree(RangeAllocator& allocator, const Range& range);
+
+/**
+ * @brief Grow the capacity, the new elements extend the free range at the end.
+ */
+void rangeAllocatorGrow(RangeAllocator& allocator, unsigned int capacity);
+
+/**
+ * @brief Usage and fragmentation of an allocator.
+ */
+RangeAllocatorStats rangeAllocatorStats(const RangeAllocator& allocator);
@@ -0,0 +1,223 @@
+#include "render_target.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace detail
+{
+
+struct RenderTargetFormatInfo
+{
+    const char* name;
+    GLenum internalFormat;
+    GLenum format;
+    GLenum type;
+
+    /* bytes per pixel as drivers usually store it, RGB8 and 24 bit depth padded to 4 */
+    unsigned int bytes;
+};
+
+const RenderTargetFormatInfo renderTargetFormats[] =
+{
+    {"none", 0, 0, 0, 0},
+    {"rgb8", GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, 4},
+    {"rgba8", GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4},
+    {"rgba16f", GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, 8},
+    {"depth24", GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 4},
+    {"depth32f", GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT, 4},
+};
+
+GLuint renderTargetTexture(RenderTargetPool& pool, const char* name, RenderTargetFormat format)
+{
+    if(format == RT_NONE)
+    {
+        return 0;
+    }
+
+    auto free = std::find_if(pool.textures.begin(), pool.textures.end(), [&](const RenderTexture& texture)
+    {
+        return !texture.inUse && texture.format == format && texture.width == pool.width && texture.height == pool.height;
+    });
+    if(free == pool.textures.end())
+    {
+        const auto& info = renderTargetFormats[format];
+        RenderTexture texture = {.width = pool.width, .height = pool.height, .format = format};
+        texture.bytes = size_t(pool.width) * pool.height * info.bytes;
+
+        float borderColor[] = {0.f, 0.f, 0.f, 1.f};
+        glGenTextures(1, &texture.id);
+        glBindTexture(GL_TEXTURE_2D, texture.id);
+        glTexImage2D(GL_TEXTURE_2D, 0, info.internalFormat, pool.width, pool.height, 0, info.format, info.type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        /* color reads outside the screen are black, depth keeps the default wrapping */
+        if(info.format != GL_DEPTH_COMPONENT)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+            glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        pool.textures.push_back(texture);
+        free = pool.textures.end() - 1;
+    }
+
+    free->name = name;
+    free->inUse = true;
+    free->lastUsed = pool.frame;
+    return free->id;
+}
+
+GLuint renderTargetFramebuffer(RenderTargetPool& pool, GLuint color, GLuint depth)
+{
+    for(const auto& framebuffer : pool.framebuffers)
+    {
+        if(framebuffer.color == color && framebuffer.depth == depth)
+        {
+            return framebuffer.id;
+        }
+    }
+
+    GLuint fbo = 0;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+    if(!color)
+    {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    pool.framebuffers.push_back({fbo, color, depth});
+    return fbo;
+}
+
+/* delete a texture and every framebuffer it is attached to */
+void renderTargetDeleteTexture(RenderTargetPool& pool, GLuint texture)
+{
+    std::erase_if(pool.framebuffers, [&](const RenderTargetPool::Framebuffer& framebuffer)
+    {
+        bool attached = framebuffer.color == texture || framebuffer.depth == texture;
+        if(attached)
+        {
+            glDeleteFramebuffers(1, &framebuffer.id);
+        }
+        return attached;
+    });
+    glDeleteTextures(1, &texture);
+}
+
+}
+
+RenderTargetPool renderTargetPoolCreate(int width, int height)
+{
+    RenderTargetPool pool;
+    pool.width = pool.pendingWidth = width;
+    pool.height = pool.pendingHeight = height;
+    return pool;
+}
+
+void renderTargetPoolDelete(RenderTargetPool& pool)
+{
+    for(const auto& framebuffer : pool.framebuffers)
+    {
+        glDeleteFramebuffers(1, &framebuffer.id);
+    }
+    for(const auto& texture : pool.textures)
+    {
+        glDeleteTextures(1, &texture.id);
+    }
+    pool.framebuffers.clear();
+    pool.textures.clear();
+}
+
+void renderTargetPoolResize(RenderTargetPool& pool, int width, int height)
+{
+    pool.pendingWidth = width;
+    pool.pendingHeight = height;
+    pool.pendingSince = std::chrono::steady_clock::now();
+}
+
+bool renderTargetPoolBeginFrame(RenderTargetPool& pool)
+{
+    pool.frame++;
+
+    /* minimized windows report 0 x 0, keep the targets until the window comes back */
+    bool resized = false;
+    if((pool.pendingWidth != pool.width || pool.pendingHeight != pool.height) && pool.pendingWidth > 0 && pool.pendingHeight > 0
+       && std::chrono::duration<double>(std::chrono::steady_clock::now() - pool.pendingSince).count() >= pool.settleTime)
+    {
+        pool.width = pool.pendingWidth;
+        pool.height = pool.pendingHeight;
+        resized = true;
+    }
+
+    std::erase_if(pool.textures, [&](const RenderTexture& texture)
+    {
+        bool idle = !texture.inUse && pool.frame - texture.lastUsed > pool.maxIdleFrames;
+        if(idle)
+        {
+            detail::renderTargetDeleteTexture(pool, texture.id);
+        }
+        return idle;
+    });
+    return resized;
+}
+
+RenderTarget renderTargetAcquire(RenderTargetPool& pool, const char* name, RenderTargetFormat color, RenderTargetFormat depth)
+{
+    RenderTarget target = {.width = pool.width, .height = pool.height};
+    target.colorTexture = detail::renderTargetTexture(pool, name, color);
+    target.depthTexture = detail::renderTargetTexture(pool, name, depth);
+    target.fbo = detail::renderTargetFramebuffer(pool, target.colorTexture, target.depthTexture);
+    return target;
+}
+
+void renderTargetRelease(RenderTargetPool& pool, const RenderTarget& target)
+{
+    for(auto& texture : pool.textures)
+    {
+        if(texture.id == target.colorTexture || texture.id == target.depthTexture)
+        {
+            texture.inUse = false;
+        }
+    }
+}
+
+size_t renderTargetPoolBytes(const RenderTargetPool& pool)
+{
+    size_t bytes = 0;
+    for(const auto& texture : pool.textures)
+    {
+        bytes += texture.bytes;
+    }
+    return bytes;
+}
+
+void renderTargetPoolPrint(const RenderTargetPool& pool)
+{
+    printf("Render targets: %zu textures, %zu framebuffers, %.1f MB, screen %dx%d\n", pool.textures.size(), pool.framebuffers.size(),
+           renderTargetPoolBytes(pool) / 1048576.0, pool.width, pool.height);
+    for(const auto& texture : pool.textures)
+    {
+        printf("  %-16s %5dx%-5d %-8s %7.1f MB  %s\n", texture.name, texture.width, texture.height,
+               detail::renderTargetFormats[texture.format].name, texture.bytes / 1048576.0,
+               texture.inUse ? "in use" : ("idle " + std::to_string(pool.frame - texture.lastUsed) + " frames").c_str());
+    }
+}
+
+RenderTargetFormat renderTargetFormat(const std::string& name)
+{
+    for(int format = RT_RGB8; format <= RT_DEPTH32F; format++)
+    {
+        if(name == detail::renderTargetFormats[format].name)
+        {
+            return RenderTargetFormat(format);
+        }
+    }
+    return RT_NONE;
+}
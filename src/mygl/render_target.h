@@ -0,0 +1,131 @@
+#pragma once
+
+#include "base.h"
+
+#include <chrono>
+#include <vector>
+
+enum RenderTargetFormat
+{
+    RT_NONE,
+    RT_RGB8,
+    RT_RGBA8,
+    RT_RGBA16F,
+    RT_DEPTH24,
+    RT_DEPTH32F,
+};
+
+/* a pooled texture, free for any pass that asks for its size and format while not in use */
+struct RenderTexture
+{
+    GLuint id = 0;
+    int width = 0;
+    int height = 0;
+    RenderTargetFormat format = RT_NONE;
+    size_t bytes = 0;
+
+    /* pass that acquired it last, for the memory view */
+    const char* name = "";
+    bool inUse = false;
+    unsigned int lastUsed = 0;
+};
+
+/* what a pass renders into: a framebuffer with the pooled attachments, valid until it is released */
+struct RenderTarget
+{
+    GLuint fbo = 0;
+    GLuint colorTexture = 0;
+    GLuint depthTexture = 0;
+    int width = 0;
+    int height = 0;
+};
+
+/**
+ * Pool of render target textures keyed by size and format. Passes acquire screen sized targets every frame and
+ * release them once the result was read, so the textures are shared across frames and passes, and framebuffer
+ * objects are cached per attachment pair. Window resizes don't reallocate right away: the pool's screen size follows
+ * the window once it stopped changing for settleTime, textures of the old size are deleted after maxIdleFrames
+ * frames without use.
+ */
+struct RenderTargetPool
+{
+    std::vector<RenderTexture> textures;
+
+    struct Framebuffer
+    {
+        GLuint id;
+        GLuint color;
+        GLuint depth;
+    };
+    std::vector<Framebuffer> framebuffers;
+
+    unsigned int frame = 0;
+    unsigned int maxIdleFrames = 120;
+
+    /* size of the targets, and the window size waiting to settle */
+    int width = 0;
+    int height = 0;
+    int pendingWidth = 0;
+    int pendingHeight = 0;
+    std::chrono::steady_clock::time_point pendingSince;
+    double settleTime = 0.25;
+};
+
+/**
+ * @brief Create an empty pool.
+ *
+ * @param width Initial screen size of the targets.
+ * @param height Initial screen size of the targets.
+ */
+RenderTargetPool renderTargetPoolCreate(int width, int height);
+
+/**
+ * @brief Delete all textures and framebuffers. Has to be called for each pool after it is not used anymore.
+ */
+void renderTargetPoolDelete(RenderTargetPool& pool);
+
+/**
+ * @brief Report a new window size. The targets keep their size until no new size came for settleTime.
+ */
+void renderTargetPoolResize(RenderTargetPool& pool, int width, int height);
+
+/**
+ * @brief Start a frame: apply a settled resize and delete textures that weren't used for maxIdleFrames frames.
+ *
+ * @return True if the screen size of the targets changed.
+ */
+bool renderTargetPoolBeginFrame(RenderTargetPool& pool);
+
+/**
+ * @brief Get a screen sized target, reusing free textures of the same size and format.
+ *
+ * @param pool Pool.
+ * @param name Pass name for the memory view, has to outlive the pool (string literal).
+ * @param color Color format, RT_NONE for none.
+ * @param depth Depth format, RT_NONE for none.
+ *
+ * @return Target to render into; render with a viewport of its size, which lags behind the window while resizing.
+ */
+RenderTarget renderTargetAcquire(RenderTargetPool& pool, const char* name, RenderTargetFormat color, RenderTargetFormat depth);
+
+/**
+ * @brief Return the textures of a target to the pool. Later passes of the same frame may reuse them.
+ */
+void renderTargetRelease(RenderTargetPool& pool, const RenderTarget& target);
+
+/**
+ * @brief GPU memory of all pooled textures in bytes, estimated from size and format.
+ */
+size_t renderTargetPoolBytes(const RenderTargetPool& pool);
+
+/**
+ * @brief Print every pooled texture with its pass, size, format, memory and idle frames.
+ */
+void renderTargetPoolPrint(const RenderTargetPool& pool);
+
+/**
+ * @brief Parse a format name: rgb8, rgba8, rgba16f, depth24 or depth32f.
+ *
+ * @return The format, RT_NONE for an unknown name.
+ */
+RenderTargetFormat renderTargetFormat(const std::string& name);
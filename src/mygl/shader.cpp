@@ -1,17 +1,30 @@
 #include "shader.h"
+#include "asset_pack.h"
+#include "profiler.h"
 
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <span>
 #include <stdexcept>
+#include <string_view>
+#include <vector>
 
 namespace detail
 {
-    void compile(GLuint handle, const char* source, const int size)
+    /* the source is the concatenation of the parts, so it can be compiled from views without joining them */
+    void compile(GLuint handle, std::span<const std::string_view> parts)
     {
         GLint compileResult = 0;
 
-        glShaderSource(handle, 1, &source, &size);
+        std::vector<const char*> sources;
+        std::vector<GLint> sizes;
+        for(const auto& part : parts)
+        {
+            sources.push_back(part.data());
+            sizes.push_back(GLint(part.size()));
+        }
+        glShaderSource(handle, GLsizei(parts.size()), sources.data(), sizes.data());
         glCompileShader(handle);
         glGetShaderiv(handle, GL_COMPILE_STATUS, &compileResult);
 
@@ -31,6 +44,14 @@ namespace detail
         }
     }
 
+    /* the #version directive has to stay the first line, so the defines go right after it */
+    std::array<std::string_view, 3> insertDefines(std::string_view source, std::string_view defines)
+    {
+        size_t line = source.find("#version");
+        line = line == std::string_view::npos ? 0 : std::min(source.find('\n', line), source.size() - 1) + 1;
+        return {source.substr(0, line), defines, source.substr(line)};
+    }
+
     void link(GLuint handle)
     {
         glLinkProgram(handle);
@@ -57,56 +78,62 @@ namespace detail
             throw std::runtime_error((std::string("[Shader] ERROR link shaderprogram: \n") + programLog));
         }
     }
-}
-
-ShaderProgram shaderCreate(const std::string &vertexSource, const std::string &fragmentSource)
-{
-    ShaderProgram program{glCreateProgram(), glCreateShader(GL_VERTEX_SHADER), glCreateShader(GL_FRAGMENT_SHADER)};
 
-    if(!program._vertexID || !program._fragmentID || !program.id)
+    ShaderProgram createProgram(std::span<const std::string_view> vertexParts, std::span<const std::string_view> fragmentParts)
     {
-        std::cerr << "[Shader] Couldn't create shader program!" << std::endl;
-        std::cerr.flush();
-        throw std::runtime_error("[Shader] Couldn't create shader program!");
-    }
+        ShaderProgram program{glCreateProgram(), glCreateShader(GL_VERTEX_SHADER), glCreateShader(GL_FRAGMENT_SHADER)};
 
-    detail::compile(program._vertexID, vertexSource.c_str(), vertexSource.size());
-    glAttachShader(program.id, program._vertexID);
+        if(!program._vertexID || !program._fragmentID || !program.id)
+        {
+            std::cerr << "[Shader] Couldn't create shader program!" << std::endl;
+            std::cerr.flush();
+            throw std::runtime_error("[Shader] Couldn't create shader program!");
+        }
 
-    detail::compile(program._fragmentID, fragmentSource.c_str(), fragmentSource.size());
-    glAttachShader(program.id, program._fragmentID);
+        compile(program._vertexID, vertexParts);
+        glAttachShader(program.id, program._vertexID);
 
-    detail::link(program.id);
+        compile(program._fragmentID, fragmentParts);
+        glAttachShader(program.id, program._fragmentID);
 
-    return program;
+        link(program.id);
+
+        return program;
+    }
 }
 
-ShaderProgram shaderLoad(const std::string &vertexPath, const std::string &fragmentPath)
+ShaderProgram shaderCreate(const std::string &vertexSource, const std::string &fragmentSource)
 {
-    std::ifstream vertexFile(vertexPath);
-    std::ifstream fragmentFile(fragmentPath);
+    std::string_view vertex = vertexSource;
+    std::string_view fragment = fragmentSource;
+    return detail::createProgram({&vertex, 1}, {&fragment, 1});
+}
+
+ShaderProgram shaderLoad(const std::string &vertexPath, const std::string &fragmentPath, const std::string &defines)
+{
+    PROFILE_ZONE("shaderLoad");
+
+    /* the sources are views into the asset pack, or the loose files read in one go */
+    AssetData vertexFile;
+    AssetData fragmentFile;
 
-    if(!vertexFile.is_open())
+    if(!assetRead(vertexPath, vertexFile))
     {
         std::cerr << "[Shader] Couldn't open vertex shader file at " << std::endl;
         std::cerr.flush();
         throw std::runtime_error("[Shader] Couldn't open vertex shader file at " + vertexPath);
     }
 
-    if(!fragmentFile.is_open())
+    if(!assetRead(fragmentPath, fragmentFile))
     {
         std::cerr << "[Shader] Couldn't open fragment shader file at " << std::endl;
         std::cerr.flush();
         throw std::runtime_error("[Shader] Couldn't open fragment shader file at " + fragmentPath);
     }
 
-    std::stringstream vertexSourceBuffer;
-    vertexSourceBuffer << vertexFile.rdbuf();
-
-    std::stringstream fragmentSourceBuffer;
-    fragmentSourceBuffer << fragmentFile.rdbuf();
-
-    return shaderCreate(vertexSourceBuffer.str(), fragmentSourceBuffer.str());
+    auto vertex = detail::insertDefines({reinterpret_cast<const char*>(vertexFile.data), vertexFile.size}, defines);
+    auto fragment = detail::insertDefines({reinterpret_cast<const char*>(fragmentFile.data), fragmentFile.size}, defines);
+    return detail::createProgram(vertex, fragment);
 }
 
 void shaderDelete(const ShaderProgram &program)
@@ -144,6 +171,12 @@ void shaderUniform(ShaderProgram &shader, const std::string &name, const Matrix4
     glUniformMatrix4fv(index, 1, GL_FALSE, value.ptr());
 }
 
+void shaderUniform(ShaderProgram &shader, const std::string &name, const Matrix3D& value)
+{
+    GLint index = detail::uniform_index(shader, name);
+    glUniformMatrix3fv(index, 1, GL_FALSE, value.ptr());
+}
+
 void shaderUniform(ShaderProgram &shader, const std::string &name, int value)
 {
     GLint index = detail::uniform_index(shader, name);
@@ -14,10 +14,11 @@ struct ShaderProgram
  *
  * @param vertexPath Path to vertex shader file.
  * @param fragmentPath Path to fragment shader file.
+ * @param defines Lines inserted into both shaders after the #version directive, e.g. "#define PACKED_VERTICES\n".
  *
  * @return Shader program.
  */
-ShaderProgram shaderLoad(const std::string& vertexPath, const std::string& fragmentPath);
+ShaderProgram shaderLoad(const std::string& vertexPath, const std::string& fragmentPath, const std::string& defines = "");
 
 /**
  * @brief Function to compile and link vertex and fragement source strings to create shader program.
@@ -45,6 +46,15 @@ void shaderDelete(const ShaderProgram& program);
  */
 void shaderUniform(ShaderProgram& shader, const std::string& name, const Matrix4D& value);
 
+/**
+ * @brief Function to set uniform in shader program.
+ *
+ * @param shader Shader program.
+ * @param name Uniform naem.
+ * @param value Value to which the uniform should be set.
+ */
+void shaderUniform(ShaderProgram& shader, const std::string& name, const Matrix3D& value);
+
 /**
  * @brief Function to set uniform in shader program.
  *
@@ -1,19 +1,39 @@
 #include "texture.h"
+#include "asset_pack.h"
+#include "profiler.h"
 
 #include <stdexcept>
 #include <iostream>
 
 #include <stb_image/stb_image.h>
 
-Texture textureLoad(const std::string &path)
+TextureImage textureImageLoad(const std::string& path, bool flip)
 {
+    PROFILE_ZONE("textureImageLoad");
+
+    const AssetEntry* entry = assetFind(path, ASSET_IMAGE);
+    if(entry && entry->flipped == flip)
+    {
+        return TextureImage{const_cast<unsigned char*>(assetEntryData(*entry)), entry->width, entry->height, true};
+    }
+
     int width = 0, height = 0, components = 0;
 
-    /* flip image to match opengl's texture coordinates */
-    stbi_set_flip_vertically_on_load(true);
+    /* the flag of the calling thread, so images of both orientations can be decoded at the same time */
+    stbi_set_flip_vertically_on_load_thread(flip);
 
-    /* load image */
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &components, 4);
+    /* load image, from the bytes of the file in the pack if it has them */
+    unsigned char* data = nullptr;
+    if(assetFind(path, ASSET_FILE))
+    {
+        AssetData file;
+        assetRead(path, file);
+        data = stbi_load_from_memory(file.data, file.size, &width, &height, &components, 4);
+    }
+    else
+    {
+        data = stbi_load(path.c_str(), &width, &height, &components, 4);
+    }
     if(data == nullptr)
     {
         std::cerr << "[Texture] couldn't load image file " << path << std::endl;
@@ -21,11 +41,27 @@ Texture textureLoad(const std::string &path)
         throw std::runtime_error("[Texture] couldn't load image file " + path);
     }
 
+    return TextureImage{data, (unsigned int) width, (unsigned int) height};
+}
+
+void textureImageFree(TextureImage& image)
+{
+    if(!image.view)
+    {
+        stbi_image_free(image.data);
+    }
+    image.data = nullptr;
+}
+
+Texture textureCreate(const TextureImage& image)
+{
+    PROFILE_ZONE("textureCreate");
+
     /* upload data */
     GLuint id = 0;
     glGenTextures(1, &id);
     glBindTexture(GL_TEXTURE_2D, id);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.data);
     glCheckError();
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -34,10 +70,19 @@ Texture textureLoad(const std::string &path)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glCheckError();
 
-    stbi_image_free(data);
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    return Texture{id, (unsigned int) width, (unsigned int) height};
+    return Texture{id, image.width, image.height};
+}
+
+Texture textureLoad(const std::string &path)
+{
+    PROFILE_ZONE("textureLoad");
+
+    TextureImage image = textureImageLoad(path);
+    Texture texture = textureCreate(image);
+    textureImageFree(image);
+    return texture;
 }
 
 void textureDelete(const Texture &texture)
@@ -10,6 +10,44 @@ struct Texture
     unsigned int height = 0;
 };
 
+/* RGBA8 pixels of an image file, decoded without a GL context so any thread can load it */
+struct TextureImage
+{
+    unsigned char* data = nullptr;
+
+    unsigned int width = 0;
+    unsigned int height = 0;
+
+    /* data points into the mounted asset pack instead of a decoded copy */
+    bool view = false;
+};
+
+/**
+ * @brief Decode an image file to RGBA8. Needs no GL context, images may be decoded on several threads at once.
+ * Images of the mounted asset pack are served without decoding when they are stored with the same orientation, or
+ * decoded from the pack. Throws a runtime_error if the file can't be read.
+ *
+ * @param path Path to the image file.
+ * @param flip Flip the rows to match OpenGL's texture coordinates, cube map faces are not flipped.
+ *
+ * @return Decoded image, has to be freed with textureImageFree.
+ */
+TextureImage textureImageLoad(const std::string& path, bool flip = true);
+
+/**
+ * @brief Free the pixels of a decoded image.
+ */
+void textureImageFree(TextureImage& image);
+
+/**
+ * @brief Initialize OpenGL texture from a decoded image.
+ *
+ * @param image Decoded image.
+ *
+ * @return Initialized texture object.
+ */
+Texture textureCreate(const TextureImage& image);
+
 /**
  * @brief Initialize OpenGL texture and load it from file.
  *
@@ -0,0 +1,165 @@
+#include "vertex_pack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace detail
+{
+
+int16_t packSnorm16(float value)
+{
+    return (int16_t) std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+float unpackSnorm16(int16_t value)
+{
+    return std::max(value / 32767.0f, -1.0f);
+}
+
+uint16_t packGrid(float value, float offset, float scale)
+{
+    return (uint16_t) std::clamp(std::lround((value - offset) / scale), 0l, 65535l);
+}
+
+}
+
+VertexQuantization vertexQuantization(const Bounds& bounds)
+{
+    Vector3D min = bounds.center - bounds.extent;
+    Vector3D size = 2.0f * bounds.extent;
+
+    VertexQuantization quantization;
+    quantization.offset = min;
+    quantization.scale = Vector3D(size.x > 0.0f ? size.x / 65535.0f : 1.0f,
+                                  size.y > 0.0f ? size.y / 65535.0f : 1.0f,
+                                  size.z > 0.0f ? size.z / 65535.0f : 1.0f);
+    return quantization;
+}
+
+std::vector<PackedVertex> vertexPack(std::span<const Vertex> vertices, const VertexQuantization& quantization)
+{
+    std::vector<PackedVertex> packed(vertices.size());
+    for(size_t i = 0; i < vertices.size(); i++)
+    {
+        const Vertex& v = vertices[i];
+        PackedVertex& p = packed[i];
+
+        p.pos[0] = detail::packGrid(v.pos.x, quantization.offset.x, quantization.scale.x);
+        p.pos[1] = detail::packGrid(v.pos.y, quantization.offset.y, quantization.scale.y);
+        p.pos[2] = detail::packGrid(v.pos.z, quantization.offset.z, quantization.scale.z);
+        p.pad = 0;
+
+        Vector2D normal = octEncode(v.normal);
+        p.normal[0] = detail::packSnorm16(normal.x);
+        p.normal[1] = detail::packSnorm16(normal.y);
+
+        p.uv[0] = floatToHalf(v.uv.x);
+        p.uv[1] = floatToHalf(v.uv.y);
+    }
+    return packed;
+}
+
+Vertex vertexUnpack(const PackedVertex& p, const VertexQuantization& quantization)
+{
+    Vertex v;
+    v.pos = Vector3D(quantization.offset.x + quantization.scale.x * p.pos[0],
+                     quantization.offset.y + quantization.scale.y * p.pos[1],
+                     quantization.offset.z + quantization.scale.z * p.pos[2]);
+    v.normal = octDecode(Vector2D(detail::unpackSnorm16(p.normal[0]), detail::unpackSnorm16(p.normal[1])));
+    v.uv = Vector2D(halfToFloat(p.uv[0]), halfToFloat(p.uv[1]));
+    return v;
+}
+
+Vector2D octEncode(const Vector3D& n)
+{
+    float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if(l1 == 0.0f)
+    {
+        return Vector2D(0.0f, 0.0f);
+    }
+
+    Vector2D e(n.x / l1, n.y / l1);
+    if(n.z < 0.0f)
+    {
+        /* fold the lower half over the diagonals */
+        e = Vector2D((1.0f - std::abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f),
+                     (1.0f - std::abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f));
+    }
+    return e;
+}
+
+Vector3D octDecode(const Vector2D& e)
+{
+    Vector3D n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t magnitude = bits & 0x7fffffffu;
+
+    if(magnitude >= 0x7f800000u)
+    {
+        /* infinity stays infinity, NaN keeps a set mantissa bit */
+        return sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x200u : 0u);
+    }
+    if(magnitude >= 0x477ff000u)
+    {
+        /* rounds to 65536 or more */
+        return sign | 0x7c00u;
+    }
+    if(magnitude < 0x38800000u)
+    {
+        /* half subnormal: the float is scaled so the integer part is the half mantissa, rounding to nearest even */
+        float scaled;
+        uint32_t absBits = magnitude;
+        std::memcpy(&scaled, &absBits, sizeof(scaled));
+        return sign | (uint16_t) std::nearbyint(scaled * 16777216.0f);
+    }
+
+    /* rebias the exponent and round the 13 dropped mantissa bits to nearest even, a carry correctly bumps the exponent */
+    uint32_t half = (magnitude - 0x38000000u) >> 13;
+    uint32_t rest = magnitude & 0x1fffu;
+    if(rest > 0x1000u || (rest == 0x1000u && (half & 1u)))
+    {
+        half++;
+    }
+    return sign | half;
+}
+
+float halfToFloat(uint16_t value)
+{
+    uint32_t sign = uint32_t(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1fu;
+    uint32_t mantissa = value & 0x3ffu;
+
+    float magnitude;
+    if(exponent == 0)
+    {
+        magnitude = std::ldexp(float(mantissa), -24);
+    }
+    else if(exponent == 31)
+    {
+        magnitude = mantissa ? NAN : INFINITY;
+    }
+    else
+    {
+        magnitude = std::ldexp(float(mantissa | 0x400u), int(exponent) - 25);
+    }
+
+    uint32_t bits;
+    std::memcpy(&bits, &magnitude, sizeof(bits));
+    bits |= sign;
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
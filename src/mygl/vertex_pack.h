@@ -0,0 +1,49 @@
+#pragma once
+
+#include "mesh.h"
+
+#include <math/bounds.h>
+
+/**
+ * @brief Quantization grid spanning a bounding box with 65536 steps per axis.
+ *
+ * @param bounds Bounds of the vertices that are packed.
+ *
+ * @return Grid whose integer positions 0 and 65535 are the box corners, flat axes get a scale of 1.
+ */
+VertexQuantization vertexQuantization(const Bounds& bounds);
+
+/**
+ * @brief Pack vertices: positions rounded to the grid, normals octahedral encoded, uvs converted to half floats.
+ *
+ * @param vertices Float vertices, positions have to lie on the grid range [0, 65535].
+ * @param quantization Position grid.
+ *
+ * @return Packed vertices in the same order.
+ */
+std::vector<PackedVertex> vertexPack(std::span<const Vertex> vertices, const VertexQuantization& quantization);
+
+/**
+ * @brief Decode a packed vertex the way the shaders do, to measure the packing error.
+ */
+Vertex vertexUnpack(const PackedVertex& vertex, const VertexQuantization& quantization);
+
+/**
+ * @brief Octahedral encoding of a unit vector: the octahedron |x| + |y| + |z| = 1 is unfolded onto the square [-1, 1]^2.
+ */
+Vector2D octEncode(const Vector3D& n);
+
+/**
+ * @brief Inverse of octEncode, returns a unit vector.
+ */
+Vector3D octDecode(const Vector2D& e);
+
+/**
+ * @brief Round a float to the nearest IEEE half float, out of range values become infinity.
+ */
+uint16_t floatToHalf(float value);
+
+/**
+ * @brief Widen a half float to float.
+ */
+float halfToFloat(uint16_t value);
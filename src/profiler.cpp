@@ -0,0 +1,151 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+Profiler gProfiler;
+
+namespace detail
+{
+
+const std::chrono::steady_clock::time_point profilerEpoch = std::chrono::steady_clock::now();
+
+thread_local ProfilerTrack* profilerThreadTrack = nullptr;
+
+ProfilerTrack* profilerAddTrack(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(gProfiler.mutex);
+    auto& track = gProfiler.tracks.emplace_back(std::make_unique<ProfilerTrack>());
+    track->id = gProfiler.tracks.size();
+    track->name = name.empty() ? "thread " + std::to_string(track->id) : name;
+    track->events.resize(gProfiler.capacity);
+    return track.get();
+}
+
+ProfilerTrack* profilerCurrentTrack()
+{
+    if(!profilerThreadTrack)
+    {
+        profilerThreadTrack = profilerAddTrack("");
+    }
+    return profilerThreadTrack;
+}
+
+/* copy the events still in the ring buffer. The owner keeps writing, so after the copy everything it may have
+ * overwritten in the meantime is dropped again. */
+std::vector<ProfilerEvent> profilerSnapshot(const ProfilerTrack& track)
+{
+    uint64_t capacity = track.events.size();
+    uint64_t end = track.written.load(std::memory_order_acquire);
+    uint64_t begin = end > capacity ? end - capacity : 0;
+
+    std::vector<ProfilerEvent> events;
+    for(uint64_t i = begin; i < end; i++)
+    {
+        events.push_back(track.events[i % capacity]);
+    }
+
+    /* event i is overwritten by event i + capacity, which may be in progress once written reached it */
+    uint64_t after = track.written.load(std::memory_order_acquire);
+    uint64_t valid = after + 1 > capacity ? after + 1 - capacity : 0;
+    if(valid > begin)
+    {
+        events.erase(events.begin(), events.begin() + std::min<uint64_t>(valid - begin, events.size()));
+    }
+    return events;
+}
+
+/* minimal JSON string escaping for zone and track names */
+std::string profilerEscape(const std::string& s)
+{
+    std::string out;
+    for(char c : s)
+    {
+        if(c == '"' || c == '\\')
+        {
+            out += '\\';
+        }
+        out += (unsigned char) c < 0x20 ? ' ' : c;
+    }
+    return out;
+}
+
+}
+
+void profilerEnable(bool enabled)
+{
+    gProfiler.enabled.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t profilerNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - detail::profilerEpoch).count();
+}
+
+void profilerSetThreadName(const std::string& name)
+{
+    ProfilerTrack* track = detail::profilerCurrentTrack();
+    std::lock_guard<std::mutex> lock(gProfiler.mutex);
+    track->name = name;
+}
+
+ProfilerTrack* profilerTrackCreate(const std::string& name)
+{
+    return detail::profilerAddTrack(name);
+}
+
+void profilerEmit(ProfilerTrack* track, const char* name, uint64_t begin, uint64_t end)
+{
+    if(!track)
+    {
+        track = detail::profilerCurrentTrack();
+    }
+
+    /* only the owner writes, so a relaxed load of its own counter is enough */
+    uint64_t index = track->written.load(std::memory_order_relaxed);
+    track->events[index % track->events.size()] = {name, begin, end};
+    track->written.store(index + 1, std::memory_order_release);
+}
+
+bool profilerWriteChromeTrace(const std::string& filepath)
+{
+    FILE* file = fopen(filepath.c_str(), "w");
+    if(!file)
+    {
+        return false;
+    }
+
+    std::vector<std::pair<std::string, uint32_t>> names;
+    std::vector<std::vector<ProfilerEvent>> events;
+    {
+        std::lock_guard<std::mutex> lock(gProfiler.mutex);
+        for(const auto& track : gProfiler.tracks)
+        {
+            names.emplace_back(track->name, track->id);
+            events.push_back(detail::profilerSnapshot(*track));
+        }
+    }
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+    for(size_t t = 0; t < names.size(); t++)
+    {
+        fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s\"}}",
+                first ? "" : ",\n", names[t].second, detail::profilerEscape(names[t].first).c_str());
+        first = false;
+
+        /* zones end inner first, sorted by start the viewer nests them */
+        std::sort(events[t].begin(), events[t].end(), [](const ProfilerEvent& a, const ProfilerEvent& b) { return a.begin < b.begin || (a.begin == b.begin && a.end > b.end); });
+        for(const auto& event : events[t])
+        {
+            fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                    detail::profilerEscape(event.name).c_str(), names[t].second, event.begin / 1e3, (event.end - event.begin) / 1e3);
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* one finished zone, times in nanoseconds since the profiler epoch */
+struct ProfilerEvent
+{
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+/**
+ * A named timeline of the trace, one per thread plus tracks for other timelines like the GPU. Events go into a ring
+ * buffer that only the owning thread writes, so recording takes no lock; once it wraps the oldest events are dropped.
+ */
+struct ProfilerTrack
+{
+    std::string name;
+    uint32_t id = 0;
+
+    std::vector<ProfilerEvent> events;
+
+    /* number of events ever written, event i is at events[i % events.size()] */
+    std::atomic<uint64_t> written = 0;
+};
+
+struct Profiler
+{
+    std::atomic<bool> enabled = false;
+
+    /* events kept per track */
+    size_t capacity = 1 << 16;
+
+    /* tracks are never removed, so pointers to them stay valid after their thread exits */
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ProfilerTrack>> tracks;
+};
+
+/* global profiler written by PROFILE_ZONE */
+extern Profiler gProfiler;
+
+/**
+ * @brief Start or stop recording. Zones are cheap while stopped, a relaxed load and a branch.
+ */
+void profilerEnable(bool enabled);
+
+/**
+ * @brief Current time of the steady clock in nanoseconds since the profiler epoch, the time base of all events.
+ */
+uint64_t profilerNow();
+
+/**
+ * @brief Name the track of the calling thread, e.g. "simulation". Unnamed threads show up as "thread <id>".
+ */
+void profilerSetThreadName(const std::string& name);
+
+/**
+ * @brief Create a track that is not bound to a thread, e.g. for GPU timestamps. Only one thread may emit to it.
+ */
+ProfilerTrack* profilerTrackCreate(const std::string& name);
+
+/**
+ * @brief Record a finished zone on a track.
+ *
+ * @param track Track to write, nullptr for the calling thread's track.
+ * @param name Zone name, has to outlive the profiler (string literal).
+ * @param begin Start in profilerNow time.
+ * @param end End in profilerNow time.
+ */
+void profilerEmit(ProfilerTrack* track, const char* name, uint64_t begin, uint64_t end);
+
+/**
+ * @brief Write all recorded events as a Chrome trace_event JSON file, for chrome://tracing or ui.perfetto.dev. Can be
+ * called while other threads record, events they overwrite during the copy are left out.
+ *
+ * @param filepath Output file.
+ *
+ * @return False if the file couldn't be written.
+ */
+bool profilerWriteChromeTrace(const std::string& filepath);
+
+/* measures its scope while the profiler is enabled */
+struct ProfilerZone
+{
+    const char* name;
+    uint64_t begin;
+
+    explicit ProfilerZone(const char* name)
+        : name(gProfiler.enabled.load(std::memory_order_relaxed) ? name : nullptr), begin(this->name ? profilerNow() : 0)
+    {
+    }
+
+    ~ProfilerZone()
+    {
+        if(name)
+        {
+            profilerEmit(nullptr, name, begin, profilerNow());
+        }
+    }
+
+    ProfilerZone(const ProfilerZone&) = delete;
+    ProfilerZone& operator=(const ProfilerZone&) = delete;
+};
+
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+
+/* PROFILE_ZONE("name") times the rest of the enclosing scope, compiled out with ENABLE_PROFILER=OFF */
+#ifdef PROFILER_ENABLED
+#define PROFILE_ZONE(name) ProfilerZone PROFILER_CONCAT(profilerZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void) 0)
+#endif
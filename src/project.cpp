@@ -1,22 +1,80 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <vector>
 
 #include "mygl/shader.h"
 #include "mygl/model.h"
 #include "mygl/camera.h"
+#include "mygl/capture.h"
 #include "mygl/cube_map.h"
 #include "mygl/geometry.h"
-#include "mygl/framebuffer.h"
+#include "mygl/render_target.h"
+#include "mygl/draw_indirect.h"
+#include "mygl/gpu_profiler.h"
 
+#include "asset_pack.h"
 #include "boat.h"
+#include "boat_world.h"
+#include "frame_stats.h"
+#include "input_record.h"
+#include "job_system.h"
 #include "light.h"
+#include "profiler.h"
+#include "simulation.h"
 #include "water.h"
+#include "water_grid.h"
+
+/* one visible boat part: index into the instance list, the part model and its material */
+struct DrawItem
+{
+    uint32_t instance;
+    uint32_t part;
+    uint32_t material;
+    uint32_t lod;
+};
+
+struct CullStats
+{
+    /* counts of the last frame */
+    unsigned int instancesDrawn = 0;
+    unsigned int instancesCulled = 0;
+    unsigned int partsDrawn = 0;
+    unsigned int partsCulled = 0;
+    unsigned int waterDrawn = 0;
+    unsigned int waterCulled = 0;
+    unsigned int waterVertices = 0;
+    unsigned int boatTriangles = 0;
+    unsigned int partsPerLod[MODEL_LOD_MAX] = {};
+
+    /* summed up over the report interval */
+    double cullTime = 0.0;
+    unsigned int frames = 0;
+};
+
+struct SubmitStats
+{
+    /* draw calls of the last frame */
+    unsigned int drawCalls = 0;
+
+    /* CPU time spent issuing the boat and water draws, summed up over the report interval */
+    double submitTime = 0.0;
+    unsigned int frames = 0;
+};
 
 struct Query
 {
     unsigned int values[2];
     unsigned int backBuffer = 0;
     unsigned int frontBuffer = 1;
+
+    /* GPU time of the previous frame in nanoseconds, printed every frame unless headless */
+    GLuint64 elapsed = 0;
+    bool print = true;
 };
 struct
 {
@@ -24,10 +82,63 @@ struct
     bool cameraFollowBoat;
     float zoomSpeedMultiplier;
 
+    /* boat and optional AI fleet, stepped at a fixed rate */
+    Simulation simulation;
+
+    /* simulation state interpolated for the current frame, its fleet vector is reused */
+    SimSnapshot simFrame;
+
     WaterSim waterSim;
-    Model modelWater;
+    WaterGrid waterGrid;
+    Mesh waterMesh;
+    Material waterMaterial;
 
     Boat boat;
+    Bounds boatBounds;
+
+    /* workers for asset loading and the fleet update, GL work of jobs runs on the main thread */
+    JobSystem jobs;
+
+    /* optional pack the assets are loaded from, see --asset-pack */
+    AssetPack assets;
+
+    /* culling result of the current frame, instance 0 is the player boat followed by the fleet */
+    std::vector<Matrix4D> instances;
+    std::vector<DrawItem> visibleParts;
+    std::vector<uint32_t> waterVisible;
+    CullStats cullStats;
+
+    /* scratch of sceneCull and sceneBuildDraws, kept between frames so the per frame path doesn't allocate */
+    std::vector<Vector4D> cullSpheres;
+    std::vector<uint32_t> cullVisible;
+    std::vector<DrawItem> cullCandidates;
+    std::vector<Bounds> cullBounds;
+    std::vector<uint32_t> cullVisibleCandidates;
+    std::vector<Bounds> cullChunkBounds;
+    std::vector<uint32_t> drawOrder;
+    std::vector<uint32_t> drawCursor;
+
+    /* all meshes live in one arena per vertex format, so every boat part and water chunk is drawn from the same VAO.
+     * The draw list holds the model matrices of both submission paths; with indirect submission the commands of boat
+     * material group g are [groupStart[g], groupStart[g + 1]), one group per part material, followed by the water
+     * chunks. */
+    MeshArena meshArena;
+    MeshArena skyboxArena;
+    std::vector<uint32_t> boatGroupBase;
+    uint32_t boatGroupCount;
+    DrawIndirect draws;
+    std::vector<uint32_t> groupStart;
+    bool useIndirect;
+
+    /* boat and water stored as PackedVertex instead of Vertex */
+    bool packedVertices;
+
+    /* load the boat with meshOptimize applied, off with --no-mesh-optimize */
+    bool optimizeMeshes;
+
+    /* boat parts use the coarsest level of detail whose error stays below this many pixels, 0 draws level 0 */
+    float lodThreshold;
+    SubmitStats submitStats;
 
     CubeMap skybox;
 
@@ -42,11 +153,26 @@ struct
     ShaderProgram shaderBlinnPhong;
     ShaderProgram shaderSkybox;
 
-    Framebuffer customFramebuffer;
+    /* screen sized targets; the boat is rendered into one for the screen space reflections of the water, in the
+     * formats of --ssr-color-format and --ssr-depth-format */
+    RenderTargetPool renderTargets;
+    RenderTargetFormat ssrColorFormat;
+    RenderTargetFormat ssrDepthFormat;
     bool useBinarySearch;
 
     Query query;
 
+    /* GPU zones of the trace, written to tracePath with T or at exit while the profiler records */
+    GpuProfiler gpuProfiler;
+    std::string tracePath;
+
+    /* asynchronous screenshots and continuous capture of every captureEvery-th frame, toggled with R, and recording
+     * into recordPath, toggled with V */
+    Capture capture;
+    unsigned int captureEvery;
+    std::string capturePattern;
+    std::string recordPath;
+
 } sScene;
 
 struct
@@ -56,7 +182,74 @@ struct
     bool keyPressed[Boat::eControl::CONTROL_COUNT] = {false, false, false, false};
 } sInput;
 
-void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+/* the GLFW callbacks write live input to recorder while it is open; while replaying, live input except escape is
+ * ignored and the input handlers get the recorded events instead */
+struct
+{
+    InputRecorder recorder;
+    InputReplay replay;
+    bool replaying = false;
+
+    /* replay with this dt instead of the recorded one, 0 keeps the recording's */
+    float fixedDt = 0.0f;
+} sInputLog;
+
+/* sun and sky colors of the day and night setting */
+void setDaylight(bool day)
+{
+    if(day)
+    {
+        sScene.lightSun.ambient = { 0.2, 0.2, 0.2 };
+        sScene.lightSun.color = { 0.7, 0.7, 0.7 };
+    }
+    else
+    {
+        sScene.lightSun.ambient = { 0.0, 0.0, 0.1 };
+        sScene.lightSun.color = { 0.1, 0.1, 0.2 };
+    }
+    sScene.isDay = day;
+}
+
+/* writer and queue statistics of the current or last recording */
+void printRecordStats()
+{
+    VideoWriterStats video = captureStats(sScene.capture).video;
+    unsigned int frames = std::max(1u, video.frames);
+    printf("Recorded %u frames (%.1f MB), %u dropped by the full queue, queue length mean %.2f max %zu, writer %.3f ms convert + %.3f ms write per frame\n",
+           video.frames, video.bytes / 1e6, video.dropped, double(video.queueDepthSum) / frames, video.queueDepthMax,
+           1e3 * video.convertTime / frames, 1e3 * video.writeTime / frames);
+}
+
+/* read system calls and bytes of the process so far, zero where /proc/self/io isn't available */
+struct ReadCounters
+{
+    unsigned long long calls = 0;
+    unsigned long long bytes = 0;
+};
+
+ReadCounters readCounters()
+{
+    ReadCounters counters;
+#ifdef __linux__
+    std::ifstream io("/proc/self/io");
+    std::string name;
+    unsigned long long value;
+    while(io >> name >> value)
+    {
+        if(name == "syscr:")
+        {
+            counters.calls = value;
+        }
+        else if(name == "rchar:")
+        {
+            counters.bytes = value;
+        }
+    }
+#endif
+    return counters;
+}
+
+void keyInput(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
     /* input for camera control */
     if(key == GLFW_KEY_0 && action == GLFW_PRESS)
@@ -84,20 +277,21 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
         sScene.useBinarySearch = !sScene.useBinarySearch;
     }
 
+    if(key == GLFW_KEY_I && action == GLFW_PRESS)
+    {
+        sScene.useIndirect = !sScene.useIndirect && drawIndirectSupported();
+    }
+
     /* night light setting */
     if(key == GLFW_KEY_N && action == GLFW_PRESS)
     {
-        sScene.lightSun.ambient = { 0.0, 0.0, 0.1 };
-        sScene.lightSun.color = { 0.1, 0.1, 0.2 };
-        sScene.isDay = false;
+        setDaylight(false);
     }
 
     /* day light setting */
     if(key == GLFW_KEY_M && action == GLFW_PRESS)
     {
-        sScene.lightSun.ambient = { 0.2, 0.2, 0.2 };
-        sScene.lightSun.color = { 0.7, 0.7, 0.7 };
-        sScene.isDay = true;
+        setDaylight(true);
     }
 
     /* toggle boat lights */
@@ -137,11 +331,61 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
     /* make screenshot and save in work directory */
     if(key == GLFW_KEY_P && action == GLFW_PRESS)
     {
-        screenshotToPNG("screenshot.png");
+        captureScreenshot(sScene.capture, "screenshot.png");
+    }
+
+    /* start or stop the continuous capture */
+    if(key == GLFW_KEY_R && action == GLFW_PRESS)
+    {
+        bool start = sScene.capture.every == 0;
+        captureContinuous(sScene.capture, start ? sScene.captureEvery : 0, sScene.capturePattern);
+        printf("Capture %s\n", start ? ("started, writing " + sScene.capturePattern).c_str() : "stopped");
+    }
+
+    /* memory view of the render target pool */
+    if(key == GLFW_KEY_F && action == GLFW_PRESS)
+    {
+        renderTargetPoolPrint(sScene.renderTargets);
+    }
+
+    /* start or stop recording a video */
+    if(key == GLFW_KEY_V && action == GLFW_PRESS)
+    {
+        if(sScene.capture.recording)
+        {
+            captureRecordStop(sScene.capture);
+            printRecordStats();
+        }
+        else if(captureRecordStart(sScene.capture, sScene.recordPath, 60))
+        {
+            printf("Recording %s\n", sScene.recordPath.c_str());
+        }
+        else
+        {
+            std::cerr << "Couldn't record " << sScene.recordPath << std::endl;
+        }
+    }
+
+    /* start the profiler, or write what it recorded so far */
+    if(key == GLFW_KEY_T && action == GLFW_PRESS)
+    {
+        if(!gProfiler.enabled)
+        {
+            profilerEnable(true);
+            printf("Profiler recording, press T again to write %s\n", sScene.tracePath.c_str());
+        }
+        else if(profilerWriteChromeTrace(sScene.tracePath))
+        {
+            printf("Profiler trace written to %s\n", sScene.tracePath.c_str());
+        }
+        else
+        {
+            std::cerr << "Couldn't write profiler trace " << sScene.tracePath << std::endl;
+        }
     }
 }
 
-void mousePosCallback(GLFWwindow* window, double x, double y)
+void cursorInput(float x, float y)
 {
     if(sInput.mouseButtonPressed)
     {
@@ -151,42 +395,173 @@ void mousePosCallback(GLFWwindow* window, double x, double y)
     }
 }
 
-void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+void mouseButtonInput(int button, int action, float x, float y)
 {
     if(button == GLFW_MOUSE_BUTTON_LEFT)
     {
         sInput.mouseButtonPressed = (action == GLFW_PRESS);
-
-        double x, y;
-        glfwGetCursorPos(window, &x, &y);
         sInput.mousePressStart = Vector2D(x, y);
     }
 }
 
-void mouseScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
+void scrollInput(double xoffset, double yoffset)
 {
     cameraUpdateOrbit(sScene.camera, {0, 0}, sScene.zoomSpeedMultiplier * yoffset);
 }
 
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    if(sInputLog.replaying && key != GLFW_KEY_ESCAPE)
+    {
+        return;
+    }
+    inputRecordKey(sInputLog.recorder, key, scancode, action, mods);
+    keyInput(window, key, scancode, action, mods);
+}
+
+void mousePosCallback(GLFWwindow* window, double x, double y)
+{
+    if(!sInputLog.replaying)
+    {
+        inputRecordCursor(sInputLog.recorder, x, y);
+        cursorInput(x, y);
+    }
+}
+
+void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+    double x, y;
+    glfwGetCursorPos(window, &x, &y);
+    if(!sInputLog.replaying)
+    {
+        inputRecordMouseButton(sInputLog.recorder, button, action, mods, x, y);
+        mouseButtonInput(button, action, x, y);
+    }
+}
+
+void mouseScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    if(!sInputLog.replaying)
+    {
+        inputRecordScroll(sInputLog.recorder, xoffset, yoffset);
+        scrollInput(xoffset, yoffset);
+    }
+}
+
+/* feed the recorded events of the next frame to the input handlers and replace dt with the recorded or fixed one,
+ * false once the replay is over */
+bool replayNextFrame(GLFWwindow* window, float& dt)
+{
+    std::span<const InputEvent> events;
+    if(!inputReplayFrame(sInputLog.replay, events, dt))
+    {
+        return false;
+    }
+
+    for(const auto& event : events)
+    {
+        switch(event.type)
+        {
+        case INPUT_KEY:
+            keyInput(window, event.code, event.scancode, event.action, event.mods);
+            break;
+        case INPUT_MOUSE_BUTTON:
+            mouseButtonInput(event.code, event.action, event.x, event.y);
+            break;
+        case INPUT_CURSOR:
+            cursorInput(event.x, event.y);
+            break;
+        case INPUT_SCROLL:
+            scrollInput(event.x, event.y);
+            break;
+        default:
+            break;
+        }
+    }
+
+    if(sInputLog.fixedDt > 0.0f)
+    {
+        dt = sInputLog.fixedDt;
+    }
+    return true;
+}
+
 
 void windowResizeCallback(GLFWwindow* window, int width, int height)
 {
     glViewport(0, 0, width, height);
     sScene.camera.width = width;
     sScene.camera.height = height;
-//    delete framebuffer and create a new one with adjusted dimension
-    deleteFramebuffer(sScene.customFramebuffer);
-    sScene.customFramebuffer = createFramebuffer(width, height);
+    renderTargetPoolResize(sScene.renderTargets, width, height);
 }
 
 void sceneInit(float width, float height)
 {
+    PROFILE_ZONE("sceneInit");
+
     sScene.camera = cameraCreate(width, height, to_radians(45.0), 0.01, 500.0, {10.0, 10.0, 10.0}, {0.0, 0.0, 0.0});
     sScene.cameraFollowBoat = true;
     sScene.zoomSpeedMultiplier = 0.05f;
 
-    sScene.boat = boatLoad("assets/boat/boat.obj");
-    sScene.modelWater = modelLoad("assets/water_01/water.obj").front();
+    /* the arenas grow on demand, the initial sizes only avoid reallocating while the scene is loaded */
+    if(sScene.packedVertices)
+    {
+        sScene.meshArena = meshArenaCreate(sizeof(PackedVertex), meshPackedVertexAttributes, 1 << 16, 1 << 16);
+    }
+    else
+    {
+        sScene.meshArena = meshArenaCreate(sizeof(Vertex), meshVertexAttributes, 1 << 16, 1 << 16);
+    }
+    sScene.skyboxArena = meshArenaCreate(sizeof(Vector3D), meshCubeMapVertexAttributes, 8, 36);
+
+    sScene.boat = boatLoad("assets/boat/boat.obj", {.arena = &sScene.meshArena, .packed = sScene.packedVertices, .optimize = sScene.optimizeMeshes, .lodCount = MODEL_LOD_MAX, .jobs = &sScene.jobs});
+    for(const auto& model : sScene.boat.partModel)
+    {
+        const MeshOptimizeStats& stats = model.optimizeStats;
+        if(stats.triangles > 0)
+        {
+            printf("Mesh %s: %u triangles, %u -> %u vertices, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", model.name.c_str(),
+                   stats.triangles, stats.inputVertices, stats.outputVertices, stats.before.acmr, stats.after.acmr, stats.before.atvr, stats.after.atvr);
+        }
+        for(unsigned int level = 0; level < model.lodCount; level++)
+        {
+            unsigned int triangles = 0;
+            for(const auto& material : model.material)
+            {
+                triangles += material.lod[level].count / 3;
+            }
+            printf("  LOD %u: %u triangles, error %.4f (%.3f%% of the radius)\n", level, triangles, model.lodError[level], 100.0f * model.lodError[level] / model.bounds.radius);
+        }
+    }
+
+    /* sphere around all part boxes for the per boat test */
+    std::vector<Vector3D> corners(8 * sScene.boat.partModel.size());
+    for(size_t i = 0; i < sScene.boat.partModel.size(); i++)
+    {
+        boundsCorners(sScene.boat.partModel[i].bounds, &corners[8 * i]);
+    }
+    sScene.boatBounds = boundsCreate(corners.data(), corners.size());
+    sScene.waterMaterial = materialLoad("assets/water_01/water.mtl", &sScene.jobs).at("water");
+    sScene.waterGrid = waterGridCreate(sScene.waterGrid.resolution, sScene.waterGrid.chunkSize, sScene.waterGrid.levels, sScene.waterGrid.lodDistance);
+    if(sScene.packedVertices)
+    {
+        /* the grid vertices are the integer positions i / resolution, so they are packed exactly */
+        VertexQuantization grid;
+        grid.scale = Vector3D(1.0f / sScene.waterGrid.resolution, 1.0f, 1.0f / sScene.waterGrid.resolution);
+        sScene.waterMesh = meshCreatePacked(sScene.meshArena, sScene.waterGrid.vertices, sScene.waterGrid.indices, grid);
+    }
+    else
+    {
+        sScene.waterMesh = meshCreate(sScene.meshArena, sScene.waterGrid.vertices, sScene.waterGrid.indices);
+    }
+
+    sScene.boatGroupCount = 0;
+    for(const auto& model : sScene.boat.partModel)
+    {
+        sScene.boatGroupBase.push_back(sScene.boatGroupCount);
+        sScene.boatGroupCount += model.material.size();
+    }
+    sScene.draws = drawIndirectCreate(sScene.meshArena);
 
     sScene.renderBlinnPhong = true;
 
@@ -199,18 +574,27 @@ void sceneInit(float width, float height)
     sScene.lightSpots[2] = { .position = { 0.3, 1.63,  1.43}, .direction = spotLight, .color = {1.0, 1.0, 1.0}, .constant = 1.0, .linear = 0.14, .quadratic = 0.07, .cutoff = to_radians(75.0f) };
     sScene.lightSpots[3] = { .position = {-0.3, 1.63,  1.43}, .direction = spotLight, .color = {1.0, 1.0, 1.0}, .constant = 1.0, .linear = 0.14, .quadratic = 0.07, .cutoff = to_radians(75.0f) };
 
-    sScene.skybox = cubeMapCreate(cube::vertexPos, cube::indices, {"assets/kloofendal_48d_partly_cloudy/px.png", "assets/kloofendal_48d_partly_cloudy/nx.png", "assets/kloofendal_48d_partly_cloudy/py.png", "assets/kloofendal_48d_partly_cloudy/ny.png", "assets/kloofendal_48d_partly_cloudy/pz.png", "assets/kloofendal_48d_partly_cloudy/nz.png"});
+    sScene.skybox = cubeMapCreate(cube::vertexPos, cube::indices, {"assets/kloofendal_48d_partly_cloudy/px.png", "assets/kloofendal_48d_partly_cloudy/nx.png", "assets/kloofendal_48d_partly_cloudy/py.png", "assets/kloofendal_48d_partly_cloudy/ny.png", "assets/kloofendal_48d_partly_cloudy/pz.png", "assets/kloofendal_48d_partly_cloudy/nz.png"}, &sScene.skyboxArena, &sScene.jobs);
+
+    MeshArenaStats arena = meshArenaStats(sScene.meshArena);
+    size_t vertexBytes = size_t(sScene.meshArena.vertices.used) * sScene.meshArena.vertexSize;
+    printf("Mesh arena: %u meshes, %.2f MiB in use, %.2f MiB allocated, %s vertices %.2f MiB (%.2f MiB as float vertices)\n",
+           arena.meshCount, arena.bytesInUse / 1048576.0, arena.bytesAllocated / 1048576.0,
+           sScene.packedVertices ? "packed" : "float", vertexBytes / 1048576.0,
+           size_t(sScene.meshArena.vertices.used) * sizeof(Vertex) / 1048576.0);
 
-    sScene.shaderColor = shaderLoad("shader/default.vert", "shader/color.frag");
-    sScene.shaderWaterColor = shaderLoad("shader/water.vert", "shader/color.frag");
-    sScene.shaderWater = shaderLoad("shader/water.vert", "shader/blinn_phong_water.frag");
-    sScene.shaderBlinnPhong = shaderLoad("shader/default.vert", "shader/blinn_phong.frag");
+    std::string defines = sScene.packedVertices ? "#define PACKED_VERTICES\n" : "";
+    sScene.shaderColor = shaderLoad("shader/default.vert", "shader/color.frag", defines);
+    sScene.shaderWaterColor = shaderLoad("shader/water.vert", "shader/color.frag", defines);
+    sScene.shaderWater = shaderLoad("shader/water.vert", "shader/blinn_phong_water.frag", defines);
+    sScene.shaderBlinnPhong = shaderLoad("shader/default.vert", "shader/blinn_phong.frag", defines);
     sScene.shaderSkybox = shaderLoad("shader/skybox.vert", "shader/skybox.frag");
 
-    sScene.customFramebuffer = createFramebuffer(width, height);
+    sScene.renderTargets = renderTargetPoolCreate(width, height);
     sScene.useBinarySearch = true;
 
 //    for getting gpu time
+    sScene.gpuProfiler = gpuProfilerCreate();
     glGenQueries(1, &sScene.query.values[sScene.query.backBuffer]);
     glGenQueries(1, &sScene.query.values[sScene.query.frontBuffer]);
 //    dummy query for first access
@@ -220,11 +604,55 @@ void sceneInit(float width, float height)
 
 void sceneUpdate(float dt)
 {
-    sScene.waterSim.accumTime += dt;
-    boatMove(sScene.boat, sScene.waterSim, sInput.keyPressed, dt);
+    PROFILE_ZONE("sceneUpdate");
+
+    /* GL work that jobs handed to the main thread since the last frame */
+    jobRunMain(sScene.jobs);
+
+    simulationSetControl(sScene.simulation, sInput.keyPressed);
+    simulationAdvance(sScene.simulation, dt);
+
+    /* render the interpolated state between the two latest fixed steps */
+    SimSnapshot& snapshot = sScene.simFrame;
+    simulationSample(sScene.simulation, snapshot);
+    sScene.boat.state = snapshot.boat;
+    sScene.boat.transformation = boatTransformation(snapshot.boat);
+    sScene.waterSim.accumTime = snapshot.waterTime;
+
+    const SimStats& stats = sScene.simulation.stats;
+    if(stats.reportReady)
+    {
+        printf("Simulation: %.2f steps per frame, %.3f ms per step, %.1f%% %s utilization\n",
+               stats.stepsPerFrame, stats.stepTime * 1000.0, stats.utilization * 100.0,
+               sScene.simulation.threaded ? "thread" : "main thread");
+
+        CullStats& cull = sScene.cullStats;
+        if(cull.frames > 0)
+        {
+            printf("Culling: %u/%u boats, %u/%u boat parts, %u/%u water chunks (%u vertices) drawn, %.3f ms per frame\n",
+                   cull.instancesDrawn, cull.instancesDrawn + cull.instancesCulled,
+                   cull.partsDrawn, cull.partsDrawn + cull.partsCulled,
+                   cull.waterDrawn, cull.waterDrawn + cull.waterCulled, cull.waterVertices,
+                   cull.cullTime * 1000.0 / cull.frames);
+            printf("LOD: %u boat triangles drawn, parts per level %u/%u/%u/%u\n", cull.boatTriangles,
+                   cull.partsPerLod[0], cull.partsPerLod[1], cull.partsPerLod[2], cull.partsPerLod[3]);
+            cull.cullTime = 0.0;
+            cull.frames = 0;
+        }
+
+        SubmitStats& submit = sScene.submitStats;
+        if(submit.frames > 0)
+        {
+            printf("Submit: %s, %u draw calls, %.3f ms CPU per frame\n",
+                   sScene.useIndirect ? "multi draw indirect" : "draw loop", submit.drawCalls,
+                   submit.submitTime * 1000.0 / submit.frames);
+            submit.submitTime = 0.0;
+            submit.frames = 0;
+        }
+    }
 
     if (sScene.cameraFollowBoat)
-        cameraFollow(sScene.camera, sScene.boat.position);
+        cameraFollow(sScene.camera, sScene.boat.state.position);
 }
 
 void swapQueryBuffers() {
@@ -237,14 +665,240 @@ void swapQueryBuffers() {
     }
 }
 
+/* world space positions and directions of the boat's spotlights, transformed as one batch */
+void lightSpotsWorld(Vector3D position[4], Vector3D direction[4])
+{
+    for(int i = 0; i < 4; i++)
+    {
+        position[i] = sScene.lightSpots[i].position;
+        direction[i] = sScene.lightSpots[i].direction;
+    }
+
+    transformPoints(sScene.boat.transformation, position, position, 4);
+    transformDirections(sScene.boat.transformation, direction, direction, 4);
+}
+
+/* frustum culling of all boats, their parts and the water, fills the draw lists of the frame */
+void sceneCull()
+{
+    PROFILE_ZONE("sceneCull");
+
+    auto start = std::chrono::steady_clock::now();
+    Frustum frustum = cameraFrustum(sScene.camera);
+
+    auto& instances = sScene.instances;
+    instances.clear();
+    instances.push_back(sScene.boat.transformation);
+    instances.insert(instances.end(), sScene.simFrame.fleet.begin(), sScene.simFrame.fleet.end());
+
+    /* whole boats against their bounding spheres. The fleet matrices are linear blends of two rigid transformations,
+     * which only shrink lengths, so the unscaled radius stays conservative */
+    auto& spheres = sScene.cullSpheres;
+    spheres.resize(instances.size());
+    for(size_t i = 0; i < instances.size(); i++)
+    {
+        spheres[i] = Vector4D(Vector3D(instances[i] * Vector4D(sScene.boatBounds.center, 1.0f)), sScene.boatBounds.radius);
+    }
+    auto& visible = sScene.cullVisible;
+    visible.resize(instances.size());
+    size_t visibleCount = frustumCullSpheres(frustum, spheres.data(), spheres.size(), visible.data());
+
+    /* parts of the remaining boats against their world space boxes, the level of detail of a part follows from its
+     * radius on screen at the distance of the boat */
+    auto& candidates = sScene.cullCandidates;
+    auto& bounds = sScene.cullBounds;
+    candidates.clear();
+    bounds.clear();
+    for(size_t i = 0; i < visibleCount; i++)
+    {
+        const Matrix4D& M = instances[visible[i]];
+        for(uint32_t part = 0; part < sScene.boat.partModel.size(); part++)
+        {
+            const Model& model = sScene.boat.partModel[part];
+            float screenRadius = cameraScreenRadius(sScene.camera, Vector3D(spheres[visible[i]]), model.bounds.radius);
+            uint32_t lod = modelSelectLod(model, screenRadius, sScene.lodThreshold);
+
+            const auto& materials = model.material;
+            for(uint32_t material = 0; material < materials.size(); material++)
+            {
+                candidates.push_back({visible[i], part, material, lod});
+                bounds.push_back(boundsTransform(materials[material].bounds, M));
+            }
+        }
+    }
+    auto& visibleParts = sScene.cullVisibleCandidates;
+    visibleParts.resize(candidates.size());
+    size_t visiblePartCount = frustumCullBoxes(frustum, bounds.data(), bounds.size(), visibleParts.data());
+
+    sScene.visibleParts.resize(visiblePartCount);
+    for(size_t i = 0; i < visiblePartCount; i++)
+    {
+        sScene.visibleParts[i] = candidates[visibleParts[i]];
+    }
+
+    /* water chunks around the camera, grown by the maximal wave height the vertex shader adds */
+    float waveHeight = 0.0f;
+    for(const auto& wave : sScene.waterSim.parameter)
+    {
+        waveHeight += std::abs(wave.amplitude);
+    }
+    waterGridSelect(sScene.waterGrid, sScene.camera.position, waveHeight);
+
+    const auto& chunks = sScene.waterGrid.chunks;
+    auto& chunkBounds = sScene.cullChunkBounds;
+    chunkBounds.resize(chunks.size());
+    for(size_t i = 0; i < chunks.size(); i++)
+    {
+        chunkBounds[i] = chunks[i].bounds;
+    }
+    sScene.waterVisible.resize(chunks.size());
+    size_t waterDrawn = frustumCullBoxes(frustum, chunkBounds.data(), chunkBounds.size(), sScene.waterVisible.data());
+    sScene.waterVisible.resize(waterDrawn);
+
+    size_t partsPerBoat = candidates.size() / std::max<size_t>(visibleCount, 1);
+    CullStats& stats = sScene.cullStats;
+    stats.instancesDrawn = visibleCount;
+    stats.instancesCulled = instances.size() - visibleCount;
+    stats.partsDrawn = visiblePartCount;
+    stats.boatTriangles = 0;
+    std::fill(std::begin(stats.partsPerLod), std::end(stats.partsPerLod), 0);
+    for(const auto& item : sScene.visibleParts)
+    {
+        stats.boatTriangles += sScene.boat.partModel[item.part].material[item.material].lod[item.lod].count / 3;
+        stats.partsPerLod[item.lod]++;
+    }
+    stats.partsCulled = candidates.size() - visiblePartCount + stats.instancesCulled * partsPerBoat;
+    stats.waterDrawn = waterDrawn;
+    stats.waterCulled = chunks.size() - waterDrawn;
+    stats.waterVertices = waterDrawn * sScene.waterGrid.vertices.size();
+    stats.cullTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.frames++;
+}
+
+/* model matrices of all boats and visible water chunks, and with indirect submission the commands sorted by material */
+void sceneBuildDraws()
+{
+    DrawIndirect& draws = sScene.draws;
+    drawIndirectClear(draws);
+
+    draws.matrices = sScene.instances;
+    for(uint32_t index : sScene.waterVisible)
+    {
+        draws.matrices.push_back(waterChunkTransformation(sScene.waterGrid.chunks[index]));
+    }
+
+    if(sScene.useIndirect)
+    {
+        /* counting sort of the visible parts by material group */
+        auto& start = sScene.groupStart;
+        start.assign(sScene.boatGroupCount + 1, 0);
+        for(const auto& item : sScene.visibleParts)
+        {
+            start[sScene.boatGroupBase[item.part] + item.material + 1]++;
+        }
+        for(uint32_t g = 0; g < sScene.boatGroupCount; g++)
+        {
+            start[g + 1] += start[g];
+        }
+
+        auto& order = sScene.drawOrder;
+        auto& cursor = sScene.drawCursor;
+        order.resize(sScene.visibleParts.size());
+        cursor.assign(start.begin(), start.end() - 1);
+        for(uint32_t i = 0; i < sScene.visibleParts.size(); i++)
+        {
+            const auto& item = sScene.visibleParts[i];
+            order[cursor[sScene.boatGroupBase[item.part] + item.material]++] = i;
+        }
+
+        for(uint32_t i : order)
+        {
+            const auto& item = sScene.visibleParts[i];
+            const auto& material = sScene.boat.partModel[item.part].material[item.material];
+            drawIndirectAdd(draws, sScene.boat.partModel[item.part].mesh, material.lod[item.lod].offset, material.lod[item.lod].count, item.instance);
+        }
+
+        /* water chunks follow the last boat group */
+        for(uint32_t i = 0; i < sScene.waterVisible.size(); i++)
+        {
+            const WaterChunk& chunk = sScene.waterGrid.chunks[sScene.waterVisible[i]];
+            drawIndirectAdd(draws, sScene.waterMesh, sScene.waterGrid.variantOffset[chunk.stitch], sScene.waterGrid.variantCount[chunk.stitch], sScene.instances.size() + i);
+        }
+    }
+
+    drawIndirectUpload(draws);
+    drawIndirectBindMatrices(draws, 7);
+}
+
+/* visible water chunks with the bound water shader, all share one mesh and differ in model matrix and stitch variant */
+void renderWaterChunks()
+{
+    PROFILE_GPU_ZONE(sScene.gpuProfiler, "renderWaterChunks");
+
+    auto start = std::chrono::steady_clock::now();
+    if(sScene.useIndirect)
+    {
+        drawIndirectBindArena(sScene.meshArena, true);
+        drawIndirectSubmit(sScene.draws, sScene.groupStart[sScene.boatGroupCount], sScene.waterVisible.size());
+        sScene.submitStats.drawCalls += !sScene.waterVisible.empty();
+    }
+    else
+    {
+        drawIndirectBindArena(sScene.meshArena, false);
+        for(uint32_t i = 0; i < sScene.waterVisible.size(); i++)
+        {
+            const WaterChunk& chunk = sScene.waterGrid.chunks[sScene.waterVisible[i]];
+            glVertexAttribI4ui(eDataIdx::Instance, sScene.instances.size() + i, 0, 0, 0);
+            glDrawElementsBaseVertex(GL_TRIANGLES, sScene.waterGrid.variantCount[chunk.stitch], GL_UNSIGNED_INT,
+                                     (const void*) ((sScene.waterMesh.firstIndex + sScene.waterGrid.variantOffset[chunk.stitch])*sizeof(unsigned int)), sScene.waterMesh.baseVertex);
+            sScene.submitStats.drawCalls++;
+        }
+    }
+    sScene.submitStats.submitTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* position decoding of a packed mesh, see default.vert */
+void bindQuantization(ShaderProgram& shader, const VertexQuantization& quantization)
+{
+    shaderUniform(shader, "uPositionOffset", quantization.offset);
+    shaderUniform(shader, "uPositionScale", quantization.scale);
+}
+
+/* material uniforms and textures of a boat part for the Blinn-Phong shader */
+void bindBoatMaterial(const Material& material)
+{
+    shaderUniform(sScene.shaderBlinnPhong, "uMaterial.shininess", material.shininess);
+
+//            Bind Textures and pass them to the shader
+//            Because we draw the elements in each iteration, we can overwrite the GL_TEXTURE
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, material.map_diffuse.id);
+    shaderUniform(sScene.shaderBlinnPhong, "uMaterial.diffuse", 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, material.map_specular.id);
+    shaderUniform(sScene.shaderBlinnPhong, "uMaterial.specular", 1);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, material.map_normal.id);
+    shaderUniform(sScene.shaderBlinnPhong, "uMaterial.normal", 2);
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D, material.map_ambient.id);
+    shaderUniform(sScene.shaderBlinnPhong, "uMaterial.ambient", 3);
+
+    /*---- reflection ----*/
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, sScene.skybox.texture.id);
+    shaderUniform(sScene.shaderBlinnPhong, "uSkybox", 4);
+}
+
 void renderBoat() {
+    PROFILE_GPU_ZONE(sScene.gpuProfiler, "renderBoat");
+
     Matrix4D proj = cameraProjection(sScene.camera);
     Matrix4D view = cameraView(sScene.camera);
 
     glUseProgram(sScene.shaderBlinnPhong.id);
     shaderUniform(sScene.shaderBlinnPhong, "uProj",  proj);
     shaderUniform(sScene.shaderBlinnPhong, "uView",  view);
-    shaderUniform(sScene.shaderBlinnPhong, "uModel",  sScene.boat.transformation);
     shaderUniform(sScene.shaderBlinnPhong, "uViewPos", sScene.camera.position);
 
     /* set directional light source */
@@ -253,14 +907,13 @@ void renderBoat() {
     shaderUniform(sScene.shaderBlinnPhong, "uLightSun.color", sScene.lightSun.color);
 
     /* set boat's spotlights */
+    Vector3D lightPos[4], lightDir[4];
+    lightSpotsWorld(lightPos, lightDir);
     for(int i = 0; i < 4; i++)
     {
-        Vector4D pos = sScene.boat.transformation * Vector4D(sScene.lightSpots[i].position);
-        Vector4D dir = Matrix4D(Matrix3D(sScene.boat.transformation)) * Vector4D(sScene.lightSpots[i].direction);
-
         std::string light = "uLightSpots[" + std::to_string(i) + "]";
-        shaderUniform(sScene.shaderBlinnPhong, light + ".position", Vector3D{pos.x, pos.y, pos.z});
-        shaderUniform(sScene.shaderBlinnPhong, light + ".direction", Vector3D{dir.x, dir.y, dir.z});
+        shaderUniform(sScene.shaderBlinnPhong, light + ".position", lightPos[i]);
+        shaderUniform(sScene.shaderBlinnPhong, light + ".direction", lightDir[i]);
         shaderUniform(sScene.shaderBlinnPhong, light + ".color", sScene.lightSpots[i].color);
         shaderUniform(sScene.shaderBlinnPhong, light + ".constant", sScene.lightSpots[i].constant);
         shaderUniform(sScene.shaderBlinnPhong, light + ".linear", sScene.lightSpots[i].linear);
@@ -269,61 +922,79 @@ void renderBoat() {
         shaderUniform(sScene.shaderBlinnPhong, light + ".enabled", sScene.lightSpots[i].enabled);
     }
 
-    for(unsigned int i = 0; i < sScene.boat.partModel.size(); i++)
-    {
-        auto& model = sScene.boat.partModel[i];
-        glBindVertexArray(model.mesh.vao);
-
-        shaderUniform(sScene.shaderBlinnPhong, "uModel", sScene.boat.transformation);
+    shaderUniform(sScene.shaderBlinnPhong, "uInstances", 7);
 
-        for(auto& material : model.material){
-
-            shaderUniform(sScene.shaderBlinnPhong, "uMaterial.shininess", material.shininess);
-
-//            Bind Textures and pass them to the shader
-//            Because we draw the elements in each iteration, we can overwrite the GL_TEXTURE
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, material.map_diffuse.id);
-            shaderUniform(sScene.shaderBlinnPhong, "uMaterial.diffuse", 0);
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, material.map_specular.id);
-            shaderUniform(sScene.shaderBlinnPhong, "uMaterial.specular", 1);
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, material.map_normal.id);
-            shaderUniform(sScene.shaderBlinnPhong, "uMaterial.normal", 2);
-            glActiveTexture(GL_TEXTURE3);
-            glBindTexture(GL_TEXTURE_2D, material.map_ambient.id);
-            shaderUniform(sScene.shaderBlinnPhong, "uMaterial.ambient", 3);
-
-            /*---- reflection ----*/
-            glActiveTexture(GL_TEXTURE4);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, sScene.skybox.texture.id);
-            shaderUniform(sScene.shaderBlinnPhong, "uSkybox", 4);
-
-            glDrawElements(GL_TRIANGLES, material.indexCount, GL_UNSIGNED_INT, (const void*) (material.indexOffset*sizeof(unsigned int)) );
+    auto start = std::chrono::steady_clock::now();
+    if(sScene.useIndirect)
+    {
+        /* one multi draw per material, over all visible boats */
+        drawIndirectBindArena(sScene.meshArena, true);
+        for(uint32_t part = 0; part < sScene.boat.partModel.size(); part++)
+        {
+            const auto& materials = sScene.boat.partModel[part].material;
+            for(uint32_t m = 0; m < materials.size(); m++)
+            {
+                uint32_t group = sScene.boatGroupBase[part] + m;
+                uint32_t count = sScene.groupStart[group + 1] - sScene.groupStart[group];
+                if(count == 0)
+                {
+                    continue;
+                }
+
+                bindQuantization(sScene.shaderBlinnPhong, sScene.boat.partModel[part].mesh.quantization);
+                bindBoatMaterial(materials[m]);
+                drawIndirectSubmit(sScene.draws, sScene.groupStart[group], count);
+                sScene.submitStats.drawCalls++;
+            }
+        }
+    }
+    else
+    {
+        /* visible parts are grouped by boat, so the model matrix only changes between runs */
+        drawIndirectBindArena(sScene.meshArena, false);
+        uint32_t instance = ~0u;
+        for(const auto& item : sScene.visibleParts)
+        {
+            if(item.instance != instance)
+            {
+                instance = item.instance;
+                glVertexAttribI4ui(eDataIdx::Instance, instance, 0, 0, 0);
+            }
+
+            const Mesh& mesh = sScene.boat.partModel[item.part].mesh;
+            auto& material = sScene.boat.partModel[item.part].material[item.material];
+            bindQuantization(sScene.shaderBlinnPhong, mesh.quantization);
+            bindBoatMaterial(material);
+
+            const Range& range = material.lod[item.lod];
+            glDrawElementsBaseVertex(GL_TRIANGLES, range.count, GL_UNSIGNED_INT, (const void*) ((mesh.firstIndex + range.offset)*sizeof(unsigned int)), mesh.baseVertex);
+            sScene.submitStats.drawCalls++;
         }
     }
+    sScene.submitStats.submitTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 }
 
 void renderBlinnPhong()
 {
-//    get gpu time
-    GLuint64 time;
-    glBeginQuery(GL_TIME_ELAPSED, sScene.query.values[sScene.query.backBuffer]);
+    PROFILE_GPU_ZONE(sScene.gpuProfiler, "renderBlinnPhong");
 
     /* setup camera and model matrices */
     Matrix4D proj = cameraProjection(sScene.camera);
     Matrix4D view = cameraView(sScene.camera);
 
-    /*--------------------- render boat into custom framebuffer ---------------------*/
+    /*--------------------- render boat into a pooled target ---------------------*/
 
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, sScene.customFramebuffer.id);
+    RenderTarget boatTarget = renderTargetAcquire(sScene.renderTargets, "ssr boat", sScene.ssrColorFormat, sScene.ssrDepthFormat);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, boatTarget.fbo);
+    glViewport(0, 0, boatTarget.width, boatTarget.height);
     glClearColor(0., 0., 0., 1.);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     renderBoat();
 
+    /* the target lags behind the window while resizing, the water samples it by screen uv either way */
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glViewport(0, 0, sScene.camera.width, sScene.camera.height);
 
     /*--------------------- render water ---------------------*/
 
@@ -332,7 +1003,6 @@ void renderBlinnPhong()
     shaderUniform(sScene.shaderWater, "uProj",  proj);
     shaderUniform(sScene.shaderWater, "uView",  view);
     shaderUniform(sScene.shaderWater, "uViewPos", sScene.camera.position);
-    shaderUniform(sScene.shaderWater, "uModel", Matrix4D::identity());
 
     /* set directional light source */
     shaderUniform(sScene.shaderWater, "uLightSun.direction", sScene.lightSun.direction);
@@ -340,14 +1010,13 @@ void renderBlinnPhong()
     shaderUniform(sScene.shaderWater, "uLightSun.color", sScene.lightSun.color);
 
     /* set boat's spotlights */
+    Vector3D lightPos[4], lightDir[4];
+    lightSpotsWorld(lightPos, lightDir);
     for(int i = 0; i < 4; i++)
     {
-        Vector4D pos = sScene.boat.transformation * Vector4D(sScene.lightSpots[i].position);
-        auto dir = Matrix3D(sScene.boat.transformation) * sScene.lightSpots[i].direction;
-
         std::string light = "uLightSpots[" + std::to_string(i) + "]";
-        shaderUniform(sScene.shaderWater, light + ".position", Vector3D{pos.x, pos.y, pos.z});
-        shaderUniform(sScene.shaderWater, light + ".direction", Vector3D{dir.x, dir.y, dir.z});
+        shaderUniform(sScene.shaderWater, light + ".position", lightPos[i]);
+        shaderUniform(sScene.shaderWater, light + ".direction", lightDir[i]);
         shaderUniform(sScene.shaderWater, light + ".color", sScene.lightSpots[i].color);
         shaderUniform(sScene.shaderWater, light + ".constant", sScene.lightSpots[i].constant);
         shaderUniform(sScene.shaderWater, light + ".linear", sScene.lightSpots[i].linear);
@@ -367,44 +1036,42 @@ void renderBlinnPhong()
         shaderUniform(sScene.shaderWater, wave + ".direction", sScene.waterSim.parameter[i].direction);
     }
 
-    glBindVertexArray(sScene.modelWater.mesh.vao);
-
-    for(auto& material : sScene.modelWater.material)
-    {
-
-        shaderUniform(sScene.shaderWater, "uMaterial.shininess", material.shininess);
+    auto& material = sScene.waterMaterial;
+    shaderUniform(sScene.shaderWater, "uMaterial.shininess", material.shininess);
 
-        // Set uniforms and bind water textures
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, material.map_diffuse.id);
-        shaderUniform(sScene.shaderWater, "uMaterial.diffuse", 0);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, material.map_specular.id);
-        shaderUniform(sScene.shaderWater, "uMaterial.specular", 1);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, material.map_normal.id);
-        shaderUniform(sScene.shaderWater, "uMaterial.normal", 2);
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, material.map_ambient.id);
-        shaderUniform(sScene.shaderWater, "uMaterial.ambient", 3);
-
-        /*---- environment mapping ----*/
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, sScene.skybox.texture.id);
-        shaderUniform(sScene.shaderWater, "uSkybox", 4);
+    // Set uniforms and bind water textures
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, material.map_diffuse.id);
+    shaderUniform(sScene.shaderWater, "uMaterial.diffuse", 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, material.map_specular.id);
+    shaderUniform(sScene.shaderWater, "uMaterial.specular", 1);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, material.map_normal.id);
+    shaderUniform(sScene.shaderWater, "uMaterial.normal", 2);
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D, material.map_ambient.id);
+    shaderUniform(sScene.shaderWater, "uMaterial.ambient", 3);
+
+    /*---- environment mapping ----*/
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, sScene.skybox.texture.id);
+    shaderUniform(sScene.shaderWater, "uSkybox", 4);
 
-        /*-- Screen Space Reflection --*/
+    /*-- Screen Space Reflection --*/
 
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_2D, sScene.customFramebuffer.colorTexture);
-        shaderUniform(sScene.shaderWater, "uBoatColor", 5);
-        glActiveTexture(GL_TEXTURE6);
-        glBindTexture(GL_TEXTURE_2D, sScene.customFramebuffer.depthTexture);
-        shaderUniform(sScene.shaderWater, "uBoatDepth", 6);
-        shaderUniform(sScene.shaderWater, "uUseBinarySearch", sScene.useBinarySearch);
+    glActiveTexture(GL_TEXTURE5);
+    glBindTexture(GL_TEXTURE_2D, boatTarget.colorTexture);
+    shaderUniform(sScene.shaderWater, "uBoatColor", 5);
+    glActiveTexture(GL_TEXTURE6);
+    glBindTexture(GL_TEXTURE_2D, boatTarget.depthTexture);
+    shaderUniform(sScene.shaderWater, "uBoatDepth", 6);
+    shaderUniform(sScene.shaderWater, "uUseBinarySearch", sScene.useBinarySearch);
 
-        glDrawElements(GL_TRIANGLES, material.indexCount, GL_UNSIGNED_INT, (const void*) (material.indexOffset*sizeof(unsigned int)) );
-    }
+    shaderUniform(sScene.shaderWater, "uInstances", 7);
+    bindQuantization(sScene.shaderWater, sScene.waterMesh.quantization);
+    renderWaterChunks();
+    renderTargetRelease(sScene.renderTargets, boatTarget);
 
     /*--------- render boat into default framebuffer --------*/
 
@@ -422,14 +1089,9 @@ void renderBlinnPhong()
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_CUBE_MAP, sScene.skybox.texture.id);
     shaderUniform(sScene.shaderSkybox, "uSkybox", 0);
-    glDrawElements(GL_TRIANGLES, sScene.skybox.mesh.size_ibo, GL_UNSIGNED_INT, nullptr );
+    glDrawElementsBaseVertex(GL_TRIANGLES, sScene.skybox.mesh.size_ibo, GL_UNSIGNED_INT, (const void*) (sScene.skybox.mesh.firstIndex*sizeof(unsigned int)), sScene.skybox.mesh.baseVertex);
     glDepthFunc(GL_LESS);
 
-    glEndQuery(GL_TIME_ELAPSED);
-    glGetQueryObjectui64v(sScene.query.values[sScene.query.frontBuffer], GL_QUERY_RESULT, &time);
-    printf("GPU time elapsed for one frame: %lf ms\n", time / 1000000.0);
-    swapQueryBuffers();
-
     /* cleanup opengl state */
     glBindVertexArray(0);
     glUseProgram(0);
@@ -437,6 +1099,8 @@ void renderBlinnPhong()
 
 void renderColor()
 {
+    PROFILE_GPU_ZONE(sScene.gpuProfiler, "renderColor");
+
     /* setup camera and model matrices */
     Matrix4D proj = cameraProjection(sScene.camera);
     Matrix4D view = cameraView(sScene.camera);
@@ -444,31 +1108,65 @@ void renderColor()
     glUseProgram(sScene.shaderColor.id);
     shaderUniform(sScene.shaderColor, "uProj",  proj);
     shaderUniform(sScene.shaderColor, "uView",  view);
-    shaderUniform(sScene.shaderColor, "uModel",  sScene.boat.transformation);
 
-    /* render boat */
-    for(unsigned int i = 0; i < sScene.boat.partModel.size(); i++)
+    shaderUniform(sScene.shaderColor, "uInstances", 7);
+
+    /* render boats */
+    auto start = std::chrono::steady_clock::now();
+    if(sScene.useIndirect)
+    {
+        drawIndirectBindArena(sScene.meshArena, true);
+        for(uint32_t part = 0; part < sScene.boat.partModel.size(); part++)
+        {
+            const auto& materials = sScene.boat.partModel[part].material;
+            for(uint32_t m = 0; m < materials.size(); m++)
+            {
+                uint32_t group = sScene.boatGroupBase[part] + m;
+                uint32_t count = sScene.groupStart[group + 1] - sScene.groupStart[group];
+                if(count == 0)
+                {
+                    continue;
+                }
+
+                bindQuantization(sScene.shaderColor, sScene.boat.partModel[part].mesh.quantization);
+                shaderUniform(sScene.shaderColor, "uMaterial.diffuse", materials[m].diffuse);
+                drawIndirectSubmit(sScene.draws, sScene.groupStart[group], count);
+                sScene.submitStats.drawCalls++;
+            }
+        }
+    }
+    else
     {
-        auto& model = sScene.boat.partModel[i];
-        glBindVertexArray(model.mesh.vao);
+        drawIndirectBindArena(sScene.meshArena, false);
+        uint32_t instance = ~0u;
+        for(const auto& item : sScene.visibleParts)
+        {
+            if(item.instance != instance)
+            {
+                instance = item.instance;
+                glVertexAttribI4ui(eDataIdx::Instance, instance, 0, 0, 0);
+            }
 
-        shaderUniform(sScene.shaderColor, "uModel", sScene.boat.transformation);
+            const Mesh& mesh = sScene.boat.partModel[item.part].mesh;
+            auto& material = sScene.boat.partModel[item.part].material[item.material];
 
-        for(auto& material : model.material)
-        {
             /* set material properties */
+            bindQuantization(sScene.shaderColor, mesh.quantization);
             shaderUniform(sScene.shaderColor, "uMaterial.diffuse", material.diffuse);
 
-            glDrawElements(GL_TRIANGLES, material.indexCount, GL_UNSIGNED_INT, (const void*) (material.indexOffset*sizeof(unsigned int)) );
+            const Range& range = material.lod[item.lod];
+            glDrawElementsBaseVertex(GL_TRIANGLES, range.count, GL_UNSIGNED_INT, (const void*) ((mesh.firstIndex + range.offset)*sizeof(unsigned int)), mesh.baseVertex);
+            sScene.submitStats.drawCalls++;
         }
     }
+    sScene.submitStats.submitTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
     /* render water */
     glUseProgram(sScene.shaderWaterColor.id);
 
     shaderUniform(sScene.shaderWaterColor, "uProj",  proj);
     shaderUniform(sScene.shaderWaterColor, "uView",  view);
-    shaderUniform(sScene.shaderWaterColor, "uModel", Matrix4D::identity());
+    shaderUniform(sScene.shaderWaterColor, "uMaterial.diffuse", sScene.waterMaterial.diffuse);
 
     /* set wave params */
     shaderUniform(sScene.shaderWaterColor, "time", sScene.waterSim.accumTime);
@@ -481,14 +1179,9 @@ void renderColor()
         shaderUniform(sScene.shaderWaterColor, wave + ".direction", sScene.waterSim.parameter[i].direction);
     }
 
-    glBindVertexArray(sScene.modelWater.mesh.vao);
-
-    for(auto& material : sScene.modelWater.material)
-    {
-        shaderUniform(sScene.shaderWaterColor, "uMaterial.diffuse", material.diffuse);
-
-        glDrawElements(GL_TRIANGLES, material.indexCount, GL_UNSIGNED_INT, (const void*) (material.indexOffset*sizeof(unsigned int)) );
-    }
+    shaderUniform(sScene.shaderWaterColor, "uInstances", 7);
+    bindQuantization(sScene.shaderWaterColor, sScene.waterMesh.quantization);
+    renderWaterChunks();
 
 
     /* cleanup opengl state */
@@ -498,6 +1191,8 @@ void renderColor()
 
 void sceneDraw()
 {
+    PROFILE_ZONE("sceneDraw");
+
     if (sScene.isDay)
     {
         glClearColor(135.0 / 255, 206.0 / 255, 235.0 / 255, 1.0);
@@ -508,7 +1203,19 @@ void sceneDraw()
     }
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    if(renderTargetPoolBeginFrame(sScene.renderTargets))
+    {
+        renderTargetPoolPrint(sScene.renderTargets);
+    }
+
+    sceneCull();
+    sceneBuildDraws();
+    sScene.submitStats.drawCalls = 0;
+    sScene.submitStats.frames++;
+
     /*------------ render scene -------------*/
+//    get gpu time
+    glBeginQuery(GL_TIME_ELAPSED, sScene.query.values[sScene.query.backBuffer]);
     {
         if (sScene.renderBlinnPhong)
         {
@@ -519,14 +1226,488 @@ void sceneDraw()
             renderColor();
         }
     }
+    glEndQuery(GL_TIME_ELAPSED);
 }
 
-int main(int argc, char** argv)
+/* wait for the GPU time of the previous frame, after sceneDraw so the wait is not part of the frame's CPU time */
+void sceneReadGpuTime()
 {
-    /*---------- init window ------------*/
+    PROFILE_ZONE("sceneReadGpuTime");
+
+    glGetQueryObjectui64v(sScene.query.values[sScene.query.frontBuffer], GL_QUERY_RESULT, &sScene.query.elapsed);
+    if(sScene.query.print)
+    {
+        printf("GPU time elapsed for one frame: %lf ms\n", sScene.query.elapsed / 1000000.0);
+    }
+    swapQueryBuffers();
+}
+
+/* input of the scripted --headless run at the given frame: the boat speeds up, turns left, turns right and slows down
+ * in equal quarters while the camera circles it once */
+void headlessScript(unsigned int frame, unsigned int frames)
+{
+    float t = float(frame) / frames;
+    sInput.keyPressed[Boat::eControl::THROTTLE_UP] = t < 0.75f;
+    sInput.keyPressed[Boat::eControl::THROTTLE_DOWN] = t >= 0.75f;
+    sInput.keyPressed[Boat::eControl::RUDDER_LEFT] = t >= 0.25f && t < 0.5f;
+    sInput.keyPressed[Boat::eControl::RUDDER_RIGHT] = t >= 0.5f && t < 0.75f;
+
+    /* a horizontal drag of twice the width is one turn */
+    cameraUpdateOrbit(sScene.camera, {2.0f * sScene.camera.width / frames, 0.0f}, 0.0f);
+}
+
+/* settings of a --headless run */
+struct HeadlessRun
+{
+    unsigned int frames = 600;
     int width = 1280;
     int height = 720;
-    GLFWwindow* window = windowCreate("Project - Screen Space Reflection", width, height);
+    std::string scenario = "default";
+
+    /* the result is also written here if not empty */
+    std::string jsonPath;
+
+    /* the run fails if the p95 of the render thread time spent in captureFrame is above this many milliseconds, 0 is
+     * off */
+    double captureBudget = 0.0;
+};
+
+/**
+ * Benchmark scenarios for --scenario, each a fixed change of the startup scene, which is night with all spot lights
+ * on and screen space reflections with binary search refinement:
+ *  default    - the startup scene
+ *  day        - day light, spot lights off
+ *  ssr_linear - reflections without binary search refinement
+ *  color      - the color only path instead of Blinn-Phong and reflections
+ *  fleet100   - 100 AI boats around the player boat
+ * Checked while parsing the arguments, applied after sceneInit, before the fleet is created.
+ */
+const char* const sceneScenarios[] = {"default", "day", "ssr_linear", "color", "fleet100"};
+
+bool sceneScenarioKnown(const std::string& name)
+{
+    return std::find(std::begin(sceneScenarios), std::end(sceneScenarios), name) != std::end(sceneScenarios);
+}
+
+void sceneApplyScenario(const std::string& name, size_t& fleetSize)
+{
+    if(name == "day")
+    {
+        setDaylight(true);
+        for(auto& light : sScene.lightSpots)
+        {
+            light.enabled = false;
+        }
+    }
+    else if(name == "ssr_linear")
+    {
+        sScene.useBinarySearch = false;
+    }
+    else if(name == "color")
+    {
+        sScene.renderBlinnPhong = false;
+    }
+    else if(name == "fleet100")
+    {
+        fleetSize = 100;
+    }
+}
+
+void headlessWriteJson(FILE* file, const HeadlessRun& run, const std::vector<double>& cpuTimes, const std::vector<double>& gpuTimes,
+                       const std::vector<double>& captureTimes)
+{
+    fprintf(file, "{\"scenario\": \"%s\", \"frames\": %u, \"resolution\": [%d, %d], \"renderer\": \"%s\",\n",
+            run.scenario.c_str(), run.frames, run.width, run.height, (const char*) glGetString(GL_RENDERER));
+    fprintf(file, " \"cpu_ms\": ");
+    frameTimeStatsWriteJson(file, frameTimeStats(cpuTimes));
+    fprintf(file, ",\n \"gpu_ms\": ");
+    frameTimeStatsWriteJson(file, frameTimeStats(gpuTimes));
+    fprintf(file, ",\n \"cpu_histogram\": ");
+    frameTimeHistogramWriteJson(file, frameTimeHistogram(cpuTimes));
+    fprintf(file, ",\n \"gpu_histogram\": ");
+    frameTimeHistogramWriteJson(file, frameTimeHistogram(gpuTimes));
+
+    /* part of cpu_ms, with the recording's backpressure */
+    fprintf(file, ",\n \"capture_ms\": ");
+    frameTimeStatsWriteJson(file, frameTimeStats(captureTimes));
+    CaptureStats capture = captureStats(sScene.capture);
+    fprintf(file, ",\n \"capture\": {\"captured\": %u, \"dropped\": %u, \"video_frames\": %u, \"video_dropped\": %u, "
+            "\"queue_mean\": %.3f, \"queue_max\": %zu, \"convert_ms\": %.4f, \"write_ms\": %.4f, \"bytes\": %llu}",
+            capture.captured, capture.dropped, capture.video.frames, capture.video.dropped,
+            double(capture.video.queueDepthSum) / std::max(1u, capture.video.frames), capture.video.queueDepthMax,
+            1e3 * capture.video.convertTime / std::max(1u, capture.video.frames),
+            1e3 * capture.video.writeTime / std::max(1u, capture.video.frames), capture.video.bytes);
+    fprintf(file, "}\n");
+}
+
+/* run the scripted path with a fixed timestep, or the replayed input with its recorded dts, and print the CPU and GPU
+ * frame times as JSON, false if the capture budget was exceeded */
+bool headlessRun(GLFWwindow* window, const HeadlessRun& run)
+{
+    unsigned int frames = run.frames;
+    const float dt = 1.0f / 60.0f;
+    sScene.query.print = false;
+
+    std::vector<double> cpuTimes, gpuTimes, captureTimes;
+    for(unsigned int frame = 0; frame < frames; frame++)
+    {
+        float frameDt = dt;
+        if(!sInputLog.replaying)
+        {
+            headlessScript(frame, frames);
+        }
+        else if(!replayNextFrame(window, frameDt))
+        {
+            break;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        sceneUpdate(frameDt);
+        sceneDraw();
+        auto captureStart = std::chrono::steady_clock::now();
+        captureFrame(sScene.capture);
+        auto end = std::chrono::steady_clock::now();
+        cpuTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        captureTimes.push_back(std::chrono::duration<double, std::milli>(end - captureStart).count());
+
+        /* the query read back in frame 0 is the dummy of sceneInit */
+        sceneReadGpuTime();
+        gpuProfilerEndFrame(sScene.gpuProfiler);
+        if(frame > 0)
+        {
+            gpuTimes.push_back(sScene.query.elapsed / 1e6);
+        }
+        glfwSwapBuffers(window);
+    }
+
+    /* the last frame's query was swapped to the front */
+    if(frames > 0)
+    {
+        glGetQueryObjectui64v(sScene.query.values[sScene.query.frontBuffer], GL_QUERY_RESULT, &sScene.query.elapsed);
+        gpuTimes.push_back(sScene.query.elapsed / 1e6);
+    }
+
+    /* write the rest of the video, so its statistics are final */
+    captureRecordStop(sScene.capture);
+
+    headlessWriteJson(stdout, run, cpuTimes, gpuTimes, captureTimes);
+    fflush(stdout);
+    if(!run.jsonPath.empty())
+    {
+        FILE* file = fopen(run.jsonPath.c_str(), "w");
+        if(!file)
+        {
+            std::cerr << "Couldn't write " << run.jsonPath << std::endl;
+        }
+        else
+        {
+            headlessWriteJson(file, run, cpuTimes, gpuTimes, captureTimes);
+            fclose(file);
+        }
+    }
+
+    double captureP95 = frameTimeStats(captureTimes).p95;
+    if(run.captureBudget > 0.0 && captureP95 > run.captureBudget)
+    {
+        std::cerr << "Capture over budget: p95 " << captureP95 << " ms > " << run.captureBudget << " ms per frame" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/* whole number value of an option, prints an error and returns false if text isn't one of at least min */
+bool parseCount(const std::string& option, const char* text, unsigned long min, unsigned long& value)
+{
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtoul(text, &end, 10);
+    if(end == text || *end != '\0' || errno == ERANGE || text[0] == '-' || value < min)
+    {
+        std::cerr << "Invalid value " << text << " for " << option << ", expected a whole number >= " << min << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/* number value of an option, prints an error and returns false if text isn't a finite number above zero (or zero if
+ * allowed) */
+bool parsePositive(const std::string& option, const char* text, bool allowZero, double& value)
+{
+    char* end = nullptr;
+    value = std::strtod(text, &end);
+    if(end == text || *end != '\0' || !std::isfinite(value) || value < 0.0 || (value == 0.0 && !allowZero))
+    {
+        std::cerr << "Invalid value " << text << " for " << option << ", expected a number " << (allowZero ? ">= 0" : "> 0") << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    /*---------- parse arguments ------------*/
+    bool simThread = false;
+    size_t fleetSize = 0;
+    unsigned int jobThreads = 0;
+    bool indirect = true;
+    sScene.optimizeMeshes = true;
+    sScene.lodThreshold = 1.0f;
+    bool headless = false;
+    HeadlessRun run;
+    sScene.tracePath = "trace.json";
+    bool capture = false;
+    sScene.captureEvery = 1;
+    sScene.capturePattern = "capture/frame_%06u.png";
+    sScene.recordPath = "recording.y4m";
+    bool record = false;
+    sScene.ssrColorFormat = RT_RGB8;
+    sScene.ssrDepthFormat = RT_DEPTH24;
+    std::string inputRecordPath;
+    std::string replayPath;
+    std::string assetPackPath;
+    bool resolutionSet = false;
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if(arg == "--sim-thread")
+        {
+            simThread = true;
+        }
+        else if(arg == "--sim-rate" && i + 1 < argc)
+        {
+            double rate = 0.0;
+            if(!parsePositive(arg, argv[++i], false, rate))
+            {
+                return EXIT_FAILURE;
+            }
+            sScene.simulation.timestep = 1.0 / rate;
+        }
+        else if(arg == "--fleet" && i + 1 < argc)
+        {
+            unsigned long count = 0;
+            if(!parseCount(arg, argv[++i], 0, count))
+            {
+                return EXIT_FAILURE;
+            }
+            fleetSize = count;
+        }
+        else if(arg == "--jobs" && i + 1 < argc)
+        {
+            unsigned long threads = 0;
+            if(!parseCount(arg, argv[++i], 1, threads))
+            {
+                return EXIT_FAILURE;
+            }
+            jobThreads = threads;
+        }
+        else if(arg == "--asset-pack" && i + 1 < argc)
+        {
+            assetPackPath = argv[++i];
+        }
+        else if(arg == "--no-indirect")
+        {
+            indirect = false;
+        }
+        else if(arg == "--packed-vertices")
+        {
+            sScene.packedVertices = true;
+        }
+        else if(arg == "--no-mesh-optimize")
+        {
+            sScene.optimizeMeshes = false;
+        }
+        else if(arg == "--lod-threshold" && i + 1 < argc)
+        {
+            double threshold = 0.0;
+            if(!parsePositive(arg, argv[++i], true, threshold))
+            {
+                return EXIT_FAILURE;
+            }
+            sScene.lodThreshold = threshold;
+        }
+        else if(arg == "--water-resolution" && i + 1 < argc)
+        {
+            unsigned long resolution = 0;
+            if(!parseCount(arg, argv[++i], 2, resolution))
+            {
+                return EXIT_FAILURE;
+            }
+            if(resolution % 2 != 0)
+            {
+                std::cerr << "Invalid water resolution " << resolution << ", has to be even" << std::endl;
+                return EXIT_FAILURE;
+            }
+            sScene.waterGrid.resolution = resolution;
+        }
+        else if(arg == "--water-lod" && i + 1 < argc)
+        {
+            double distance = 0.0;
+            if(!parsePositive(arg, argv[++i], false, distance))
+            {
+                return EXIT_FAILURE;
+            }
+            sScene.waterGrid.lodDistance = distance;
+        }
+        else if(arg == "--profile" && i + 1 < argc)
+        {
+            sScene.tracePath = argv[++i];
+            profilerEnable(true);
+        }
+        else if(arg == "--headless")
+        {
+            headless = true;
+        }
+        else if(arg == "--frames" && i + 1 < argc)
+        {
+            unsigned long frames = 0;
+            if(!parseCount(arg, argv[++i], 1, frames))
+            {
+                return EXIT_FAILURE;
+            }
+            run.frames = frames;
+        }
+        else if(arg == "--resolution" && i + 1 < argc)
+        {
+            if(sscanf(argv[++i], "%dx%d", &run.width, &run.height) != 2 || run.width <= 0 || run.height <= 0)
+            {
+                std::cerr << "Invalid resolution " << argv[i] << ", expected WxH" << std::endl;
+                return EXIT_FAILURE;
+            }
+            resolutionSet = true;
+        }
+        else if(arg == "--scenario" && i + 1 < argc)
+        {
+            run.scenario = argv[++i];
+            if(!sceneScenarioKnown(run.scenario))
+            {
+                std::cerr << "Unknown scenario " << run.scenario << ", expected default, day, ssr_linear, color or fleet100" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(arg == "--json" && i + 1 < argc)
+        {
+            run.jsonPath = argv[++i];
+        }
+        else if(arg == "--capture-every" && i + 1 < argc)
+        {
+            unsigned long every = 0;
+            if(!parseCount(arg, argv[++i], 1, every))
+            {
+                return EXIT_FAILURE;
+            }
+            sScene.captureEvery = every;
+            capture = true;
+        }
+        else if(arg == "--capture-pattern" && i + 1 < argc)
+        {
+            sScene.capturePattern = argv[++i];
+            if(!capturePatternValid(sScene.capturePattern))
+            {
+                std::cerr << "Invalid capture pattern " << argv[i] << ", expected exactly one %u or %0Nu conversion"
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(arg == "--record" && i + 1 < argc)
+        {
+            sScene.recordPath = argv[++i];
+            record = true;
+        }
+        else if(arg == "--capture-budget" && i + 1 < argc)
+        {
+            if(!parsePositive(arg, argv[++i], true, run.captureBudget))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else if(arg == "--record-input" && i + 1 < argc)
+        {
+            inputRecordPath = argv[++i];
+        }
+        else if(arg == "--replay" && i + 1 < argc)
+        {
+            replayPath = argv[++i];
+        }
+        else if(arg == "--replay-fixed-dt" && i + 1 < argc)
+        {
+            double rate = 0.0;
+            if(!parsePositive(arg, argv[++i], false, rate))
+            {
+                return EXIT_FAILURE;
+            }
+            sInputLog.fixedDt = 1.0 / rate;
+        }
+        else if(arg == "--ssr-color-format" && i + 1 < argc)
+        {
+            sScene.ssrColorFormat = renderTargetFormat(argv[++i]);
+            if(sScene.ssrColorFormat == RT_NONE || sScene.ssrColorFormat >= RT_DEPTH24)
+            {
+                std::cerr << "Invalid color format " << argv[i] << ", expected rgb8, rgba8 or rgba16f" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(arg == "--ssr-depth-format" && i + 1 < argc)
+        {
+            sScene.ssrDepthFormat = renderTargetFormat(argv[++i]);
+            if(sScene.ssrDepthFormat < RT_DEPTH24)
+            {
+                std::cerr << "Invalid depth format " << argv[i] << ", expected depth24 or depth32f" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            std::cerr << "Unknown option " << arg << " or missing value" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* a replay runs as recorded: at its resolution unless given, with the simulation stepped by the replayed dts */
+    if(!replayPath.empty())
+    {
+        try
+        {
+            sInputLog.replay = inputReplayLoad(replayPath);
+        }
+        catch(const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        sInputLog.replaying = true;
+        run.frames = sInputLog.replay.frames;
+        if(!resolutionSet)
+        {
+            run.width = sInputLog.replay.width;
+            run.height = sInputLog.replay.height;
+        }
+        if(simThread)
+        {
+            printf("Replaying %s, the simulation runs on the main thread\n", replayPath.c_str());
+            simThread = false;
+        }
+    }
+
+    /* mapped before any thread is started, so a bad pack fails without anything to clean up */
+    if(!assetPackPath.empty())
+    {
+        try
+        {
+            sScene.assets = assetPackOpen(assetPackPath);
+        }
+        catch(const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        assetPackMount(&sScene.assets);
+        printf("Asset pack %s mapped (%zu entries, %.1f MB)\n", assetPackPath.c_str(), sScene.assets.entries.size(), sScene.assets.size / 1048576.0);
+    }
+
+    profilerSetThreadName("main");
+
+    /*---------- init window ------------*/
+    GLFWwindow* window = windowCreate("Project - Screen Space Reflection", run.width, run.height, headless);
     if(!window) { return EXIT_FAILURE; }
 
     /* set window callbacks */
@@ -540,30 +1721,121 @@ int main(int argc, char** argv)
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_BLEND);
 
-    /* setup scene */
-    sceneInit(width, height);
+    /* setup scene, the assets are decoded by the jobs while this thread uploads them */
+    jobSystemCreate(sScene.jobs, jobThreads);
+    auto loadStart = std::chrono::steady_clock::now();
+    ReadCounters loadReads = readCounters();
+    sceneInit(run.width, run.height);
+    JobStats loadJobs = jobSystemStats(sScene.jobs);
+    ReadCounters loadReadsEnd = readCounters();
+    printf("Scene loaded in %.1f ms on %u threads (%llu jobs, %llu stolen, %llu on the main queue), %llu read calls for %.1f MB\n",
+           1e3 * std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count(), jobSystemSize(&sScene.jobs),
+           loadJobs.executed, loadJobs.stolen, loadJobs.mainExecuted, loadReadsEnd.calls - loadReads.calls,
+           (loadReadsEnd.bytes - loadReads.bytes) / 1048576.0);
+    sceneApplyScenario(run.scenario, fleetSize);
+    sScene.useIndirect = indirect && drawIndirectSupported();
+    printf("Multi draw indirect %s\n", drawIndirectSupported() ? (sScene.useIndirect ? "enabled" : "disabled") : "not supported, using the draw loop");
+    if(fleetSize > 0)
+    {
+        sScene.simulation.fleet = boatWorldCreate(fleetSize, 4.0f * std::sqrt(float(fleetSize)) + 20.0f);
+        sScene.simulation.jobs = &sScene.jobs;
+    }
+    simulationStart(sScene.simulation, simThread);
+    captureCreate(sScene.capture);
+
+    /* from here on the job and simulation threads run, so a failure skips the main loop and goes through the cleanup */
+    bool success = true;
+    if(capture)
+    {
+        captureContinuous(sScene.capture, sScene.captureEvery, sScene.capturePattern);
+    }
+    if(success && record && !captureRecordStart(sScene.capture, sScene.recordPath, 60))
+    {
+        std::cerr << "Couldn't record " << sScene.recordPath << std::endl;
+        success = false;
+    }
+    if(success && !inputRecordPath.empty() && !inputRecorderCreate(sInputLog.recorder, inputRecordPath, run.width, run.height))
+    {
+        std::cerr << "Couldn't record input to " << inputRecordPath << std::endl;
+        success = false;
+    }
 
     /*-------------- main loop ----------------*/
     double timeStamp = glfwGetTime();
     double timeStampNew = 0.0;
-    while(!glfwWindowShouldClose(window))
+    if(success && headless)
+    {
+        success = headlessRun(window, run);
+    }
+    while(success && !headless && !glfwWindowShouldClose(window))
     {
         /* poll and process input and window events */
         glfwPollEvents();
 
         /* update scene */
         timeStampNew = glfwGetTime();
-        sceneUpdate(timeStampNew - timeStamp);
+        float dt = timeStampNew - timeStamp;
         timeStamp = timeStampNew;
+        if(sInputLog.replaying && !replayNextFrame(window, dt))
+        {
+            printf("Replay finished after %u frames\n", sInputLog.replay.frames);
+            break;
+        }
+        inputRecordFrame(sInputLog.recorder, dt);
+        sceneUpdate(dt);
 
         /* draw all objects in the scene */
         sceneDraw();
-        
+        captureFrame(sScene.capture);
+        sceneReadGpuTime();
+        gpuProfilerEndFrame(sScene.gpuProfiler);
+
         /* swap front and back buffer */
         glfwSwapBuffers(window);
     }
 
     /*-------- cleanup --------*/
+    if(sInputLog.recorder.file)
+    {
+        printf("Recorded input of %u frames (%u events) to %s\n", sInputLog.recorder.frames, sInputLog.recorder.events, inputRecordPath.c_str());
+        inputRecorderDelete(sInputLog.recorder);
+    }
+    simulationStop(sScene.simulation);
+    if(gProfiler.enabled)
+    {
+        if(profilerWriteChromeTrace(sScene.tracePath))
+        {
+            printf("Profiler trace written to %s\n", sScene.tracePath.c_str());
+        }
+        else
+        {
+            std::cerr << "Couldn't write profiler trace " << sScene.tracePath << std::endl;
+        }
+    }
+    gpuProfilerDelete(sScene.gpuProfiler);
+    bool recorded = sScene.capture.recording;
+    captureDelete(sScene.capture);
+    if(recorded)
+    {
+        printRecordStats();
+    }
+    CaptureStats captureStatsTotal = captureStats(sScene.capture);
+    if(captureStatsTotal.captured + captureStatsTotal.dropped > 0)
+    {
+        printf("Captured %u frames (%u written, %u failed), %u dropped, %.3f ms per frame on the render thread\n",
+               captureStatsTotal.captured, captureStatsTotal.encoded, captureStatsTotal.failed, captureStatsTotal.dropped,
+               1e3 * captureStatsTotal.captureTime / std::max(1u, sScene.capture.frame));
+    }
+    jobSystemDelete(sScene.jobs);
+    assetPackMount(nullptr);
+    assetPackClose(sScene.assets);
+    drawIndirectDelete(sScene.draws);
+    renderTargetPoolDelete(sScene.renderTargets);
+    boatDelete(sScene.boat);
+    meshDelete(sScene.waterMesh);
+    cubeMapDelete(sScene.skybox);
+    meshArenaDelete(sScene.meshArena);
+    meshArenaDelete(sScene.skyboxArena);
     shaderDelete(sScene.shaderWater);
     shaderDelete(sScene.shaderBlinnPhong);
     shaderDelete(sScene.shaderWaterColor);
@@ -571,5 +1843,5 @@ int main(int argc, char** argv)
     shaderDelete(sScene.shaderSkybox);
     windowDelete(window);
 
-    return EXIT_SUCCESS;
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
 }
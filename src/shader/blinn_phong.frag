@@ -31,11 +31,11 @@ struct Material
 in vec3 tNormal;
 in vec3 tFragPos;
 in vec2 tUV;
+flat in mat3 tNormalMatrix;
 
 out vec4 fragColor;
 
 uniform vec3 uViewPos;
-uniform mat4 uModel;
 uniform Light_Directional uLightSun;
 uniform Light_Spot uLightSpots[4];
 uniform Material uMaterial;
@@ -54,7 +54,7 @@ void main(void)
     vec3 viewDir = normalize(uViewPos - tFragPos);
 
     // Retrieve the normal from the normal map, transform it to [-1, 1] range and transform it into world space
-    vec3 normalMap = normalize(mat3(transpose(inverse(uModel))) * (texture(uMaterial.normal, tUV).rgb * 2.0 - 1.0));
+    vec3 normalMap = normalize(tNormalMatrix * (texture(uMaterial.normal, tUV).rgb * 2.0 - 1.0));
 
     // Use texture maps for material properties
     vec3 ambientColor = texture(uMaterial.ambient, tUV).rgb;
@@ -37,7 +37,6 @@ out vec4 FragColor;
 uniform mat4 uProj;
 uniform mat4 uView;
 uniform vec3 uViewPos;
-uniform mat4 uModel;
 uniform Light_Directional uLightSun;
 uniform Light_Spot uLightSpots[4];
 uniform Material uMaterial;
@@ -131,8 +130,9 @@ void main(void)
 {
     vec3 viewDir = normalize(uViewPos - tFragPos);
 
-    // Retrieve the normal from the normal map, transform it to [-1, 1] range and transform it into world space
-    vec3 normalMap = normalize(mat3(transpose(inverse(uModel))) * (texture(uMaterial.normal, tUV).rgb * 2.0 - 1.0));
+    // Retrieve the normal from the normal map and transform it to [-1, 1] range, water chunks are only translated so
+    // it is already in world space
+    vec3 normalMap = normalize(texture(uMaterial.normal, tUV).rgb * 2.0 - 1.0);
 
     // Compute the final normal for the water surface
     vec3 waterSurfaceNormal = normalize(0.25 * normalMap + tNormal);
@@ -3,20 +3,54 @@
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aUV;
+layout(location = 3) in uint aInstance;
 
-uniform mat4 uModel;
+/* model matrices, four texels (columns) per instance */
+uniform samplerBuffer uInstances;
 uniform mat4 uView;
 uniform mat4 uProj;
 
+/* grid of packed integer positions, identity for float vertices */
+uniform vec3 uPositionOffset;
+uniform vec3 uPositionScale;
+
 out vec3 tNormal;
 out vec3 tFragPos;
 out vec2 tUV;
+flat out mat3 tNormalMatrix;
+
+mat4 instanceModel(uint instance)
+{
+    int base = 4 * int(instance);
+    return mat4(texelFetch(uInstances, base), texelFetch(uInstances, base + 1), texelFetch(uInstances, base + 2), texelFetch(uInstances, base + 3));
+}
+
+#ifdef PACKED_VERTICES
+/* octahedral normal, see octDecode in vertex_pack.h */
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+#endif
 
 void main(void)
 {
-    gl_Position = uProj * uView * uModel * vec4(aPosition, 1.0);
-    tFragPos = vec3(uModel * vec4(aPosition, 1.0));
-    tNormal = mat3(transpose(inverse(uModel))) * aNormal;
+    mat4 model = instanceModel(aInstance);
+    vec3 position = uPositionOffset + uPositionScale * aPosition;
+#ifdef PACKED_VERTICES
+    vec3 normal = octDecode(aNormal.xy);
+#else
+    vec3 normal = aNormal;
+#endif
+
+    /* boats are rigid, so the rotation part is the normal matrix */
+    tNormalMatrix = mat3(model);
+
+    gl_Position = uProj * uView * model * vec4(position, 1.0);
+    tFragPos = vec3(model * vec4(position, 1.0));
+    tNormal = tNormalMatrix * normal;
     tUV = aUV;
 }
-
@@ -3,6 +3,7 @@
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aUV;
+layout(location = 3) in uint aInstance;
 
 struct wave_params
 {
@@ -12,10 +13,15 @@ struct wave_params
     vec2 direction;
 };
 
-uniform mat4 uModel;
+/* chunk model matrices, four texels (columns) per chunk */
+uniform samplerBuffer uInstances;
 uniform mat4 uView;
 uniform mat4 uProj;
 
+/* grid of packed integer positions, identity for float vertices */
+uniform vec3 uPositionOffset;
+uniform vec3 uPositionScale;
+
 uniform float time;
 uniform wave_params water_sim[3];
 
@@ -36,10 +42,16 @@ vec2 wave_delta(vec2 pos, float t, wave_params param)
     return vec2(dx, dy);
 }
 
+mat4 instanceModel(uint instance)
+{
+    int base = 4 * int(instance);
+    return mat4(texelFetch(uInstances, base), texelFetch(uInstances, base + 1), texelFetch(uInstances, base + 2), texelFetch(uInstances, base + 3));
+}
+
 void main(void)
 {
-    vec3 position = aPosition;
-    vec3 normal = aNormal;
+    /* the chunk model matrix places the unit grid, waves are evaluated in world space so neighbouring chunks match */
+    vec3 position = vec3(instanceModel(aInstance) * vec4(uPositionOffset + uPositionScale * aPosition, 1.0));
     vec2 delta = vec2(0, 0);
 
     for(int i = 0; i < 3; i++)
@@ -48,17 +60,18 @@ void main(void)
         delta += wave_delta(position.xz, time, water_sim[i]);
     }
 
-    normal = normalize(cross(vec3(0, delta.y, 1), vec3(1, delta.x, 0)));
+    vec3 normal = normalize(cross(vec3(0, delta.y, 1), vec3(1, delta.x, 0)));
 
-    gl_Position = uProj * uView * uModel * vec4(position, 1.0);
-    tFragPos = vec3(uModel * vec4(position, 1.0));
-    tNormal = mat3(transpose(inverse(uModel))) * normal;
+    gl_Position = uProj * uView * vec4(position, 1.0);
+    tFragPos = position;
+    tNormal = normal;
 
     // Adjust the texture coordinates based on time to animate the texture.
     // The direction of the movement is (-1, 0) which means the texture will move along the negative x-axis.
     // You can change the direction and speed as needed.
+    // The texture repeats every textureSize units in world space, like 4 repetitions over the former 40x40 water mesh.
     float textureMoveSpeed = 0.01; // Speed at which the texture moves.
+    float textureSize = 10.0; // World size of one texture repetition.
     vec2 textureDirection = vec2(-1, 0); // Direction of the texture movement.
-    tUV = 4 * aUV + textureDirection * time * textureMoveSpeed;
+    tUV = position.xz / textureSize + textureDirection * time * textureMoveSpeed;
 }
-
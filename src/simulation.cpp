@@ -0,0 +1,195 @@
+#include "simulation.h"
+#include "profiler.h"
+
+#include <algorithm>
+
+namespace detail
+{
+
+double seconds(Simulation::Clock::duration d)
+{
+    return std::chrono::duration<double>(d).count();
+}
+
+SimSnapshot simulationStep(Simulation& sim, const bool control[])
+{
+    sim.water.accumTime += sim.timestep;
+    boatMove(sim.boat, sim.water, control, sim.timestep);
+    if(sim.fleet.count > 0)
+    {
+        boatWorldUpdate(sim.fleet, sim.water, sim.timestep, sim.jobs);
+    }
+
+    return SimSnapshot{sim.boat, sim.water.accumTime};
+}
+
+/* caller holds sim.mutex; the fleet transformations of the step are swapped in, the fleet gets the buffer of the
+ * oldest snapshot back, which the next step overwrites completely */
+void simulationPublish(Simulation& sim, const SimSnapshot& snapshot, double busy)
+{
+    std::swap(sim.previous, sim.current);
+    sim.current.boat = snapshot.boat;
+    sim.current.waterTime = snapshot.waterTime;
+    sim.current.fleet.swap(sim.fleet.transformation);
+    sim.currentStamp = Simulation::Clock::now();
+    sim.stepsSinceSample++;
+    sim.busyTime += busy;
+}
+
+void simulationThread(Simulation* sim)
+{
+    profilerSetThreadName("simulation");
+
+    auto step = std::chrono::duration_cast<Simulation::Clock::duration>(std::chrono::duration<double>(sim->timestep));
+    auto next = Simulation::Clock::now();
+
+    while(sim->running)
+    {
+        bool control[Boat::eControl::CONTROL_COUNT];
+        {
+            std::lock_guard<std::mutex> lock(sim->mutex);
+            std::copy(sim->control, sim->control + Boat::eControl::CONTROL_COUNT, control);
+        }
+
+        auto start = Simulation::Clock::now();
+        SimSnapshot snapshot = simulationStep(*sim, control);
+        auto end = Simulation::Clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(sim->mutex);
+            simulationPublish(*sim, snapshot, seconds(end - start));
+        }
+
+        /* drop steps we can't catch up on instead of spiraling */
+        next += step;
+        if(end - next > step * sim->maxStepsPerUpdate)
+        {
+            next = end;
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+}
+
+void simulationStart(Simulation& sim, bool threaded)
+{
+    sim.current = SimSnapshot{sim.boat, sim.water.accumTime, sim.fleet.transformation};
+    sim.previous = sim.current;
+    sim.currentStamp = Simulation::Clock::now();
+    sim.reportStart = sim.currentStamp;
+    sim.accumulator = 0.0;
+    sim.threaded = threaded;
+
+    if(threaded)
+    {
+        sim.running = true;
+        sim.thread = std::thread(detail::simulationThread, &sim);
+    }
+}
+
+void simulationStop(Simulation& sim)
+{
+    sim.running = false;
+    if(sim.thread.joinable())
+    {
+        sim.thread.join();
+    }
+}
+
+void simulationSetControl(Simulation& sim, const bool control[])
+{
+    std::lock_guard<std::mutex> lock(sim.mutex);
+    std::copy(control, control + Boat::eControl::CONTROL_COUNT, sim.control);
+}
+
+void simulationAdvance(Simulation& sim, double dt)
+{
+    if(sim.threaded)
+    {
+        return;
+    }
+
+    /* clamp long frames (e.g. window drags) so we never run more than maxStepsPerUpdate steps */
+    sim.accumulator += std::min(dt, sim.timestep * sim.maxStepsPerUpdate);
+
+    while(sim.accumulator >= sim.timestep)
+    {
+        auto start = Simulation::Clock::now();
+        SimSnapshot snapshot = detail::simulationStep(sim, sim.control);
+        detail::simulationPublish(sim, snapshot, detail::seconds(Simulation::Clock::now() - start));
+
+        sim.accumulator -= sim.timestep;
+    }
+}
+
+void simulationSample(Simulation& sim, SimSnapshot& snapshot)
+{
+    auto now = Simulation::Clock::now();
+
+    BoatState previousBoat, currentBoat;
+    float previousTime = 0.0f, currentTime = 0.0f;
+    float alpha = 0.0f;
+    unsigned int steps = 0;
+    double busy = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(sim.mutex);
+        previousBoat = sim.previous.boat;
+        currentBoat = sim.current.boat;
+        previousTime = sim.previous.waterTime;
+        currentTime = sim.current.waterTime;
+
+        if(sim.threaded)
+        {
+            alpha = detail::seconds(now - sim.currentStamp) / sim.timestep;
+        }
+        else
+        {
+            alpha = sim.accumulator / sim.timestep;
+        }
+        alpha = std::clamp(alpha, 0.0f, 1.0f);
+
+        /* the fleet is blended in place instead of copied out; a step turns a boat by a fraction of a degree, so
+         * blending the rotation columns linearly stays as close to a rotation as slerp would */
+        const std::vector<Matrix4D>& previous = sim.previous.fleet;
+        const std::vector<Matrix4D>& current = sim.current.fleet;
+        snapshot.fleet.resize(current.size());
+        for(size_t i = 0; i < current.size(); i++)
+        {
+            for(int c = 0; c < 4; c++)
+            {
+                snapshot.fleet[i][c] = previous[i][c] + alpha * (current[i][c] - previous[i][c]);
+            }
+        }
+
+        steps = sim.stepsSinceSample;
+        busy = sim.busyTime;
+        sim.stepsSinceSample = 0;
+        sim.busyTime = 0.0;
+    }
+
+    /* statistics */
+    sim.stats.stepsLastFrame = steps;
+    sim.stats.totalSteps += steps;
+    sim.reportFrames++;
+    sim.reportSteps += steps;
+    sim.reportBusyTime += busy;
+
+    double elapsed = detail::seconds(now - sim.reportStart);
+    sim.stats.reportReady = elapsed >= sim.reportInterval;
+    if(sim.stats.reportReady)
+    {
+        sim.stats.stepsPerFrame = double(sim.reportSteps) / sim.reportFrames;
+        sim.stats.stepTime = sim.reportSteps ? sim.reportBusyTime / sim.reportSteps : 0.0;
+        sim.stats.utilization = sim.reportBusyTime / elapsed;
+
+        sim.reportStart = now;
+        sim.reportFrames = 0;
+        sim.reportSteps = 0;
+        sim.reportBusyTime = 0.0;
+    }
+
+    /* render one step behind the simulation, blending towards the newest state */
+    snapshot.boat = boatInterpolate(previousBoat, currentBoat, alpha);
+    snapshot.waterTime = previousTime + alpha * (currentTime - previousTime);
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "boat.h"
+#include "boat_world.h"
+#include "job_system.h"
+#include "water.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* everything the renderer needs from one simulation step */
+struct SimSnapshot
+{
+    BoatState boat;
+    float waterTime = 0.0f;
+
+    /* AI fleet transformations, empty without a fleet */
+    std::vector<Matrix4D> fleet;
+};
+
+struct SimStats
+{
+    unsigned int stepsLastFrame = 0;
+    unsigned long long totalSteps = 0;
+
+    /* averages over the last report interval */
+    double stepsPerFrame = 0.0;
+    double stepTime = 0.0;
+    double utilization = 0.0;
+
+    /* set by simulationSample once per report interval */
+    bool reportReady = false;
+};
+
+struct Simulation
+{
+    using Clock = std::chrono::steady_clock;
+
+    double timestep = 1.0 / 120.0;
+    unsigned int maxStepsPerUpdate = 8;
+    double reportInterval = 1.0;
+
+    /* simulation owned state, only touched by the thread that steps */
+    WaterSim water;
+    BoatState boat;
+
+    /* optional AI fleet, stepped after the boat and spread over jobs (nullptr steps it on the stepping thread) */
+    BoatWorld fleet;
+    JobSystem* jobs = nullptr;
+
+    /* shared between stepping and rendering, guarded by mutex */
+    bool control[Boat::eControl::CONTROL_COUNT] = {false, false, false, false};
+    SimSnapshot previous;
+    SimSnapshot current;
+    Clock::time_point currentStamp;
+    unsigned int stepsSinceSample = 0;
+    double busyTime = 0.0;
+    std::mutex mutex;
+
+    /* inline mode */
+    double accumulator = 0.0;
+
+    /* threaded mode */
+    bool threaded = false;
+    std::atomic<bool> running = false;
+    std::thread thread;
+
+    /* instrumentation */
+    SimStats stats;
+    Clock::time_point reportStart;
+    unsigned int reportFrames = 0;
+    unsigned int reportSteps = 0;
+    double reportBusyTime = 0.0;
+};
+
+/**
+ * @brief Initialize snapshots from the current simulation state and, if requested, start stepping on a dedicated thread.
+ *
+ * @param sim Simulation to start.
+ * @param threaded Step on an own thread at a fixed rate instead of inside simulationAdvance.
+ */
+void simulationStart(Simulation& sim, bool threaded);
+
+/**
+ * @brief Stop the simulation thread (if any). Has to be called before the simulation is destroyed.
+ *
+ * @param sim Simulation to stop.
+ */
+void simulationStop(Simulation& sim);
+
+/**
+ * @brief Hand the current boat controls to the simulation, they are used by all following steps.
+ *
+ * @param sim Simulation.
+ * @param control Pressed state for each Boat::eControl.
+ */
+void simulationSetControl(Simulation& sim, const bool control[]);
+
+/**
+ * @brief Feed frame time into the accumulator and run as many fixed steps as fit (at most maxStepsPerUpdate).
+ * Does nothing in threaded mode, where the simulation thread keeps its own clock.
+ *
+ * @param sim Simulation.
+ * @param dt Wall clock time since the last call in seconds.
+ */
+void simulationAdvance(Simulation& sim, double dt);
+
+/**
+ * @brief Interpolate between the two most recent steps for rendering. Also updates the statistics.
+ *
+ * @param sim Simulation.
+ * @param snapshot Receives the state blended by the time elapsed since the last step, its fleet vector is reused
+ * between frames.
+ */
+void simulationSample(Simulation& sim, SimSnapshot& snapshot);
@@ -0,0 +1,166 @@
+#include "spatial_hash.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace detail
+{
+
+uint32_t spatialHashPointBucket(const SpatialHash& hash, float x, float z)
+{
+    return spatialHashBucket(hash, spatialHashCell(x, hash.cellSize), spatialHashCell(z, hash.cellSize));
+}
+
+}
+
+void spatialHashBuild(SpatialHash& hash, const float* x, const float* z, size_t count, float cellSize)
+{
+    /* at least twice as many buckets as points keeps collisions rare */
+    uint32_t tableSize = 64;
+    while(tableSize < 2 * count)
+    {
+        tableSize *= 2;
+    }
+
+    hash.cellSize = cellSize;
+    hash.tableMask = tableSize - 1;
+    hash.bucketStart.assign(tableSize + 1, 0);
+    hash.entryIndex.resize(count);
+    hash.entryX.resize(count);
+    hash.entryZ.resize(count);
+    hash.pointBucket.resize(count);
+
+    /* counting sort by bucket */
+    for(size_t i = 0; i < count; i++)
+    {
+        uint32_t bucket = detail::spatialHashPointBucket(hash, x[i], z[i]);
+        hash.pointBucket[i] = bucket;
+        hash.bucketStart[bucket + 1]++;
+    }
+
+    for(uint32_t b = 0; b < tableSize; b++)
+    {
+        hash.bucketStart[b + 1] += hash.bucketStart[b];
+    }
+
+    /* scatter, using the next bucket's start as running insert position and shifting it back afterwards */
+    for(size_t i = 0; i < count; i++)
+    {
+        uint32_t e = hash.bucketStart[hash.pointBucket[i]]++;
+        hash.entryIndex[e] = (uint32_t) i;
+        hash.entryX[e] = x[i];
+        hash.entryZ[e] = z[i];
+    }
+
+    for(uint32_t b = tableSize; b > 0; b--)
+    {
+        hash.bucketStart[b] = hash.bucketStart[b - 1];
+    }
+    hash.bucketStart[0] = 0;
+}
+
+bool spatialHashUpdate(SpatialHash& hash, const float* x, const float* z, size_t count)
+{
+    bool rebuild = count != hash.pointBucket.size();
+    for(size_t i = 0; i < count && !rebuild; i++)
+    {
+        rebuild = detail::spatialHashPointBucket(hash, x[i], z[i]) != hash.pointBucket[i];
+    }
+
+    if(rebuild)
+    {
+        spatialHashBuild(hash, x, z, count, hash.cellSize);
+        return true;
+    }
+
+    for(size_t e = 0; e < count; e++)
+    {
+        hash.entryX[e] = x[hash.entryIndex[e]];
+        hash.entryZ[e] = z[hash.entryIndex[e]];
+    }
+    return false;
+}
+
+size_t spatialHashQueryRadius(const SpatialHash& hash, float px, float pz, float radius, std::vector<uint32_t>& out, uint32_t exclude)
+{
+    out.clear();
+    spatialHashForEach(hash, px, pz, radius, [&](uint32_t index, float, float, float)
+    {
+        if(index != exclude)
+        {
+            out.push_back(index);
+        }
+    });
+    return out.size();
+}
+
+size_t spatialHashQueryNearest(const SpatialHash& hash, float px, float pz, size_t k, float maxRadius, std::vector<uint32_t>& out, uint32_t exclude)
+{
+    out.clear();
+    if(k == 0 || hash.bucketStart.empty())
+    {
+        return 0;
+    }
+
+    /* max-heap of (distance², index), the root is the current k-th nearest */
+    std::vector<std::pair<float, uint32_t>> best;
+    best.reserve(k + 1);
+
+    int32_t cx = detail::spatialHashCell(px, hash.cellSize);
+    int32_t cz = detail::spatialHashCell(pz, hash.cellSize);
+    int32_t maxRing = (int32_t) std::ceil(maxRadius / hash.cellSize) + 1;
+    float maxRadius2 = maxRadius * maxRadius;
+
+    for(int32_t ring = 0; ring <= maxRing; ring++)
+    {
+        /* visit the cells with chebyshev distance ring to the query cell */
+        for(int32_t dz = -ring; dz <= ring; dz++)
+        {
+            int32_t step = (dz == -ring || dz == ring) ? 1 : 2 * ring;
+            for(int32_t dx = -ring; dx <= ring; dx += std::max(step, 1))
+            {
+                uint32_t bucket = detail::spatialHashBucket(hash, cx + dx, cz + dz);
+                for(uint32_t e = hash.bucketStart[bucket]; e < hash.bucketStart[bucket + 1]; e++)
+                {
+                    uint32_t index = hash.entryIndex[e];
+                    if(index == exclude
+                       || detail::spatialHashCell(hash.entryX[e], hash.cellSize) != cx + dx
+                       || detail::spatialHashCell(hash.entryZ[e], hash.cellSize) != cz + dz)
+                    {
+                        continue;
+                    }
+
+                    float ex = hash.entryX[e] - px;
+                    float ez = hash.entryZ[e] - pz;
+                    float d2 = ex * ex + ez * ez;
+                    if(d2 > maxRadius2 || (best.size() == k && d2 >= best.front().first))
+                    {
+                        continue;
+                    }
+
+                    best.emplace_back(d2, index);
+                    std::push_heap(best.begin(), best.end());
+                    if(best.size() > k)
+                    {
+                        std::pop_heap(best.begin(), best.end());
+                        best.pop_back();
+                    }
+                }
+            }
+        }
+
+        /* every point in the next ring is at least ring * cellSize away */
+        float bound = ring * hash.cellSize;
+        if(best.size() == k && best.front().first <= bound * bound)
+        {
+            break;
+        }
+    }
+
+    std::sort_heap(best.begin(), best.end());
+    for(const auto& entry : best)
+    {
+        out.push_back(entry.second);
+    }
+    return out.size();
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Uniform grid over the XZ plane. Grid cells are hashed into a power of two sized table and the points are counting
+ * sorted by bucket, so each bucket is a contiguous range of entries that also holds a copy of the positions. */
+struct SpatialHash
+{
+    float cellSize = 4.0f;
+    uint32_t tableMask = 0;
+
+    /* bucket b holds entries [bucketStart[b], bucketStart[b + 1]) */
+    std::vector<uint32_t> bucketStart;
+    std::vector<uint32_t> entryIndex;
+    std::vector<float> entryX;
+    std::vector<float> entryZ;
+
+    /* bucket of every point from the last build, used to detect when a rebuild can be skipped */
+    std::vector<uint32_t> pointBucket;
+};
+
+namespace detail
+{
+
+inline int32_t spatialHashCell(float v, float cellSize)
+{
+    return (int32_t) std::floor(v / cellSize);
+}
+
+inline uint32_t spatialHashBucket(const SpatialHash& hash, int32_t cx, int32_t cz)
+{
+    return ((uint32_t) cx * 73856093u ^ (uint32_t) cz * 19349663u) & hash.tableMask;
+}
+
+}
+
+/**
+ * @brief Sort all points into the grid. Allocations are kept between builds.
+ *
+ * @param hash Grid to (re)build.
+ * @param x X coordinates of the points.
+ * @param z Z coordinates of the points.
+ * @param count Number of points.
+ * @param cellSize Edge length of a grid cell, ideally about the typical query radius.
+ */
+void spatialHashBuild(SpatialHash& hash, const float* x, const float* z, size_t count, float cellSize);
+
+/**
+ * @brief Incremental variant of spatialHashBuild for points that moved since the last build. Only the position copies
+ * are refreshed when no point changed its bucket, otherwise the grid is rebuilt.
+ *
+ * @return Whether a full rebuild was necessary.
+ */
+bool spatialHashUpdate(SpatialHash& hash, const float* x, const float* z, size_t count);
+
+/**
+ * @brief Call fn(index, x, z, distanceSquared) for every point within radius of (px, pz). The position is the copy taken
+ * at build time, so the callback may run while the source arrays are being modified.
+ */
+template<typename F>
+void spatialHashForEach(const SpatialHash& hash, float px, float pz, float radius, F&& fn)
+{
+    if(hash.bucketStart.empty())
+    {
+        return;
+    }
+
+    int32_t x0 = detail::spatialHashCell(px - radius, hash.cellSize);
+    int32_t x1 = detail::spatialHashCell(px + radius, hash.cellSize);
+    int32_t z0 = detail::spatialHashCell(pz - radius, hash.cellSize);
+    int32_t z1 = detail::spatialHashCell(pz + radius, hash.cellSize);
+    float radius2 = radius * radius;
+
+    for(int32_t cz = z0; cz <= z1; cz++)
+    {
+        for(int32_t cx = x0; cx <= x1; cx++)
+        {
+            uint32_t bucket = detail::spatialHashBucket(hash, cx, cz);
+            for(uint32_t e = hash.bucketStart[bucket]; e < hash.bucketStart[bucket + 1]; e++)
+            {
+                float dx = hash.entryX[e] - px;
+                float dz = hash.entryZ[e] - pz;
+                float d2 = dx * dx + dz * dz;
+                if(d2 > radius2)
+                {
+                    continue;
+                }
+
+                /* another cell of the query range can share the bucket, only report the entry from its own cell */
+                if(detail::spatialHashCell(hash.entryX[e], hash.cellSize) != cx || detail::spatialHashCell(hash.entryZ[e], hash.cellSize) != cz)
+                {
+                    continue;
+                }
+
+                fn(hash.entryIndex[e], hash.entryX[e], hash.entryZ[e], d2);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Collect all points within radius of (px, pz).
+ *
+ * @param out Receives the point indices (cleared first).
+ * @param exclude Index that is skipped, e.g. the querying boat itself.
+ *
+ * @return Number of points found.
+ */
+size_t spatialHashQueryRadius(const SpatialHash& hash, float px, float pz, float radius, std::vector<uint32_t>& out, uint32_t exclude = UINT32_MAX);
+
+/**
+ * @brief Collect the k nearest points to (px, pz), searching rings of cells outwards up to maxRadius.
+ *
+ * @param out Receives the point indices sorted by distance (cleared first).
+ * @param exclude Index that is skipped, e.g. the querying boat itself.
+ *
+ * @return Number of points found (less than k if there are not enough points within maxRadius).
+ */
+size_t spatialHashQueryNearest(const SpatialHash& hash, float px, float pz, size_t k, float maxRadius, std::vector<uint32_t>& out, uint32_t exclude = UINT32_MAX);
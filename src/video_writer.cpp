@@ -0,0 +1,169 @@
+#include "video_writer.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace detail
+{
+
+void videoWriterRun(VideoWriter* writer)
+{
+    profilerSetThreadName("video writer");
+
+    using Clock = std::chrono::steady_clock;
+    std::vector<uint8_t> yuv(videoYuv420Size(writer->width, writer->height));
+
+    std::unique_lock<std::mutex> lock(writer->mutex);
+    while(true)
+    {
+        writer->wake.wait(lock, [&] { return writer->stop || !writer->queue.empty(); });
+        if(writer->queue.empty())
+        {
+            return;
+        }
+        std::vector<uint8_t> frame = std::move(writer->queue.front());
+        writer->queue.pop_front();
+        lock.unlock();
+
+        auto start = Clock::now();
+        {
+            PROFILE_ZONE("videoConvert");
+            videoConvertYuv420(frame.data(), writer->width, writer->height, yuv.data());
+        }
+        auto converted = Clock::now();
+        {
+            PROFILE_ZONE("videoWrite");
+            fputs("FRAME\n", writer->file);
+            fwrite(yuv.data(), 1, yuv.size(), writer->file);
+        }
+        auto written = Clock::now();
+
+        lock.lock();
+        writer->stats.frames++;
+        writer->stats.bytes += yuv.size() + 6;
+        writer->stats.convertTime += std::chrono::duration<double>(converted - start).count();
+        writer->stats.writeTime += std::chrono::duration<double>(written - converted).count();
+        writer->freeFrames.push_back(std::move(frame));
+    }
+}
+
+inline uint8_t videoLuma(int r, int g, int b)
+{
+    return uint8_t((19595 * r + 38470 * g + 7471 * b + 32768) >> 16);
+}
+
+/* r, g, b are sums over 4 pixels, so the shift is two bits longer; 128.5 * 2^18 adds the offset and rounds */
+inline uint8_t videoChroma(int r, int g, int b, int cr, int cg, int cb)
+{
+    return uint8_t(std::min(255, (cr * r + cg * g + cb * b + 33685504) >> 18));
+}
+
+}
+
+bool videoWriterCreate(VideoWriter& writer, const std::string& filepath, int width, int height, unsigned int fps, size_t capacity)
+{
+    writer.file = fopen(filepath.c_str(), "wb");
+    if(!writer.file)
+    {
+        return false;
+    }
+
+    /* large stdio buffer, every frame is written with two calls */
+    setvbuf(writer.file, nullptr, _IOFBF, 1 << 20);
+    fprintf(writer.file, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C420jpeg XYSCSS=420JPEG\n", width, height, fps);
+
+    writer.width = width;
+    writer.height = height;
+    writer.capacity = std::max<size_t>(1, capacity);
+    writer.stop = false;
+    writer.stats = {};
+    writer.thread = std::thread(detail::videoWriterRun, &writer);
+    return true;
+}
+
+void videoWriterDelete(VideoWriter& writer)
+{
+    {
+        std::lock_guard<std::mutex> lock(writer.mutex);
+        writer.stop = true;
+    }
+    writer.wake.notify_all();
+    writer.thread.join();
+
+    fclose(writer.file);
+    writer.file = nullptr;
+    writer.freeFrames.clear();
+}
+
+bool videoWriterAcquire(VideoWriter& writer, std::vector<uint8_t>& frame, bool force)
+{
+    std::lock_guard<std::mutex> lock(writer.mutex);
+    if(!force && writer.queue.size() >= writer.capacity)
+    {
+        writer.stats.dropped++;
+        return false;
+    }
+
+    if(!writer.freeFrames.empty())
+    {
+        frame = std::move(writer.freeFrames.back());
+        writer.freeFrames.pop_back();
+    }
+    frame.resize(size_t(writer.width) * writer.height * 4);
+    return true;
+}
+
+void videoWriterPush(VideoWriter& writer, std::vector<uint8_t>&& frame)
+{
+    std::lock_guard<std::mutex> lock(writer.mutex);
+    writer.stats.queueDepthSum += writer.queue.size();
+    writer.stats.queueDepthMax = std::max(writer.stats.queueDepthMax, writer.queue.size());
+    writer.queue.push_back(std::move(frame));
+    writer.wake.notify_one();
+}
+
+VideoWriterStats videoWriterStats(VideoWriter& writer)
+{
+    std::lock_guard<std::mutex> lock(writer.mutex);
+    return writer.stats;
+}
+
+size_t videoYuv420Size(int width, int height)
+{
+    size_t chroma = size_t((width + 1) / 2) * ((height + 1) / 2);
+    return size_t(width) * height + 2 * chroma;
+}
+
+void videoConvertYuv420(const uint8_t* rgba, int width, int height, uint8_t* yuv)
+{
+    int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+    uint8_t* u = yuv + size_t(width) * height;
+    uint8_t* v = u + size_t(chromaWidth) * chromaHeight;
+
+    for(int y = 0; y < height; y++)
+    {
+        const uint8_t* row = rgba + size_t(height - 1 - y) * width * 4;
+        uint8_t* luma = yuv + size_t(y) * width;
+        for(int x = 0; x < width; x++)
+        {
+            luma[x] = detail::videoLuma(row[4 * x], row[4 * x + 1], row[4 * x + 2]);
+        }
+    }
+
+    /* odd sizes repeat the last row or column */
+    for(int y = 0; y < chromaHeight; y++)
+    {
+        const uint8_t* row0 = rgba + size_t(height - 1 - 2 * y) * width * 4;
+        const uint8_t* row1 = rgba + size_t(std::max(0, height - 2 - 2 * y)) * width * 4;
+        for(int x = 0; x < chromaWidth; x++)
+        {
+            int x0 = 4 * (2 * x), x1 = 4 * std::min(2 * x + 1, width - 1);
+            int r = row0[x0] + row0[x1] + row1[x0] + row1[x1];
+            int g = row0[x0 + 1] + row0[x1 + 1] + row1[x0 + 1] + row1[x1 + 1];
+            int b = row0[x0 + 2] + row0[x1 + 2] + row1[x0 + 2] + row1[x1 + 2];
+            u[size_t(y) * chromaWidth + x] = detail::videoChroma(r, g, b, -11059, -21709, 32768);
+            v[size_t(y) * chromaWidth + x] = detail::videoChroma(r, g, b, 32768, -27439, -5329);
+        }
+    }
+}
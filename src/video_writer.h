@@ -0,0 +1,110 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct VideoWriterStats
+{
+    /* frames written to the file and frames rejected because the queue was full */
+    unsigned int frames = 0;
+    unsigned int dropped = 0;
+
+    /* queue length seen by every accepted frame, summed up, and the largest one */
+    unsigned long long queueDepthSum = 0;
+    size_t queueDepthMax = 0;
+
+    /* writer thread time spent converting and writing, summed up */
+    double convertTime = 0.0;
+    double writeTime = 0.0;
+    unsigned long long bytes = 0;
+};
+
+/**
+ * Streams RGBA frames into a YUV4MPEG2 (.y4m) file: 8 bit 4:2:0 with full range BT.601 colors (C420jpeg), which
+ * ffmpeg and most players read directly. Frames go through a bounded queue to a writer thread that converts and
+ * writes them; a producer that outruns the disk gets its frames rejected instead of being blocked.
+ */
+struct VideoWriter
+{
+    FILE* file = nullptr;
+    int width = 0;
+    int height = 0;
+
+    /* writer thread; queue, stats and the recycled frame buffers are guarded by mutex */
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stop = false;
+    std::deque<std::vector<uint8_t>> queue;
+    size_t capacity = 0;
+    std::vector<std::vector<uint8_t>> freeFrames;
+    VideoWriterStats stats;
+};
+
+/**
+ * @brief Open the file, write the stream header and start the writer thread.
+ *
+ * @param writer Writer to initialize.
+ * @param filepath Output file, usually *.y4m.
+ * @param width Frame width.
+ * @param height Frame height.
+ * @param fps Playback frame rate stored in the header.
+ * @param capacity Frames the queue holds before frames are rejected.
+ *
+ * @return False if the file couldn't be opened.
+ */
+bool videoWriterCreate(VideoWriter& writer, const std::string& filepath, int width, int height, unsigned int fps, size_t capacity = 8);
+
+/**
+ * @brief Write all queued frames, join the writer thread and close the file. Has to be called for each writer that
+ * was created successfully.
+ *
+ * @param writer Writer to delete.
+ */
+void videoWriterDelete(VideoWriter& writer);
+
+/**
+ * @brief Reserve a place in the queue and get a recycled buffer of width * height * 4 bytes for the next frame. Only
+ * one thread may produce frames.
+ *
+ * @param writer Writer.
+ * @param frame Receives the buffer.
+ * @param force Accept the frame even if the queue is full.
+ *
+ * @return False if the queue is full, the frame counts as dropped.
+ */
+bool videoWriterAcquire(VideoWriter& writer, std::vector<uint8_t>& frame, bool force = false);
+
+/**
+ * @brief Queue a frame from videoWriterAcquire.
+ *
+ * @param writer Writer.
+ * @param frame RGBA pixels, rows bottom up like glReadPixels returns them.
+ */
+void videoWriterPush(VideoWriter& writer, std::vector<uint8_t>&& frame);
+
+/**
+ * @brief Copy of the statistics, can be called while the writer runs.
+ */
+VideoWriterStats videoWriterStats(VideoWriter& writer);
+
+/**
+ * @brief Convert bottom up RGBA to top down planar YUV 4:2:0, full range BT.601, chroma averaged over 2x2 pixels.
+ *
+ * @param rgba Pixels, width * height * 4 bytes.
+ * @param width Frame width.
+ * @param height Frame height.
+ * @param yuv Output, width * height luma bytes followed by both chroma planes of ceil(width / 2) * ceil(height / 2).
+ */
+void videoConvertYuv420(const uint8_t* rgba, int width, int height, uint8_t* yuv);
+
+/**
+ * @brief Size of a frame converted with videoConvertYuv420.
+ */
+size_t videoYuv420Size(int width, int height);
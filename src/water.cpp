@@ -1,5 +1,7 @@
 #include "water.h"
 
+#include "math/simd.h"
+
 float waveHeight(Vector2D pos, float t, const WaveParams& params)
 {
     return params.amplitude * sin(dot(normalize(params.direction), pos) * params.omega + t * params.phi);
@@ -10,12 +12,55 @@ float waterHeight(const WaterSim &sim, Vector2D position)
     return waveHeight(position, sim.accumTime, sim.parameter[0]) + waveHeight(position, sim.accumTime, sim.parameter[1]) + waveHeight(position, sim.accumTime, sim.parameter[2]);
 }
 
+void waterHeights(const WaterSim &sim, const float *x, const float *z, float *height, size_t count)
+{
+    size_t i = 0;
+
+#ifdef MATH_SIMD_SSE
+    __m128 dirX[3], dirZ[3], offset[3], amplitude[3];
+    for(int w = 0; w < 3; w++)
+    {
+        auto& params = sim.parameter[w];
+        Vector2D dir = normalize(params.direction);
+        dirX[w] = _mm_set1_ps(dir.x * params.omega);
+        dirZ[w] = _mm_set1_ps(dir.y * params.omega);
+        offset[w] = _mm_set1_ps(sim.accumTime * params.phi);
+        amplitude[w] = _mm_set1_ps(params.amplitude);
+    }
+
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 pz = _mm_loadu_ps(z + i);
+        __m128 h = _mm_setzero_ps();
+
+        for(int w = 0; w < 3; w++)
+        {
+            __m128 phase = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, dirX[w]), _mm_mul_ps(pz, dirZ[w])), offset[w]);
+            h = _mm_add_ps(h, _mm_mul_ps(amplitude[w], simdSin(phase)));
+        }
+
+        _mm_storeu_ps(height + i, h);
+    }
+#endif
+
+    for(; i < count; i++)
+    {
+        height[i] = waterHeight(sim, Vector2D(x[i], z[i]));
+    }
+}
+
 Matrix4D waterBuoyancyRotation(const WaterSim &sim, const Vector2D &v0, const Vector2D &v1, const Vector2D &v2)
 {
     Vector3D d0 = { v0.x, waterHeight(sim, v0), v0.y };
     Vector3D d1 = { v1.x, waterHeight(sim, v1), v1.y };
     Vector3D d2 = { v2.x, waterHeight(sim, v2), v2.y };
 
+    return waterBuoyancyRotation(d0, d1, d2);
+}
+
+Matrix4D waterBuoyancyRotation(const Vector3D &d0, const Vector3D &d1, const Vector3D &d2)
+{
     auto n0 = normalize(d1 - d0);
     auto n1 = normalize(d2 - d0);
     auto n2 = normalize(d1 - d2);
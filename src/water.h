@@ -23,4 +23,6 @@ struct WaterSim
 };
 
 float waterHeight(const WaterSim& sim, Vector2D position);
+void waterHeights(const WaterSim& sim, const float* x, const float* z, float* height, size_t count);
 Matrix4D waterBuoyancyRotation(const WaterSim& sim, const Vector2D& v0, const Vector2D& v1, const Vector2D& v2);
+Matrix4D waterBuoyancyRotation(const Vector3D& d0, const Vector3D& d1, const Vector3D& d2);
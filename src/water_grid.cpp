@@ -0,0 +1,162 @@
+#include "water_grid.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace detail
+{
+
+/* vertex of the shared chunk grid after collapsing the odd vertices of the stitched edges */
+unsigned int waterGridVertex(unsigned int i, unsigned int j, unsigned int resolution, unsigned int stitch)
+{
+    if(((stitch & WaterGrid::EDGE_NEG_X) && i == 0) || ((stitch & WaterGrid::EDGE_POS_X) && i == resolution))
+    {
+        j &= ~1u;
+    }
+    if(((stitch & WaterGrid::EDGE_NEG_Z) && j == 0) || ((stitch & WaterGrid::EDGE_POS_Z) && j == resolution))
+    {
+        i &= ~1u;
+    }
+    return j * (resolution + 1) + i;
+}
+
+bool waterGridSplit(const WaterGrid& grid, const Vector3D& camera, float x, float z, float size)
+{
+    /* distance from the camera to the node square on the water plane */
+    float dx = std::max({x - camera.x, 0.0f, camera.x - (x + size)});
+    float dz = std::max({z - camera.z, 0.0f, camera.z - (z + size)});
+    return dx * dx + camera.y * camera.y + dz * dz < grid.lodDistance * grid.lodDistance * size * size;
+}
+
+float waterGridRootSize(const WaterGrid& grid)
+{
+    return grid.chunkSize * float(1u << (grid.levels - 1));
+}
+
+void waterGridCollect(WaterGrid& grid, const Vector3D& camera, float x, float z, float size, unsigned int level, float waveHeight)
+{
+    if(level > 0 && waterGridSplit(grid, camera, x, z, size))
+    {
+        float half = 0.5f * size;
+        waterGridCollect(grid, camera, x,        z,        half, level - 1, waveHeight);
+        waterGridCollect(grid, camera, x + half, z,        half, level - 1, waveHeight);
+        waterGridCollect(grid, camera, x,        z + half, half, level - 1, waveHeight);
+        waterGridCollect(grid, camera, x + half, z + half, half, level - 1, waveHeight);
+        return;
+    }
+
+    WaterChunk& chunk = grid.chunks.emplace_back();
+    chunk.origin = Vector2D(x, z);
+    chunk.size = size;
+    chunk.level = level;
+    chunk.stitch = 0;
+    chunk.bounds.center = Vector3D(x + 0.5f * size, 0.0f, z + 0.5f * size);
+    chunk.bounds.extent = Vector3D(0.5f * size, waveHeight, 0.5f * size);
+    chunk.bounds.radius = length(chunk.bounds.extent);
+}
+
+/* size of the chunk containing (x, z), 0 outside of the grid */
+float waterGridSizeAt(const WaterGrid& grid, const Vector3D& camera, float x, float z)
+{
+    float size = waterGridRootSize(grid);
+    float rx = std::floor(x / size) * size;
+    float rz = std::floor(z / size) * size;
+    if(std::abs(rx - std::floor(camera.x / size) * size) > 1.5f * size || std::abs(rz - std::floor(camera.z / size) * size) > 1.5f * size)
+    {
+        return 0.0f;
+    }
+
+    for(unsigned int level = grid.levels - 1; level > 0 && waterGridSplit(grid, camera, rx, rz, size); level--)
+    {
+        size *= 0.5f;
+        rx += (x >= rx + size) ? size : 0.0f;
+        rz += (z >= rz + size) ? size : 0.0f;
+    }
+
+    return size;
+}
+
+}
+
+WaterGrid waterGridCreate(unsigned int resolution, float chunkSize, unsigned int levels, float lodDistance)
+{
+    WaterGrid grid;
+    grid.resolution = resolution & ~1u;
+    grid.chunkSize = chunkSize;
+    grid.levels = std::max(levels, 1u);
+    grid.lodDistance = lodDistance;
+
+    unsigned int n = grid.resolution;
+    grid.vertices.reserve((n + 1) * (n + 1));
+    for(unsigned int j = 0; j <= n; j++)
+    {
+        for(unsigned int i = 0; i <= n; i++)
+        {
+            Vertex& vertex = grid.vertices.emplace_back();
+            vertex.pos = Vector3D(float(i) / n, 0.0f, float(j) / n);
+            vertex.normal = Vector3D(0.0f, 1.0f, 0.0f);
+            vertex.uv = Vector2D(float(i) / n, float(j) / n);
+        }
+    }
+
+    for(unsigned int stitch = 0; stitch < WaterGrid::EDGE_VARIANTS; stitch++)
+    {
+        grid.variantOffset[stitch] = grid.indices.size();
+        for(unsigned int j = 0; j < n; j++)
+        {
+            for(unsigned int i = 0; i < n; i++)
+            {
+                unsigned int v00 = detail::waterGridVertex(i,     j,     n, stitch);
+                unsigned int v10 = detail::waterGridVertex(i + 1, j,     n, stitch);
+                unsigned int v01 = detail::waterGridVertex(i,     j + 1, n, stitch);
+                unsigned int v11 = detail::waterGridVertex(i + 1, j + 1, n, stitch);
+
+                /* collapsed triangles degenerate to lines and are dropped */
+                for(auto [a, b, c] : {std::array{v00, v01, v11}, std::array{v00, v11, v10}})
+                {
+                    if(a != b && b != c && a != c)
+                    {
+                        grid.indices.insert(grid.indices.end(), {a, b, c});
+                    }
+                }
+            }
+        }
+        grid.variantCount[stitch] = grid.indices.size() - grid.variantOffset[stitch];
+    }
+
+    return grid;
+}
+
+void waterGridSelect(WaterGrid& grid, const Vector3D& camera, float waveHeight)
+{
+    grid.chunks.clear();
+
+    /* 3x3 roots around the root cell of the camera, aligned to the root size so chunks never move in world space */
+    float rootSize = detail::waterGridRootSize(grid);
+    float cx = std::floor(camera.x / rootSize) * rootSize;
+    float cz = std::floor(camera.z / rootSize) * rootSize;
+    for(int j = -1; j <= 1; j++)
+    {
+        for(int i = -1; i <= 1; i++)
+        {
+            detail::waterGridCollect(grid, camera, cx + i * rootSize, cz + j * rootSize, rootSize, grid.levels - 1, waveHeight);
+        }
+    }
+
+    /* stitch every edge that borders a coarser chunk, the neighbour is looked up just outside the edge midpoint */
+    float offset = 0.25f * grid.chunkSize;
+    for(auto& chunk : grid.chunks)
+    {
+        float x = chunk.origin.x, z = chunk.origin.y, size = chunk.size;
+        chunk.stitch |= detail::waterGridSizeAt(grid, camera, x - offset,        z + 0.5f * size) > size ? WaterGrid::EDGE_NEG_X : 0;
+        chunk.stitch |= detail::waterGridSizeAt(grid, camera, x + size + offset, z + 0.5f * size) > size ? WaterGrid::EDGE_POS_X : 0;
+        chunk.stitch |= detail::waterGridSizeAt(grid, camera, x + 0.5f * size, z - offset)        > size ? WaterGrid::EDGE_NEG_Z : 0;
+        chunk.stitch |= detail::waterGridSizeAt(grid, camera, x + 0.5f * size, z + size + offset) > size ? WaterGrid::EDGE_POS_Z : 0;
+    }
+}
+
+Matrix4D waterChunkTransformation(const WaterChunk& chunk)
+{
+    return Matrix4D::translation({chunk.origin.x, 0.0f, chunk.origin.y}) * Matrix4D::scale(chunk.size, 1.0f, chunk.size);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "mygl/mesh.h"
+#include "math/bounds.h"
+
+#include <vector>
+
+/* one selected water chunk, a square in the XZ plane drawn with the shared chunk mesh */
+struct WaterChunk
+{
+    Vector2D origin;
+    float size;
+    unsigned int level;
+
+    /* edges bordering a coarser chunk, see WaterGrid::eEdge */
+    unsigned int stitch;
+
+    /* world space bounds including the wave height */
+    Bounds bounds;
+};
+
+/* Procedural ocean made of a quadtree of chunks around the camera. All chunks share one (resolution + 1)^2 vertex grid
+ * over the unit square that is placed by the model matrix, so a chunk of level l has 2^l times the vertex spacing of the
+ * finest chunks. The grid roots are aligned to their size and cover the 3x3 root cells around the camera, the quadtree
+ * is refined towards the camera, which keeps the vertex count bounded for any camera position. */
+struct WaterGrid
+{
+    enum eEdge
+    {
+        EDGE_NEG_X = 1,
+        EDGE_POS_X = 2,
+        EDGE_NEG_Z = 4,
+        EDGE_POS_Z = 8,
+        EDGE_VARIANTS = 16
+    };
+
+    unsigned int resolution = 32;
+    float chunkSize = 16.0f;
+    unsigned int levels = 7;
+
+    /* nodes closer to the camera than lodDistance times their size are split */
+    float lodDistance = 2.0f;
+
+    /* shared chunk mesh; every stitch mask has its own index range in which the odd vertices of the marked edges are
+     * collapsed onto their even neighbour, so the edge matches the coarser chunk next to it */
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    unsigned int variantOffset[EDGE_VARIANTS] = {};
+    unsigned int variantCount[EDGE_VARIANTS] = {};
+
+    /* chunks selected by the last waterGridSelect */
+    std::vector<WaterChunk> chunks;
+};
+
+/**
+ * @brief Create a water grid and build the shared chunk mesh with all stitch variants.
+ *
+ * @param resolution Quads per chunk side, has to be even.
+ * @param chunkSize World size of the finest chunks.
+ * @param levels Number of LOD levels, the roots are chunkSize * 2^(levels - 1) wide.
+ * @param lodDistance Split distance in multiples of the node size, >= 1 keeps neighbouring chunks at most one level apart.
+ *
+ * @return Water grid without selected chunks.
+ */
+WaterGrid waterGridCreate(unsigned int resolution = 32, float chunkSize = 16.0f, unsigned int levels = 7, float lodDistance = 2.0f);
+
+/**
+ * @brief Select the chunks around the camera and their stitch masks.
+ *
+ * @param grid Water grid, the result is stored in grid.chunks.
+ * @param camera Camera position in world space.
+ * @param waveHeight Maximal height the vertex shader adds, grows the chunk bounds.
+ */
+void waterGridSelect(WaterGrid& grid, const Vector3D& camera, float waveHeight);
+
+/**
+ * @brief Model matrix of a chunk, maps the unit grid onto the chunk square.
+ */
+Matrix4D waterChunkTransformation(const WaterChunk& chunk);
@@ -0,0 +1,212 @@
+#include "asset_pack.h"
+#include "mygl/model_geometry.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#include <stb_image/stb_image.h>
+
+namespace
+{
+
+struct Packer
+{
+    AssetPackWriter writer;
+    std::set<std::pair<std::string, AssetType>> packed;
+    size_t bytes[ASSET_IMAGE + 1] = {};
+    unsigned int count[ASSET_IMAGE + 1] = {};
+};
+
+std::string directoryOf(const std::string& path)
+{
+    return path.substr(0, path.find_last_of("\\/")) + "/";
+}
+
+/* false if the entry is already in the pack, e.g. a texture shared by two materials */
+bool packerAdd(Packer& packer, AssetEntry entry, const void* data, size_t size)
+{
+    if(!packer.packed.insert({entry.path, entry.type}).second)
+    {
+        return false;
+    }
+    packer.bytes[entry.type] += size;
+    packer.count[entry.type]++;
+    assetPackWrite(packer.writer, std::move(entry), data, size);
+    return true;
+}
+
+void packFile(Packer& packer, const std::string& path)
+{
+    AssetData data;
+    if(!assetRead(path, data))
+    {
+        throw std::runtime_error("couldn't read " + path);
+    }
+    packerAdd(packer, {.path = path, .type = ASSET_FILE}, data.data, data.size);
+}
+
+/* decoded the way textureImageLoad decodes it, so the loader can hand out the pixels as they are */
+void packImage(Packer& packer, const std::string& path, bool flipped, bool encoded)
+{
+    if(encoded)
+    {
+        packFile(packer, path);
+        return;
+    }
+
+    int width = 0, height = 0, components = 0;
+    stbi_set_flip_vertically_on_load(flipped);
+    unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &components, 4);
+    if(!pixels)
+    {
+        throw std::runtime_error("couldn't load image " + path);
+    }
+
+    AssetEntry entry = {.path = path, .type = ASSET_IMAGE, .flipped = flipped, .width = uint32_t(width), .height = uint32_t(height)};
+    packerAdd(packer, entry, pixels, size_t(width) * height * 4);
+    stbi_image_free(pixels);
+}
+
+/* the library and the maps materialLoad loads from it */
+void packMaterial(Packer& packer, const std::string& path, bool encoded)
+{
+    packFile(packer, path);
+
+    std::ifstream file(path);
+    std::string line;
+    while(std::getline(file, line))
+    {
+        std::stringstream ss(line);
+        std::string code, texture;
+        ss >> code >> texture;
+        if(code == "map_Kd" || code == "map_Ks" || code == "map_bump" || code == "map_Ka")
+        {
+            packImage(packer, directoryOf(path) + texture, true, encoded);
+        }
+    }
+}
+
+/* geometry as the scene loads it, optimized with every level of detail */
+void packMesh(Packer& packer, const std::string& path, bool encoded)
+{
+    std::string mtllib;
+    std::vector<ModelGeometry> geometry = modelGeometryLoad(path, {.optimize = true, .lodCount = MODEL_LOD_MAX}, mtllib);
+    std::vector<uint8_t> data = modelGeometrySerialize(path, geometry, mtllib, MODEL_LOD_MAX);
+    packerAdd(packer, {.path = path, .type = ASSET_MESH}, data.data(), data.size());
+
+    if(!mtllib.empty())
+    {
+        packMaterial(packer, directoryOf(path) + mtllib, encoded);
+    }
+}
+
+}
+
+/* usage: asset_packer <manifest> <output>, the paths of the manifest are relative to the working directory */
+int main(int argc, char** argv)
+{
+    if(argc != 3)
+    {
+        std::cerr << "usage: asset_packer <manifest> <output>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream manifest(argv[1]);
+    if(!manifest)
+    {
+        std::cerr << "Couldn't open manifest " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Packer packer;
+    if(!assetPackWriterCreate(packer.writer, argv[2]))
+    {
+        std::cerr << "Couldn't create " << argv[2] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string line;
+    unsigned int lineNumber = 0;
+    try
+    {
+        while(std::getline(manifest, line))
+        {
+            lineNumber++;
+            std::stringstream ss(line);
+            std::string command;
+            if(!(ss >> command) || command[0] == '#')
+            {
+                continue;
+            }
+
+            std::vector<std::string> paths;
+            std::string word;
+            while(ss >> word)
+            {
+                paths.push_back(word);
+            }
+            bool encoded = !paths.empty() && paths.back() == "encoded";
+            if(encoded)
+            {
+                paths.pop_back();
+            }
+
+            if(command == "cubemap" ? paths.size() != 6 : paths.size() != 1)
+            {
+                throw std::runtime_error("wrong number of paths for " + command);
+            }
+
+            if(command == "mesh")
+            {
+                packMesh(packer, paths[0], encoded);
+            }
+            else if(command == "material")
+            {
+                packMaterial(packer, paths[0], encoded);
+            }
+            else if(command == "texture")
+            {
+                packImage(packer, paths[0], true, encoded);
+            }
+            else if(command == "cubemap")
+            {
+                for(const auto& path : paths)
+                {
+                    packImage(packer, path, false, encoded);
+                }
+            }
+            else if(command == "file")
+            {
+                packFile(packer, paths[0]);
+            }
+            else
+            {
+                throw std::runtime_error("unknown command " + command);
+            }
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << argv[1] << ":" << lineNumber << ": " << e.what() << std::endl;
+        assetPackWriterFinish(packer.writer);
+        std::remove(argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    if(!assetPackWriterFinish(packer.writer))
+    {
+        std::cerr << "Couldn't write " << argv[2] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    printf("%s: %u files %.1f MB, %u meshes %.1f MB, %u images %.1f MB\n", argv[2],
+           packer.count[ASSET_FILE], packer.bytes[ASSET_FILE] / 1048576.0, packer.count[ASSET_MESH], packer.bytes[ASSET_MESH] / 1048576.0,
+           packer.count[ASSET_IMAGE], packer.bytes[ASSET_IMAGE] / 1048576.0);
+    return EXIT_SUCCESS;
+}